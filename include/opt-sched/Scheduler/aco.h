@@ -9,17 +9,28 @@ Last Update:  Jan. 2020
 #ifndef OPTSCHED_ACO_H
 #define OPTSCHED_ACO_H
 
+#include "opt-sched/Scheduler/ddg_blob.h"
 #include "opt-sched/Scheduler/gen_sched.h"
+#include "opt-sched/Scheduler/pheromone_table.h"
 #include "opt-sched/Scheduler/simplified_aco_ds.h"
 #include "opt-sched/Scheduler/ready_list.h"
 #include "opt-sched/Scheduler/device_vector.h"
 #include "llvm/ADT/ArrayRef.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include <hip/hip_runtime.h>
 
 namespace llvm {
+class ThreadPool;
+
 namespace opt_sched {
 
+class ACOIslands;
+class AntState;
+
 // setting to 1 locks ACO to iterations_without_improvement iterations
 #define RUNTIME_TESTING 0
 // Minimum region node count. Doesn't make sence to launch DEV_ACO on small rgns
@@ -31,6 +42,11 @@ namespace opt_sched {
 #define NUMBLOCKSMANYANTS 80
 #define NUMTHREADSPERBLOCK 64
 #define BLOCKOPTSTALLTHRESHOLD 30
+// Maximum number of steps by which the local search moves an instruction
+#define LOCAL_SEARCH_MAX_DIST 32
+// Number of draws a host ant makes from the heuristic factors of its ready
+// list before it computes every score for a roulette selection
+#define ACO_ROULETTE_DRAWS 16
 
 enum class DCF_OPT {
   OFF,
@@ -55,8 +71,18 @@ public:
 	             MachineModel *dev_MM = NULL, void *dev_states = NULL);
   __host__
   virtual ~ACOScheduler();
+  // Returns RES_TIMEOUT if the time limit set with SetTimeout() ran out
+  // before ACO converged. The best schedule found so far is still returned.
   FUNC_RESULT FindSchedule(InstSchedule *schedule, SchedRegion *region, 
 		           ACOScheduler *dev_AcoSchdulr = NULL);
+  // Limits the time FindSchedule() spends on host ACO, checked between ants.
+  // 0 means no limit. The heuristic ant always runs.
+  void SetTimeout(Milliseconds Timeout) { timeout_ = Timeout; }
+  // Makes host ACO run as the given colony of an island model. It then
+  // exchanges its best schedule with the other colonies every few
+  // iterations. Pipelined iterations are turned off, since an immigrant is
+  // deposited at a point where no ants may be running.
+  void SetIsland(ACOIslands *Islands, int Island);
   __host__
   inline void UpdtRdyLst_(InstCount cycleNum, int slotNum);
   // Set the initial schedule for ACO
@@ -76,13 +102,19 @@ public:
   __host__ __device__
   InstSchedule *FindOneSchedule(InstCount RPTarget,
                                 InstSchedule *dev_schedule = NULL);
+  // Host version of the above that keeps all of the ant's scheduling state
+  // in the passed AntState and builds the schedule into the empty schedule
+  // Sched. Returns Sched, or NULL if the ant was terminated. Several ants may
+  // run this at the same time.
+  InstSchedule *FindOneSchedule(InstCount RPTarget, AntState &State,
+                                InstSchedule *Sched);
   __host__ __device__
   void UpdatePheromone(InstSchedule *schedule, bool isIterationBest);
   __host__ __device__
   void ScalePheromoneTable();
   // Copies pheromone table to passed shared memory array
   __device__ 
-  void CopyPheromonesToSharedMem(double *s_pheromone);
+  void CopyPheromonesToSharedMem(pheromone_t *s_pheromone);
   __host__ __device__
   bool shouldReplaceSchedule(InstSchedule *OldSched, InstSchedule *NewSched,
                              bool IsGlobal, InstCount RPTarget);
@@ -104,27 +136,171 @@ public:
   void *dev_states_;
 private:
   __host__ __device__
-  pheromone_t &Pheromone(SchedInstruction *from, SchedInstruction *to);
+  pheromone_t Pheromone(InstCount from, InstCount to);
+  // Returns the pheromone of a pair to update it. The pair must be able to
+  // be adjacent in a schedule.
   __host__ __device__
-  pheromone_t &Pheromone(InstCount from, InstCount to);
+  pheromone_t *PheromonePtr(SchedInstruction *from, SchedInstruction *to);
   __host__ __device__
-  pheromone_t Score(InstCount FromId, InstCount ToId, HeurType ToHeuristic, bool IsFirstPass);
-  DCF_OPT ParseDCFOpt(const std::string &opt);
+  pheromone_t *PheromonePtr(InstCount from, InstCount to);
   __host__ __device__
+  pheromone_t Score(InstCount FromId, InstCount ToId, HeurType ToHeuristic, bool IsFirstPass, int WhichPrirts = 1);
+  DCF_OPT ParseDCFOpt(const std::string &opt);
+  __device__
   InstCount SelectInstruction(SchedInstruction *lastInst, InstCount totalStalls, 
                               SchedRegion *rgn, bool &unnecessarilyStalling, 
                               bool closeToRPTarget, bool currentlyWaiting);
-  __host__ __device__
+  __device__
   void UpdateACOReadyList(SchedInstruction *Inst, bool IsSecondPass);
+  // Host versions of the above that work on the state of a single ant
+  InstCount SelectInstruction(SchedInstruction *lastInst, InstCount totalStalls,
+                              bool &unnecessarilyStalling, bool closeToRPTarget,
+                              bool currentlyWaiting, AntState &State);
+  void UpdateACOReadyList(SchedInstruction *Inst, AntState &State);
+  // Returns the priorities (1 or 2) of the ant run on State. Like the block
+  // it emulates, an ant of an odd Dev_ACO block uses the second ones in the
+  // second pass.
+  int GetAntPrirts_(const AntState &State) const;
+  // Computes the heuristic key of Inst with the priorities of the ant run on
+  // State
+  HeurType ComputeAntKey_(SchedInstruction *Inst, const AntState &State) const;
+  // Returns the factor by which the heuristic value Heur scales the score of
+  // a ready list entry for the ant run on State, as in Score()
+  pheromone_t HeurFactor_(HeurType Heur, const AntState &State) const;
+  // Change the ready list of the ant run on State, keeping the heuristic
+  // factors of its entries in State.heurTree
+  void AddToReadyList_(const ACOReadyListEntry &Entry, AntState &State);
+  ACOReadyListEntry RemoveFromReadyList_(InstCount Indx, AntState &State);
+  void ClearReadyList_(AntState &State);
+  // Computes the number of registers whose last use is Inst given the
+  // register uses an ant has scheduled so far
+  int16_t CmputLastUseCnt_(SchedInstruction *Inst, const AntState &State);
+  // The schedules of the ants of one host iteration
+  struct HostAntBatch {
+    // The schedule handed to each ant
+    std::vector<InstSchedule *> Bufs;
+    // The schedule built by ant i, or NULL if the ant was terminated
+    std::vector<InstSchedule *> Scheds;
+    // Whether ant i was started, which it is not once the deadline passed
+    std::vector<char> Started;
+  };
+  // Starts all ants of one host iteration. With pipelining they run in the
+  // background until FinishHostAnts_ is called on the same batch.
+  void StartHostAnts_(InstCount RPTarget, int Iteration, HostAntBatch &Batch);
+  // Waits for the ants of a batch and returns the buffers of terminated ants
+  // to the pool
+  void FinishHostAnts_(HostAntBatch &Batch);
+  // Returns true once the deadline of the current FindSchedule() passed
+  bool TimedOut_();
+  // Passes the best schedule to the island model and takes the best of the
+  // next colony instead if it is better. Returns true if it was taken.
+  bool Migrate_(InstSchedule *&BestSchedule, InstCount &RPTarget);
+  // Returns an empty schedule, reusing one released to the pool if possible
+  InstSchedule *AcquireSchedule_();
+  // Returns a schedule that is no longer referenced to the pool
+  void ReleaseSchedule_(InstSchedule *Sched);
+  // Picks the best of the given schedules with the pairwise tournament of
+  // reduceToBestSchedPerBlock() and reduceToBestSched(), so ties are broken
+  // the way the device breaks them. Releases all other schedules.
+  InstSchedule *ReduceLikeDevice_(std::vector<InstSchedule *> &Scheds,
+                                  InstCount RPTarget);
+  // Schedules the instructions in the given order into the empty schedule
+  // Sched, stalling until each one is ready. Returns Sched, or NULL if its
+  // spill cost exceeds RPTarget.
+  InstSchedule *ReplayOrder_(const std::vector<InstCount> &Order,
+                             InstCount RPTarget, AntState &State,
+                             InstSchedule *Sched);
+  // If the schedule of Sched was costed before in the region, gives Sched
+  // and the ant's state its costs and returns true
+  bool FindSeenCost_(InstSchedule *Sched, AntState &State);
+  // Remembers the costs of Sched for the ants that rebuild it
+  void AddSeenCost_(InstSchedule *Sched);
+  // Improves BestSchedule by swapping pairs of instructions that can trade
+  // issue slots without breaking a latency, for at most localSearchPasses_
+  // passes. Returns true if it was improved.
+  bool LocalSearch_(InstSchedule *&BestSchedule, InstCount &RPTarget);
+  // The schedule improved by LocalSearch_() and its register pressure after
+  // every step, from which the spill cost of a swap is computed without
+  // replaying the schedule. A step is the position of an instruction in the
+  // order of the schedule.
+  struct LocalSearchProfile {
+    std::vector<InstCount> Order;
+    // The step and the issue slot of every instruction
+    std::vector<InstCount> Steps;
+    std::vector<InstCount> Slots;
+    // The step of the definition of every register, indexed like
+    // AntState::crntUseCnt, and the steps of its last three uses, latest
+    // first, or -1
+    std::vector<InstCount> DefSteps;
+    std::vector<InstCount> LastUseSteps;
+    // The weighted pressure of every register type after every step, and
+    // its maximum over the steps up to and from every step
+    std::vector<unsigned> Pressures;
+    std::vector<unsigned> PrefixPeaks;
+    std::vector<unsigned> SuffixPeaks;
+    // The same for the spill cost of every step, and the sum of the costs
+    std::vector<InstCount> StepCosts;
+    std::vector<InstCount> PrefixMaxCosts;
+    std::vector<InstCount> SuffixMaxCosts;
+    InstCount TotStepCost;
+    // The number of live registers summed over all steps
+    InstCount LiveSum;
+    // The spill cost of the schedule computed from the above
+    InstCount SpillCost;
+    // The function that gives the spill cost of a single step
+    SPILL_COST_FUNCTION StepCostFunc;
+    // The changes of the pressures in the steps between two swapped
+    // instructions
+    std::vector<int> PressureDeltas;
+  };
+  // Sets Prof up for Sched, using State as scratch space
+  void BuildLocalSearchProfile_(InstSchedule *Sched, LocalSearchProfile &Prof,
+                                AntState &State);
+  // Returns the spill cost of the profiled schedule after swapping the
+  // instructions at steps XStep < YStep. Only the registers of the two
+  // instructions and the steps between them are examined.
+  InstCount CmputSwapSpillCost_(LocalSearchProfile &Prof, InstCount XStep,
+                                InstCount YStep, AntState &State);
+  // Returns the spill cost of a schedule whose steps have the given maximum
+  // and total cost and live register count sum, and whose per type peak
+  // pressures are in State.peakRegPressures. The SLIL is returned without
+  // the count of last uses, which no swap changes.
+  InstCount CmputProfileSpillCost_(const LocalSearchProfile &Prof,
+                                   InstCount PeakCost, InstCount TotCost,
+                                   InstCount LiveSum, AntState &State);
+  // Replaces the initial pheromone with the table cached for the region,
+  // scaled to the same average. Returns false if none is cached.
+  bool LoadCachedPheromone_();
+  // Stores the pheromone of the region in the cache
+  void StoreCachedPheromone_();
 
   DeviceVector<pheromone_t> pheromone_;
+  // Host ACO on regions of at least sparsePherMinSize_ instructions stores
+  // the pheromone of reachable pairs only, in sparsePher_, instead of in
+  // pheromone_. A size of 0 disables the sparse table.
+  bool useSparsePher_;
+  int sparsePherMinSize_;
+  SparsePheromoneTable sparsePher_;
+  // On the host, pheromone values are stored divided by pherScale_ so that
+  // evaporating the whole table only takes scaling pherScale_. Device ACO
+  // always works on normalized values.
+  pheromone_t pherScale_;
+  // Folds pherScale_ into the stored pheromone values and resets it to 1
+  void NormalizePheromone_();
+  // An upper bound on the stored pheromone values of every row of the table,
+  // indexed like the rows. Host ants bound the scores of the ready list
+  // entries with it, so that they only compute the scores of the entries
+  // that may be selected. It is raised by every deposit and recomputed when
+  // the whole table is rewritten.
+  std::vector<pheromone_t> pherRowMax_;
+  // Recomputes pherRowMax_ from the table
+  void CmputPherRowMax_();
   // new ds representations
   ACOReadyList *readyLs;
   KeysHelper1 *kHelper1;
   KeysHelper2 *kHelper2;
   pheromone_t MaxPriorityInv;
   pheromone_t MaxPriorityInv2;
-  InstCount MaxScoringInst;
 
   // new ds representations for device
   ACOReadyList *dev_readyLs;
@@ -140,6 +316,8 @@ private:
   int heuristicImportance_;
   bool use_tournament;
   bool use_dev_ACO;
+  // True if the Dev_ACO grid is emulated by host ants (DEV_ACO_ON_HOST)
+  bool devAcoOnHost_;
   int fixed_bias;
   double bias_ratio;
   double local_decay;
@@ -159,16 +337,72 @@ private:
   int returnLastInstCnt_;
   // Used to count how many ants are terminated early
   int numAntsTerminated_;
+  // Used to count how many host ants are not run because of the deadline
+  int numAntsTimedOut_;
 
   bool justWaited = false;
   int globalBestStalls_ = 0;
   int numBlocks_, numThreads_;
   int *dev_RP0OrPositiveCount;
-  int RP0OrPositiveCount;
 
   SchedPriorities priorities1_;
   SchedPriorities priorities2_;
 
+  // Number of threads used to run the ants of a host ACO iteration
+  int hostThreadCnt_;
+  // Number of iterations by which the pheromone seen by host ants may lag.
+  // With 1, the ants of the next iteration are built while the current one
+  // is merged, and its deposit is applied once those ants are done.
+  int pherStaleness_;
+  // The host threads and ant states are kept by the ACOContext of the
+  // scheduling thread, so they are shared by all regions it schedules
+  ThreadPool *hostThreadPool_;
+  // One ant state per host thread
+  std::vector<AntState *> antStates_;
+  // Flat image of the DDG. Host ants read the successors from it, since
+  // they cannot share the successor iterators of the instructions, and its
+  // hash keys the pheromone cache.
+  DDGBlob ddgBlob_;
+  // Schedules built by host ants that lost to the iteration or global best.
+  // They are reused by later ants instead of allocating new ones, and by
+  // later regions once this scheduler is done.
+  std::vector<InstSchedule *> freeScheds_;
+  // Number of schedules allocated for host ants in the current region
+  int schedAllocCnt_;
+  // Seed and region parts of the random key of every host ant in the
+  // current region. The ant that builds the initial heuristic schedule uses
+  // iteration 0; iterations of the main loop are numbered from 1.
+  uint64_t randSeed_;
+  uint64_t randRgnKey_;
+  // Best comparable cost (see shouldReplaceSchedule) of the host ants that
+  // completed so far in the current iteration. Ants whose partial schedule
+  // is already strictly worse are cut off.
+  std::atomic<InstCount> hostIterBestCost_;
+  // Time limit of FindSchedule() and the time at which it runs out, or 0
+  Milliseconds timeout_;
+  Milliseconds deadline_;
+  std::atomic<bool> timedOut_;
+  // The island model this colony is part of and its index in it, or NULL
+  ACOIslands *islands_;
+  int islandIndx_;
+  // Maximum number of local search passes over the best host schedule
+  int localSearchPasses_;
+  // The costs of the schedules built by host ants in the current region,
+  // keyed by schedule hash. The slots are compared on a hit, since different
+  // schedules can have the same hash.
+  struct SeenSchedCost {
+    std::vector<InstCount> Slots;
+    InstCount Cost;
+    InstCount ExecCost;
+    InstCount SpillCost;
+    InstCount NormSpillCost;
+  };
+  std::unordered_map<uint64_t, SeenSchedCost> seenScheds_;
+  std::mutex seenSchedsMutex_;
+  // Whether pheromone tables are shared through the PheromoneCache
+  bool pherCacheEn_;
+  uint64_t pherCacheKey_;
+
 };
 
 } // namespace opt_sched
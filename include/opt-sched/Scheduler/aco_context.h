@@ -0,0 +1,114 @@
+/*******************************************************************************
+Description:  Defines the ACO context a thread keeps across the regions it
+              schedules. It owns the host ant states, the schedules handed to
+              ants, the threads that run host ants and the device buffers
+              that every device run needs, so a region reuses them instead of
+              allocating and freeing its own. Buffers only grow, so they end
+              up sized for the largest region seen. The per-instruction and
+              per-register arrays of a device run are carved out of arenas
+              that are likewise kept at the high-water mark of all runs.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_ACO_CONTEXT_H
+#define OPTSCHED_ACO_CONTEXT_H
+
+#include "opt-sched/Scheduler/defines.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace llvm {
+
+class ThreadPool;
+
+namespace opt_sched {
+
+class AntState;
+class DataDepGraph;
+class InstSchedule;
+class MachineModel;
+
+// The device buffers kept by the context
+enum DEV_BUFFER {
+  // The copies of the DataDepGraph, the BBWithSpill and the ACOScheduler
+  DB_DDG,
+  DB_RGN,
+  DB_ACO,
+  // The hiprand states of the device ants
+  DB_RAND_STATES,
+  DB_CNT
+};
+
+class ACOContext {
+public:
+  // Returns the context of the calling thread. Regions scheduled on
+  // different threads never share a context.
+  static ACOContext &getInstance();
+
+  ACOContext(const ACOContext &) = delete;
+  void operator=(const ACOContext &) = delete;
+  ~ACOContext();
+
+  // Returns cnt ant states set up for the given region. They stay owned by
+  // the context and are valid until the next call.
+  std::vector<AntState *> GetAntStates(DataDepGraph *dataDepGraph,
+                                       MachineModel *machMdl, int cnt);
+  // Returns a pool of at least threadCnt threads for host ants.
+  ThreadPool *GetThreadPool(unsigned threadCnt);
+  // Returns a pool of at least threadCnt threads for the colonies of an
+  // island model. Each colony thread keeps its own context.
+  ThreadPool *GetIslandThreadPool(unsigned threadCnt);
+  // Returns an empty schedule for the given region. allocated is set if no
+  // schedule could be reused.
+  InstSchedule *AcquireSchedule(MachineModel *machMdl,
+                                DataDepGraph *dataDepGraph, bool &allocated);
+  // Takes over schedules that a region no longer uses and clears scheds.
+  void ReleaseSchedules(std::vector<InstSchedule *> &scheds);
+
+  // Returns a device buffer of at least size bytes. Its contents are
+  // undefined.
+  void *GetDevBuffer(DEV_BUFFER buf, size_t size);
+  // Returns a device array of at least size bytes that stays valid until the
+  // next ResetDevArrays(). Managed arrays can also be written by the host.
+  void *AllocDevArray(size_t size, bool managed = false);
+  // Releases all arrays returned by AllocDevArray() at once. If a run needed
+  // more than one block, the blocks are freed and the next run gets a
+  // single block of the largest size used so far.
+  void ResetDevArrays();
+  // Frees the device buffers and arrays. Must be called while the HIP
+  // runtime is still up, so it is not left to the destructor.
+  void FreeDevBuffers();
+
+private:
+  ACOContext();
+
+  std::vector<std::unique_ptr<AntState>> antStates_;
+  std::unique_ptr<ThreadPool> threadPool_;
+  unsigned threadCnt_;
+  std::unique_ptr<ThreadPool> islandPool_;
+  unsigned islandThreadCnt_;
+  std::vector<InstSchedule *> freeScheds_;
+  void *devBuffers_[DB_CNT];
+  size_t devBufferSizes_[DB_CNT];
+
+  // Bump allocator for the arrays of one kind of device memory
+  struct DevArena {
+    std::vector<void *> blocks;
+    // Size and used bytes of the last block
+    size_t blockSize = 0;
+    size_t blockUsed = 0;
+    // Bytes handed out since the last reset and the most ever handed out
+    size_t used = 0;
+    size_t maxUsed = 0;
+  };
+  // Device-only and managed arrays
+  DevArena devArenas_[2];
+
+  void FreeDevArena_(DevArena &arena);
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
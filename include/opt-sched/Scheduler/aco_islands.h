@@ -0,0 +1,77 @@
+/*******************************************************************************
+Description:  Defines the exchange point of an island model ACO. Several
+              colonies schedule the same region on their own threads, each
+              with its own pheromone table, and every few iterations they
+              meet to pass their best schedule to the next colony in a ring.
+              Colonies that stop iterating leave the ring but keep offering
+              their final schedule, so the exchange only depends on the
+              colonies' own progress and not on thread timing.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_ACO_ISLANDS_H
+#define OPTSCHED_ACO_ISLANDS_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+class DataDepGraph;
+class InstSchedule;
+class MachineModel;
+
+class ACOIslands {
+public:
+  ACOIslands(int islandCnt, int migrationInterval, MachineModel *machMdl,
+             DataDepGraph *dataDepGraph);
+  ~ACOIslands();
+
+  int GetIslandCnt() const { return islandCnt_; }
+  // Returns the number of iterations between two migrations.
+  int GetMigrationInterval() const { return migrationInterval_; }
+  // Serializes the parts of the colonies' setup that walk the iterators
+  // stored in the shared DDG.
+  std::mutex &GetSetupMutex() { return setupMutex_; }
+
+  // Publishes the best schedule of an island and waits until every island
+  // that is still iterating has published its own. Then copies the schedule
+  // of the next island in the ring into immigrant.
+  void Migrate(int island, InstSchedule *best, InstSchedule *immigrant);
+  // Publishes the final schedule of an island that stops iterating. Later
+  // migrations no longer wait for it.
+  void Leave(int island, InstSchedule *best);
+
+private:
+  int islandCnt_;
+  int migrationInterval_;
+  std::mutex setupMutex_;
+
+  std::mutex mutex_;
+  std::condition_variable migrated_;
+  // The number of islands still iterating and how many of them published a
+  // schedule in the current migration
+  int activeCnt_;
+  int arrivedCnt_;
+  // The number of completed migrations
+  int generation_;
+  // The schedules of the last two migrations, indexed by generation parity.
+  // A schedule is only overwritten two migrations later, once every island
+  // has copied it.
+  std::vector<std::unique_ptr<InstSchedule>> published_[2];
+  // The final schedule of each island, and the first migration it missed,
+  // or -1 while it is still iterating
+  std::vector<std::unique_ptr<InstSchedule>> final_;
+  std::vector<int> leftGen_;
+
+  // Ends the current migration and wakes up the islands waiting for it.
+  void Complete_();
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
@@ -0,0 +1,130 @@
+/*******************************************************************************
+Description:  Defines the state mutated while building one schedule on the
+              host. Each host ACO ant carries its own copy of every value
+              that the constrained scheduler, the instructions, the registers
+              and the spill-cost region would otherwise share, so several
+              ants can construct schedules for the same region concurrently.
+              BBWithSpill also keeps one instance for the register pressure
+              tracking of the list scheduler and the enumerator.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_ANT_STATE_H
+#define OPTSCHED_ANT_STATE_H
+
+#include "opt-sched/Scheduler/bit_vector.h"
+#include "opt-sched/Scheduler/defines.h"
+#include "opt-sched/Scheduler/gen_sched.h"
+#include "opt-sched/Scheduler/ready_heur_tree.h"
+#include "opt-sched/Scheduler/simplified_aco_ds.h"
+#include "llvm/ADT/SmallVector.h"
+#include <cstdint>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+class DataDepGraph;
+class MachineModel;
+
+class AntState {
+public:
+  // Allocates the state needed by one ant to schedule the given region.
+  // Must be called after the region has been set up for scheduling so that
+  // the register files know their register and physical register counts.
+  AntState(DataDepGraph *dataDepGraph, MachineModel *machMdl);
+  ~AntState();
+
+  // Sets the state up for another region, with the same requirements as the
+  // constructor. The arrays are only reallocated if they are too small.
+  void Prepare(DataDepGraph *dataDepGraph, MachineModel *machMdl);
+
+  AntState(const AntState &) = delete;
+  AntState &operator=(const AntState &) = delete;
+
+  // Selects the random number stream of this ant. The stream depends only
+  // on the key, so an ant can be replayed on its own from the same
+  // (seed, region, iteration, ant) tuple.
+  void SetRandKey(uint64_t seed, uint64_t region, uint64_t iteration,
+                  uint64_t ant);
+  // Returns a random value in [min, max] drawn from this ant's stream.
+  double RandDouble(double min, double max);
+
+  // Returns the index of a register in crntUseCnt.
+  int GetRegIndx(int16_t regType, int regNum) const {
+    return regOffsets[regType] + regNum;
+  }
+
+  // ConstrainedScheduler state.
+  InstCount crntCycleNum;
+  InstCount crntSlotNum;
+  InstCount crntRealSlotNum;
+  InstCount schduldInstCnt;
+  bool isCrntCycleBlkd;
+  // Indexed by issue type.
+  int16_t *avlblSlotsInCrntCycle;
+  // Indexed by issue slot.
+  ReserveSlot *rsrvSlots;
+  int16_t rsrvSlotCnt;
+
+  // SchedInstruction state, indexed by instruction number.
+  InstCount *unschduldPrdcsrCnt;
+  InstCount *minRdyCycle;
+  int16_t *lastUseCnt;
+
+  // Register state. The registers of all types are stored back to back;
+  // regOffsets holds the first index of each register type.
+  int *regOffsets;
+  int *crntUseCnt;
+
+  // BBWithSpill state.
+  WeightedBitVector *liveRegs;
+  WeightedBitVector *livePhysRegs;
+  SmallVector<unsigned, 8> regPressures;
+  InstCount *peakRegPressures;
+  int *sumOfLiveIntervalLengths;
+  InstCount *spillCosts;
+  InstCount crntStepNum;
+  InstCount peakSpillCost;
+  InstCount totSpillCost;
+  InstCount slilSpillCost;
+  InstCount crntSpillCost;
+  InstCount dynamicSlilLowerBound;
+
+  // ACO state.
+  ACOReadyList readyLs;
+  int RP0OrPositiveCount;
+  // The Dev_ACO block emulated by the ant run on this state, or -1 for a
+  // host ant.
+  int blockIndx;
+  // Number of ants run on this state that were cut off because they could
+  // no longer beat the iteration best.
+  int antsCutOff;
+  // Number of ants run on this state that rebuilt a schedule already seen
+  // in the region.
+  int duplicateAnts;
+  // The heuristic factors of the scores of the ready list entries.
+  ReadyHeurTree heurTree;
+  // Running sums of the ready list scores, for the roulette selections that
+  // cannot be drawn through heurTree.
+  std::vector<pheromone_t> scorePrefix;
+
+private:
+  // The number of elements the arrays above were allocated for
+  int16_t issuTypeCap_;
+  int issuRateCap_;
+  InstCount instCap_;
+  int16_t regTypeCap_;
+  int regCap_;
+  // The region size readyLs was constructed for
+  InstCount readyLsSize_;
+
+  uint64_t randKey_;
+  // The number of values drawn since the key was set.
+  uint64_t randCntr_;
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
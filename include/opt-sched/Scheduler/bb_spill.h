@@ -10,28 +10,85 @@ Last Update:  Apr. 2011
 #define OPTSCHED_SPILL_BB_SPILL_H
 
 #include "opt-sched/Scheduler/OptSchedTarget.h"
+#include "opt-sched/Scheduler/bit_vector.h"
 #include "opt-sched/Scheduler/defines.h"
 #include "opt-sched/Scheduler/sched_region.h"
 #include "llvm/ADT/SmallVector.h"
+#include <functional>
 #include <map>
+#include <memory>
 #include <set>
 #include <vector>
 #include <hip/hip_runtime.h>
 
 namespace llvm {
+
+class ThreadPool;
+
 namespace opt_sched {
 
+class AntState;
 class LengthCostEnumerator;
+class SharedHistTable;
 class EnumTreeNode;
 class Register;
 class RegisterFile;
 class BitVector;
 
+// The register pressure and spill cost state of one schedule being built.
+// Host schedules view the arrays of an AntState. A device thread views its
+// slice of the region's device arrays, which interleave the threads, so the
+// elements of one thread are stride elements apart.
+struct SpillStateView {
+  WeightedBitVector *liveRegs;
+  // Physical registers are not tracked on the device, which leaves this null
+  WeightedBitVector *livePhysRegs;
+  unsigned *regPressures;
+  InstCount *peakRegPressures;
+  int *sumOfLiveIntervalLengths;
+  InstCount *spillCosts;
+  InstCount *crntStepNum;
+  InstCount *peakSpillCost;
+  InstCount *totSpillCost;
+  InstCount *slilSpillCost;
+  InstCount *crntSpillCost;
+  // The current use counts of the registers, indexed by
+  // regOffsets[register type] + register number. Device threads keep them
+  // in the registers, which leaves these null.
+  int *crntUseCnt;
+  const int *regOffsets;
+  int stride;
+
+  __host__ __device__
+  WeightedBitVector &LiveRegs(int16_t regType) const {
+    return liveRegs[regType * stride];
+  }
+  __host__ __device__
+  unsigned &RegPressure(int16_t regType) const {
+    return regPressures[regType * stride];
+  }
+  __host__ __device__
+  InstCount &PeakRegPressure(int16_t regType) const {
+    return peakRegPressures[regType * stride];
+  }
+  __host__ __device__
+  int &SLIL(int16_t regType) const {
+    return sumOfLiveIntervalLengths[regType * stride];
+  }
+  __host__ __device__
+  InstCount &SpillCost(InstCount stepNum) const {
+    return spillCosts[stepNum * stride];
+  }
+};
+
 class BBWithSpill : public SchedRegion {
 private:
   LengthCostEnumerator *enumrtr_;
 
-  InstCount crntSpillCost_;
+  // The register pressure and spill cost state of the schedule being built
+  // by the list scheduler or the enumerator. ACO ants keep their own.
+  AntState *rgnState_;
+
   // pointer to a device array used to store crntSpillCost_ for
   // each thread by parallel ACO
   InstCount *dev_crntSpillCost_;
@@ -49,20 +106,10 @@ private:
   int16_t regTypeCnt_;
   RegisterFile *regFiles_;
 
-  // A bit vector indexed by register number indicating whether that
-  // register is live
-  WeightedBitVector *liveRegs_;
   // pointer to a device array used to store liveRegs_ for
   // each thread by parallel ACO
   WeightedBitVector **dev_liveRegs_;
 
-  // A bit vector indexed by physical register number indicating whether
-  // that physical register is live
-  WeightedBitVector *livePhysRegs_;
-
-  // Sum of lengths of live ranges. This array is indexed by register type,
-  // and each type will have its sum of live interval lengths computed.
-  int *sumOfLiveIntervalLengths_;
   // pointer to a device array used to store sumOfLiveIntervalLengths_ for
   // each thread by parallel ACO
   // Indexed by register type * numThreads_ + GLOBALTID
@@ -70,10 +117,6 @@ private:
 
   InstCount staticSlilLowerBound_ = 0;
 
-  // (Chris): The dynamic lower bound for SLIL is calculated differently from
-  // the other cost functions. It is first set when the static lower bound is
-  // calculated.
-  InstCount dynamicSlilLowerBound_ = 0;
   // pointer to a device array used to store dynamicSlilLowerBound_ for
   // each thread by parallel ACO
   InstCount *dev_dynamicSlilLowerBound_;
@@ -87,36 +130,28 @@ private:
   // each thread by parallel ACO
   int *dev_schduldInstCnt_;
 
-  InstCount *spillCosts_;
   // pointer to a device array used to store spillCosts_ for
   // each thread by parallel ACO
   // Indexed by instruction number * numThreads_ + GLOBALTID
   InstCount *dev_spillCosts_;
-  // Current register pressure for each register type.
-  SmallVector<unsigned, 8> regPressures_;
   // pointer to a device array used to store regPressures_ for
   // each thread by parallel ACO
   // Indexed by register type * numThreads_ + GLOBALTID
   unsigned *dev_regPressures_;
-  InstCount *peakRegPressures_;
   // pointer to a device array used to store peakRegPressures_ for
   // each thread by parallel ACO
   // Indexed by register type * numThreads_ + GLOBALTID
   InstCount *dev_peakRegPressures_;
 
-  InstCount crntStepNum_;
   // pointer to a device array used to store crntStepNum_ for
   // each thread by parallel ACO
   InstCount *dev_crntStepNum_;
-  InstCount peakSpillCost_;
   // pointer to a device array used to store peakSpillCost_ for
   // each thread by parallel ACO
   InstCount *dev_peakSpillCost_;
-  InstCount totSpillCost_;
   // pointer to a device array used to store totSpillCost_ for
   // each thread by parallel ACO
   InstCount *dev_totSpillCost_;
-  InstCount slilSpillCost_;
   // pointer to a device array used to store slilSpillCost_ for
   // each thread by parallel ACO
   InstCount *dev_slilSpillCost_;
@@ -126,6 +161,10 @@ private:
   unsigned MaxOccLDS_;
   unsigned TargetOccupancy_;
 
+  // Builds a copy of the graph of this region for each enumerator thread.
+  // The caller keeps the copies alive for as long as the region.
+  std::function<DataDepGraph *()> enumWorkerGraphFactory_;
+
   // Virtual Functions:
   // Given a schedule, compute the cost function value
   InstCount CmputNormCost_(InstSchedule *sched, COST_COMP_MODE compMode,
@@ -141,6 +180,32 @@ private:
   Enumerator *AllocEnumrtr_(Milliseconds timeout);
   FUNC_RESULT Enumerate_(Milliseconds startTime, Milliseconds rgnDeadline,
                          Milliseconds lngthDeadline);
+  // Searches each target length in passes that only accept schedules cheaper
+  // than a threshold, doubling the threshold after each pass that finds none,
+  // until a pass finds one or the threshold reaches the best cost. A low
+  // threshold prunes more, and each pass starts from the cost lower bound
+  // and the history left by the one before. enumerateLength searches one
+  // target length.
+  FUNC_RESULT EnumerateByCost_(
+      const std::function<FUNC_RESULT(InstCount, int, Milliseconds)>
+          &enumerateLength,
+      Milliseconds rgnDeadline, Milliseconds lngthTimeout, int &iterCnt);
+  // Creates the regions that enumerate the sub-problems of this region on
+  // the other threads, each on its own copy of the graph. Returns none if
+  // any of them could not be set up.
+  std::vector<std::unique_ptr<BBWithSpill>>
+  AllocEnumWorkers_(int workerCnt, Milliseconds lngthTimeout);
+  void FreeEnumWorkers_(std::vector<std::unique_ptr<BBWithSpill>> &workers);
+  // Splits the search at the given target length into the sub-trees below
+  // the partial schedules of splitDepth slots and searches them on the
+  // workers. The best schedule found by any worker is taken over. If
+  // sharedHist is set, the workers check their nodes for domination by the
+  // sub-problems examined on all threads.
+  FUNC_RESULT
+  EnumerateInParallel_(std::vector<std::unique_ptr<BBWithSpill>> &workers,
+                       ThreadPool &pool, SharedHistTable *sharedHist,
+                       InstCount trgtLngth, int costLwrBound,
+                       InstCount splitDepth, Milliseconds deadline);
   void SetupForSchdulng_();
   void FinishHurstc_();
   void FinishOptml_();
@@ -161,6 +226,34 @@ private:
   void SetupPhysRegs_();
   __host__ __device__
   void CmputCrntSpillCost_();
+  // Versions of the above that update an explicit scheduling state. The
+  // versions above forward to these with the region's own state on the host
+  // and with the state of the calling thread on the device.
+  __host__ __device__
+  void UpdateSpillInfoForSchdul_(const SpillStateView &State,
+                                 SchedInstruction *inst, bool trackCnflcts);
+  void UpdateSpillInfoForUnSchdul_(AntState &State, SchedInstruction *inst);
+  __host__ __device__
+  void CmputCrntSpillCost_(const SpillStateView &State);
+  __host__ __device__
+  InstCount CmputCostForFunction_(const SpillStateView &State,
+                                  SPILL_COST_FUNCTION SpillCF);
+  // Return the views of the spill state of an ant and of the calling device
+  // thread
+  SpillStateView GetSpillState_(AntState &State);
+  __device__
+  SpillStateView GetDevSpillState_();
+  // Returns the register that inst defines (or uses) at the given index.
+  // Device threads read it from the image of the graph.
+  __host__ __device__
+  Register *GetInstReg_(SchedInstruction *inst, int16_t indx, bool isDef);
+  // Track the use counts of a register for the given state
+  __host__ __device__
+  bool IsRegLive_(const SpillStateView &State, Register *reg);
+  __host__ __device__
+  void AddRegUse_(const SpillStateView &State, Register *reg);
+  __host__ __device__
+  void ResetRegUses_(const SpillStateView &State, Register *reg);
   bool ChkSchedule_(InstSchedule *bestSched, InstSchedule *lstSched);
   void CmputCnflcts_(InstSchedule *sched);
   // returns the occupancy value that is close to being increased
@@ -213,7 +306,6 @@ public:
   void SetRegFiles(RegisterFile *regFiles) {regFiles_ = regFiles; }
   void AllocDevArraysForParallelACO(int numThreads);
   void CopyPointersToDevice(SchedRegion *dev_rgn, int numThreads);
-  void FreeDevicePointers(int numThreads);
   //non virtual versions of function to be invoked on device
   __device__
   InstCount Dev_CmputNormCost_(InstSchedule *sched, COST_COMP_MODE compMode,
@@ -243,23 +335,49 @@ public:
     #ifdef __HIP_DEVICE_COMPILE__
     return dev_regPressures_[regType*numThreads_+GLOBALTID] > (unsigned int) machMdl_->GetPhysRegCnt(regType);
     #else
-      return regPressures_[regType] > (unsigned int) machMdl_->GetPhysRegCnt(regType);
+    return IsRPHigh(*rgnState_, regType);
     #endif
   }
+  // Versions of the scheduling and cost functions above that read and update
+  // an explicit scheduling state. The functions above forward to these with
+  // the region's own state, and each ACO ant passes its own, so they may be
+  // called for several ants at the same time.
+  void InitForSchdulng(AntState &State);
+  void SchdulInst(AntState &State, SchedInstruction *inst, InstCount cycleNum,
+                  InstCount slotNum);
+  InstCount GetCrntSpillCost(const AntState &State) const;
+  InstCount ReturnPeakSpillCost(const AntState &State) const;
+  bool IsRPHigh(const AntState &State, int regType) const;
+  InstCount CmputCostForFunction(const AntState &State,
+                                 SPILL_COST_FUNCTION SpillCF);
+  // Computes the cost of a complete schedule built by an ant and stores it
+  // in the schedule.
+  using SchedRegion::UpdateScheduleCost;
+  void UpdateScheduleCost(AntState &State, InstSchedule *sched);
+  // Returns a lower bound on the cost (or on the normalized spill cost if
+  // spillOnly) that UpdateScheduleCost() will give any completion of the
+  // partial schedule in State, assuming the completion is at least lngthLB
+  // cycles long. Returns INVALID_VALUE if the spill cost function can not
+  // be bounded before the schedule is complete.
+  InstCount CmputCostLwrBound(const AntState &State, InstCount lngthLB,
+                              bool spillOnly);
   void setTargetOccupancy(unsigned targetOccupancy) {
     TargetOccupancy_ = targetOccupancy;
   }
   void setMaxOccLDS(unsigned MaxOccLDS) {
     MaxOccLDS_ = MaxOccLDS;
   }
+  // Lets the enumerator search the region on ENUM_THREADS threads, using
+  // factory to build the graph each extra thread searches.
+  void SetEnumWorkerGraphFactory(std::function<DataDepGraph *()> factory) {
+    enumWorkerGraphFactory_ = std::move(factory);
+  }
   // size_t calculateMemoryNeeded() {
   //   return regTypeCnt_ * sizeof(WeightedBitVector) * numThreads * 2;
   // }
 protected:
   // (Chris)
-  inline virtual const int *GetSLIL_() const {
-    return sumOfLiveIntervalLengths_;
-  }
+  virtual const int *GetSLIL_() const;
 
   inline virtual const int GetSLIL_size_() const {
     return regTypeCnt_;
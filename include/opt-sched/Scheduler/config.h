@@ -50,7 +50,9 @@ protected:
 class SchedulerOptions : public Config {
 public:
   // Since the scheduler flags should only be loaded once we are safe
-  // implementing it as a singelton.
+  // implementing it as a singelton. Lookups only read the settings, so
+  // regions may be scheduled on several threads as long as no thread loads
+  // new settings meanwhile.
   static SchedulerOptions &getInstance();
 
   // Make sure there is no way for a second config object to be accidentally
@@ -11,6 +11,7 @@ Last Update:  Mar. 2011
 
 #include "opt-sched/Scheduler/OptSchedDDGWrapperBase.h"
 #include "opt-sched/Scheduler/buffers.h"
+#include "opt-sched/Scheduler/ddg_blob.h"
 #include "opt-sched/Scheduler/defines.h"
 #include "opt-sched/Scheduler/sched_basic_data.h"
 #include "llvm/ADT/SmallVector.h"
@@ -164,8 +165,6 @@ protected:
   // If compiling on device, keep track of the pointers for all edges added
   // to facilitate a fast copy of edges to device
   std::vector<GraphEdge *> *edges_;
-  // Device array of all GraphEdges
-  GraphEdge *dev_edges_;
 
   // The number of issue types of the machine which this graph uses.
   int16_t issuTypeCnt_;
@@ -348,22 +347,10 @@ public:
   Register *getRegByTuple(RegIndxTuple *tuple) { 
     return RegFiles[tuple->regType_].GetReg(tuple->regNum_); 
   }
+  // Returns the flat image of the graph that the device copy reads its
+  // edges and register uses from. Only set on the device copy.
   __host__ __device__
-  RegIndxTuple *getUseByIndex(int index) {
-    return uses_ + index;
-  }
-
-  __host__ __device__
-  RegIndxTuple *getDefByIndex(int index) {
-    return defs_ + index;
-  }
-
-  int* scsrs_;
-  int* latencies_;
-  int* predOrder_;
-  RegIndxTuple* uses_;
-  RegIndxTuple* defs_;
-  int* ltncyPerPrdcsr_;
+  const DDGBlobView &GetDevDDGBlob() const { return dev_ddgBlob_; }
 
   // Number of threads used by parallel ACO.
   int numThreads_;
@@ -372,18 +359,21 @@ public:
   // object holds all registers for a given register type.
   RegisterFile *RegFiles;
 
-  // Deep Copies DDG's arrays to device and links them to device DDG pointer
-  void CopyPointersToDevice(DataDepGraph *dev_DDG, int numThreads = 0);
-  // Calls hipFree on all arrays/objects that were allocated with hipMalloc
-  void FreeDevicePointers(int numThreads);
-  // frees the dev_edges_ array, for some reason did not work in the destructor
-  void FreeDevEdges();
+  // Copies the instructions, the register files and ddgBlob, the image of
+  // this graph, to device arrays of the ACOContext and links them to the
+  // device copy of this graph. They stay valid until the context's arrays
+  // are reset.
+  void CopyToDevice(DataDepGraph *dev_DDG, const DDGBlob &ddgBlob,
+                    int numThreads);
 
 protected:
   // TODO(max): Get rid of this.
   // Number of basic blocks
   int32_t bscBlkCnt_;
 
+  // The image of the graph on the device copy
+  DDGBlobView dev_ddgBlob_;
+
   // How many instruction types are supported
   int16_t instTypeCnt_;
 
@@ -758,9 +748,18 @@ private:
   int totalStalls_, unnecessaryStalls_;
   bool isZeroPerp_;
 
+  // Hash of the slots filled so far, updated as they are appended and
+  // removed, so that equal schedules can be found without comparing them
+  uint64_t hash_;
+
   // Number of threads used by parallel ACO.
   int numThreads_;
 
+  // The number of elements the host arrays were allocated for
+  InstCount instCap_;
+  InstCount slotCap_;
+  int16_t regTypeCap_;
+
   bool VerifySlots_(MachineModel *machMdl, DataDepGraph *dataDepGraph);
   bool VerifyDataDeps_(DataDepGraph *dataDepGraph);
   __host__ __device__
@@ -772,6 +771,9 @@ public:
   // dummy constructor
   InstSchedule();
   ~InstSchedule();
+  // Makes this an empty schedule of another region, reusing the arrays if
+  // they are large enough
+  void Reinit(MachineModel *machMdl, DataDepGraph *dataDepGraph);
   bool operator==(InstSchedule &b) const;
 
   __host__ __device__
@@ -895,6 +897,14 @@ public:
   void setIsZeroPerp(bool isZeroPerp) { isZeroPerp_ = isZeroPerp; }
   __host__ __device__
   bool getIsZeroPerp() { return isZeroPerp_; }
+  // Returns a hash of the instructions and stalls in the schedule so far.
+  // Equal schedules have equal hashes.
+  __host__ __device__
+  uint64_t GetHash() const { return hash_; }
+  // Returns the instruction number (or SCHD_STALL) in each of the first
+  // GetSlotCnt() slots. Host only.
+  const InstCount *GetInstsInSlots() const { return instInSlot_; }
+  InstCount GetSlotCnt() const { return crntSlotNum_; }
 };
 /*****************************************************************************/
 
@@ -0,0 +1,294 @@
+/*******************************************************************************
+Description:  Defines a flat image of a region's data dependence graph. The
+              instruction attributes, the successor and predecessor lists in
+              CSR form, the register defs and uses of every instruction and
+              the register files are stored back to back in one block of
+              32-bit words. Sections refer to each other by word offsets
+              only, so the image can be copied, mapped or hashed as a whole
+              and read wherever it ends up.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_DDG_BLOB_H
+#define OPTSCHED_DDG_BLOB_H
+
+#include "opt-sched/Scheduler/defines.h"
+#include "opt-sched/Scheduler/machine_model.h"
+#include "opt-sched/Scheduler/sched_basic_data.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+class DataDepGraph;
+
+// Read access to an image built by DDGBlob. The view only holds a pointer to
+// the words, so it can be copied to the device together with the image and
+// read by the kernels.
+class DDGBlobView {
+public:
+  __host__ __device__
+  DDGBlobView() : words_(NULL) {}
+  // Views the image starting at words.
+  __host__ __device__
+  explicit DDGBlobView(const int32_t *words) : words_(words) {}
+
+  __host__ __device__
+  const int32_t *GetWords() const { return words_; }
+
+  __host__ __device__
+  InstCount GetInstCnt() const { return words_[HDR_INST_CNT]; }
+  __host__ __device__
+  int16_t GetRegTypeCnt() const { return words_[HDR_REG_TYPE_CNT]; }
+
+  __host__ __device__
+  InstType GetInstType(InstCount inst) const {
+    return InstField_(inst, INST_TYPE);
+  }
+  __host__ __device__
+  IssueType GetIssueType(InstCount inst) const {
+    return InstField_(inst, INST_ISSU_TYPE);
+  }
+  __host__ __device__
+  int GetMaxLtncy(InstCount inst) const {
+    return InstField_(inst, INST_MAX_LTNCY);
+  }
+  __host__ __device__
+  bool IsPipelined(InstCount inst) const {
+    return InstField_(inst, INST_FLAGS) & INST_PIPELINED;
+  }
+  __host__ __device__
+  bool MustBeInBBEntry(InstCount inst) const {
+    return InstField_(inst, INST_FLAGS) & INST_BB_ENTRY;
+  }
+
+  // The successors of inst are the edges [GetScsrBgn(inst), GetScsrEnd(inst))
+  __host__ __device__
+  size_t GetScsrBgn(InstCount inst) const {
+    return words_[words_[HDR_SCSR_OFFSETS] + inst];
+  }
+  __host__ __device__
+  size_t GetScsrEnd(InstCount inst) const {
+    return words_[words_[HDR_SCSR_OFFSETS] + inst + 1];
+  }
+  __host__ __device__
+  InstCount GetScsr(size_t edge) const {
+    return EdgeField_(HDR_SCSRS, edge, EDGE_OTHER);
+  }
+  __host__ __device__
+  int GetScsrLtncy(size_t edge) const {
+    return EdgeField_(HDR_SCSRS, edge, EDGE_LTNCY);
+  }
+  __host__ __device__
+  DependenceType GetScsrDepType(size_t edge) const {
+    return (DependenceType)EdgeField_(HDR_SCSRS, edge, EDGE_DEP_TYPE);
+  }
+  // Returns the position of the edge among the predecessors of its successor
+  __host__ __device__
+  InstCount GetScsrPrdcsrNum(size_t edge) const {
+    return EdgeField_(HDR_SCSRS, edge, EDGE_OTHER_NUM);
+  }
+
+  // Same as above for the predecessors
+  __host__ __device__
+  size_t GetPrdcsrBgn(InstCount inst) const {
+    return words_[words_[HDR_PRDCSR_OFFSETS] + inst];
+  }
+  __host__ __device__
+  size_t GetPrdcsrEnd(InstCount inst) const {
+    return words_[words_[HDR_PRDCSR_OFFSETS] + inst + 1];
+  }
+  __host__ __device__
+  InstCount GetPrdcsr(size_t edge) const {
+    return EdgeField_(HDR_PRDCSRS, edge, EDGE_OTHER);
+  }
+  __host__ __device__
+  int GetPrdcsrLtncy(size_t edge) const {
+    return EdgeField_(HDR_PRDCSRS, edge, EDGE_LTNCY);
+  }
+  __host__ __device__
+  DependenceType GetPrdcsrDepType(size_t edge) const {
+    return (DependenceType)EdgeField_(HDR_PRDCSRS, edge, EDGE_DEP_TYPE);
+  }
+  // Returns the position of the edge among the successors of its predecessor
+  __host__ __device__
+  InstCount GetPrdcsrScsrNum(size_t edge) const {
+    return EdgeField_(HDR_PRDCSRS, edge, EDGE_OTHER_NUM);
+  }
+
+  // Returns the registers defined and used by inst.
+  __host__ __device__
+  int16_t GetDefCnt(InstCount inst) const {
+    return words_[words_[HDR_USE_OFFSETS] + inst] -
+           words_[words_[HDR_DEF_OFFSETS] + inst];
+  }
+  __host__ __device__
+  RegIndxTuple GetDef(InstCount inst, int16_t indx) const {
+    return RegTuple_(words_[words_[HDR_DEF_OFFSETS] + inst] + indx);
+  }
+  __host__ __device__
+  int16_t GetUseCnt(InstCount inst) const {
+    return words_[words_[HDR_DEF_OFFSETS] + inst + 1] -
+           words_[words_[HDR_USE_OFFSETS] + inst];
+  }
+  __host__ __device__
+  RegIndxTuple GetUse(InstCount inst, int16_t indx) const {
+    return RegTuple_(words_[words_[HDR_USE_OFFSETS] + inst] + indx);
+  }
+
+  // Returns the attributes of the register files and their registers.
+  __host__ __device__
+  int GetRegCnt(int16_t regType) const {
+    return words_[words_[HDR_REG_FILES] + regType * RF_FIELD_CNT + RF_REG_CNT];
+  }
+  __host__ __device__
+  int GetPhysRegCnt(int16_t regType) const {
+    return words_[words_[HDR_REG_FILES] + regType * RF_FIELD_CNT +
+                  RF_PHYS_REG_CNT];
+  }
+  __host__ __device__
+  int GetRegWght(int16_t regType, int regNum) const {
+    return RegField_(regType, regNum, REG_WGHT);
+  }
+  __host__ __device__
+  int GetRegUseCnt(int16_t regType, int regNum) const {
+    return RegField_(regType, regNum, REG_USE_CNT);
+  }
+  __host__ __device__
+  int GetRegPhysNum(int16_t regType, int regNum) const {
+    return RegField_(regType, regNum, REG_PHYS_NUM);
+  }
+  __host__ __device__
+  bool IsRegLiveIn(int16_t regType, int regNum) const {
+    return RegField_(regType, regNum, REG_FLAGS) & REG_LIVE_IN;
+  }
+  __host__ __device__
+  bool IsRegLiveOut(int16_t regType, int regNum) const {
+    return RegField_(regType, regNum, REG_FLAGS) & REG_LIVE_OUT;
+  }
+
+protected:
+  // The header holds the counts and the word offset of every section.
+  enum HeaderField {
+    HDR_MAGIC,
+    HDR_VERSION,
+    HDR_INST_CNT,
+    HDR_EDGE_CNT,
+    HDR_REG_TYPE_CNT,
+    HDR_REG_CNT,
+    HDR_INSTS,
+    HDR_SCSR_OFFSETS,
+    HDR_SCSRS,
+    HDR_PRDCSR_OFFSETS,
+    HDR_PRDCSRS,
+    HDR_DEF_OFFSETS,
+    HDR_USE_OFFSETS,
+    HDR_REG_TUPLES,
+    HDR_REG_FILES,
+    HDR_REGS,
+    HDR_SIZE,
+    HDR_FIELD_CNT
+  };
+  enum InstField {
+    INST_TYPE,
+    INST_ISSU_TYPE,
+    INST_MAX_LTNCY,
+    INST_FLAGS,
+    INST_FIELD_CNT
+  };
+  enum InstFlag { INST_PIPELINED = 1, INST_BB_ENTRY = 2 };
+  // Every edge is stored as (other instruction, latency, dependence type,
+  // position of the edge in the list of the other instruction)
+  enum EdgeField {
+    EDGE_OTHER,
+    EDGE_LTNCY,
+    EDGE_DEP_TYPE,
+    EDGE_OTHER_NUM,
+    EDGE_FIELD_CNT
+  };
+  // A register file is stored as (register count, physical register count,
+  // index of its first register)
+  enum RegFileField { RF_REG_CNT, RF_PHYS_REG_CNT, RF_FRST_REG, RF_FIELD_CNT };
+  enum RegField { REG_WGHT, REG_USE_CNT, REG_PHYS_NUM, REG_FLAGS, REG_FIELD_CNT };
+  enum RegFlag { REG_LIVE_IN = 1, REG_LIVE_OUT = 2 };
+
+  const int32_t *words_;
+
+  __host__ __device__
+  int32_t InstField_(InstCount inst, int field) const {
+    return words_[words_[HDR_INSTS] + inst * INST_FIELD_CNT + field];
+  }
+  __host__ __device__
+  int32_t EdgeField_(int section, size_t edge, int field) const {
+    return words_[words_[section] + edge * EDGE_FIELD_CNT + field];
+  }
+  __host__ __device__
+  int32_t RegField_(int16_t regType, int regNum, int field) const {
+    int32_t frstReg =
+        words_[words_[HDR_REG_FILES] + regType * RF_FIELD_CNT + RF_FRST_REG];
+    return words_[words_[HDR_REGS] + (frstReg + regNum) * REG_FIELD_CNT +
+                  field];
+  }
+  __host__ __device__
+  RegIndxTuple RegTuple_(size_t indx) const {
+    const int32_t *tuple = &words_[words_[HDR_REG_TUPLES] + indx * 2];
+    return RegIndxTuple(tuple[0], tuple[1]);
+  }
+};
+
+// Owns an image and builds it from a graph or checks one read from outside.
+class DDGBlob : public DDGBlobView {
+public:
+  DDGBlob() {}
+  DDGBlob(const DDGBlob &other) : DDGBlobView(), storage_(other.storage_) {
+    Attach_();
+  }
+  DDGBlob &operator=(const DDGBlob &other) {
+    storage_ = other.storage_;
+    Attach_();
+    return *this;
+  }
+
+  // Replaces the image with one of the given graph. Requires the register
+  // files to be set up.
+  void Build(DataDepGraph *dataDepGraph);
+  // Replaces the image with a copy of an image made by Build(), e.g. read
+  // from a file or received from another process. Returns false, leaving the
+  // image empty, if it is malformed.
+  bool Assign(const void *data, size_t size);
+  // Empties the image.
+  void Clear() {
+    storage_.clear();
+    Attach_();
+  }
+
+  const void *GetData() const { return storage_.data(); }
+  // Returns the size of the image in bytes.
+  size_t GetSize() const { return storage_.size() * sizeof(int32_t); }
+  // Returns a hash of the whole image.
+  uint64_t GetHash() const;
+  bool operator==(const DDGBlob &other) const {
+    return storage_ == other.storage_;
+  }
+
+private:
+  static const int32_t MAGIC = 0x4744444f;
+  static const int32_t VERSION = 2;
+
+  std::vector<int32_t> storage_;
+
+  // Points the view at the storage after it changed.
+  void Attach_() { words_ = storage_.empty() ? NULL : storage_.data(); }
+  // Fills in the positions of the edges in the list of the other instruction.
+  void NumberEdges_();
+  // Checks that the header, the offsets and the references of the image are
+  // consistent.
+  bool Validate_() const;
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
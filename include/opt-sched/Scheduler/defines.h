@@ -28,8 +28,13 @@ typedef int InstCount;
 // type for the aco heuristics and ready list keys
 typedef unsigned long HeurType;
 
-// Pheromone type
+// Pheromone type. Single precision halves the size of the pheromone table
+// and of the ready list scores.
+#ifdef OPTSCHED_FLOAT_PHEROMONE
+typedef float pheromone_t;
+#else
 typedef double pheromone_t;
+#endif
 
 // A generic sentinel value. Should be used with care.
 // TODO(max): Get rid of this in favor of type- or purpose-specific sentinels.
@@ -14,6 +14,7 @@ Last Update:  Apr. 2020
 #include "opt-sched/Scheduler/mem_mngr.h"
 #include "opt-sched/Scheduler/ready_list.h"
 #include "opt-sched/Scheduler/relaxed_sched.h"
+#include <deque>
 #include <iostream>
 #include <vector>
 #include <hip/hip_runtime.h>
@@ -55,11 +56,13 @@ struct TightndInst {
 class Enumerator;
 class HistEnumTreeNode;
 class CostHistEnumTreeNode;
+class SharedHistTable;
 
 class EnumTreeNode {
 private:
   friend class HistEnumTreeNode;
   friend class CostHistEnumTreeNode;
+  friend class SharedHistTable;
 
   class ExaminedInst {
   private:
@@ -336,6 +339,7 @@ protected:
   friend class EnumTreeNode;
   friend class HistEnumTreeNode;
   friend class CostHistEnumTreeNode;
+  friend class SharedHistTable;
 
   // TODO(max): Document.
   bool isCnstrctd_;
@@ -371,10 +375,33 @@ protected:
   uint64_t maxNodeCnt_;
   uint64_t createdNodeCnt_;
   uint64_t exmndNodeCnt_;
+  // The maximum number of nodes that one search may examine before it times
+  // out, or 0 if it is not limited.
+  uint64_t nodeBudget_ = 0;
 
   InstCount minUnschduldTplgclOrdr_;
 
   BinHashTable<HistEnumTreeNode> *exmndSubProbs_;
+  // If set, the sub-problems examined by this and the other enumerators of
+  // the region are also checked for domination.
+  SharedHistTable *sharedHist_ = nullptr;
+
+  // The maximum number of bytes that the history table may use, or 0 if it
+  // is not limited. Once the limit is exceeded, the nodes in histQueue_ are
+  // evicted in a clock (second chance) order: a node that dominated another
+  // node since it was last considered is moved to the back of the queue
+  // instead.
+  uint64_t histMemLimit_ = 0;
+  std::deque<HistEnumTreeNode *> histQueue_;
+  // The bytes used by the history table, counting its entries and the
+  // history nodes added to it until they are freed.
+  uint64_t histMemUsed_ = 0;
+  uint64_t maxHistMemUsed_ = 0;
+  // The results of the history table lookups and evictions since the last
+  // reset.
+  uint64_t histHitCnt_ = 0;
+  uint64_t histMissCnt_ = 0;
+  uint64_t histEvictionCnt_ = 0;
 
   // A list of insts whose lower bounds have been tightened to be used for
   // efficient untightening
@@ -438,9 +465,25 @@ protected:
   // history domination
   HistEnumTreeNode *mostRecentMatchingHistNode_ = nullptr;
 
+  // If set, only the sub-tree below this partial schedule is searched. It
+  // holds the number of the instruction (or SCHD_STALL) in each of the
+  // first slots.
+  const std::vector<InstCount> *prefix_ = nullptr;
+
+  // If set, the search stops at nodes of splitDepth_ slots and adds their
+  // partial schedules to splitPrefixes_ instead of searching below them.
+  InstCount splitDepth_ = INVALID_VALUE;
+  std::vector<std::vector<InstCount>> *splitPrefixes_ = nullptr;
+
   inline void ClearState_();
   inline bool IsStateClear_();
 
+  // Is a prefix set that the branch from the current node by scheduling
+  // instNum in the next slot leaves?
+  inline bool IsOffPrefix_(InstCount instNum);
+  // Adds the partial schedule of the current node to splitPrefixes_.
+  void AddSplitPrefix_();
+
   // Can we find an instruction that uses a register in the ready list
   bool IsUseInRdyLst_();
 
@@ -479,6 +522,17 @@ protected:
   // by scheduling the given instruction next
   bool WasDmnntSubProbExmnd_(SchedInstruction *inst, EnumTreeNode *&newNode);
 
+  // Accounts for a history node that has just been added to the history
+  // table and evicts other nodes if the table grew beyond its limit.
+  void AddToHistory_(HistEnumTreeNode *histNode,
+                     HashTblEntry<HistEnumTreeNode> *tblEntry);
+  void EvictHistory_();
+  // Drops a reference to a history node, freeing it and any of its
+  // ancestors that are no longer referenced.
+  void ReleaseHistNode_(HistEnumTreeNode *histNode);
+  // Adds the usage of the history table to the stats.
+  void RecordHistStats_();
+
   bool TightnLwrBounds_(SchedInstruction *inst);
   void UnTightnLwrBounds_(SchedInstruction *newInst);
   void CmtLwrBoundTightnng_();
@@ -505,6 +559,8 @@ protected:
   virtual void SetupAllocators_();
   virtual void FreeAllocators_();
   virtual void ResetAllocators_();
+  // Resets the ready lists and the bounds left by the last search.
+  void ResetSearch_();
 
   void PrintLog_();
 
@@ -536,6 +592,10 @@ public:
   virtual ~Enumerator();
   __host__
   virtual void Reset();
+  // Like Reset(), but keeps the history of the examined sub-problems for
+  // another search at the same target length.
+  __host__
+  void ResetKeepingHistory();
 
   // Get the number of nodes that have been examined
   inline uint64_t GetNodeCnt();
@@ -549,6 +609,26 @@ public:
   // (Chris)
   inline bool IsSchedForRPOnly() const { return SchedForRPOnly_; }
 
+  // Restricts the following searches to the sub-tree below the given
+  // partial schedule (see prefix_), or searches the whole tree again if
+  // prefix is NULL. The prefix must stay alive while it is set.
+  void SetPrefix(const std::vector<InstCount> *prefix) { prefix_ = prefix; }
+
+  // Shares the history of the examined sub-problems with the other
+  // enumerators that use the given table, or stops sharing it if the table
+  // is NULL. The table must stay alive while it is set.
+  void SetSharedHistory(SharedHistTable *sharedHist) {
+    sharedHist_ = sharedHist;
+  }
+
+  // Limits the memory used by the history table to the given number of
+  // bytes, or removes the limit if it is 0.
+  void SetHistMemLimit(uint64_t histMemLimit) { histMemLimit_ = histMemLimit; }
+
+  // Makes each following search time out once it has examined the given
+  // number of nodes, or removes the limit if it is 0.
+  void SetNodeBudget(uint64_t nodeBudget) { nodeBudget_ = nodeBudget; }
+
   // Calculates the schedule and returns it in the passed argument.
   __host__
   FUNC_RESULT FindSchedule(InstSchedule *sched, SchedRegion *rgn) {
@@ -644,6 +724,16 @@ public:
   FUNC_RESULT FindFeasibleSchedule(InstSchedule *sched, InstCount trgtLngth,
                                    SchedRegion *rgn, int costLwrBound,
                                    Milliseconds deadline);
+  // Searches like FindFeasibleSchedule() down to splitDepth slots only. The
+  // partial schedules of that length that may still lead to a better
+  // schedule are added to prefixes, so that they can be searched separately
+  // with SetPrefix(). Complete schedules found on the way update the region
+  // as usual.
+  FUNC_RESULT FindSubProblems(InstSchedule *sched, InstCount trgtLngth,
+                              SchedRegion *rgn, int costLwrBound,
+                              InstCount splitDepth,
+                              std::vector<std::vector<InstCount>> &prefixes,
+                              Milliseconds deadline);
   bool IsCostEnum();
   SPILL_COST_FUNCTION GetSpillCostFunc() { return spillCostFunc_; }
   inline InstCount GetBestCost() { return GetBestCost_(); }
@@ -1037,6 +1127,13 @@ inline int Enumerator::GetSlotNumFrmTime_(InstCount time) {
 bool Enumerator::IsHistDom() { return prune_.histDom; }
 /******************************************************************************/
 
+inline bool Enumerator::IsOffPrefix_(InstCount instNum) {
+  InstCount time = crntNode_->GetTime();
+  return prefix_ != NULL && time < (InstCount)prefix_->size() &&
+         (*prefix_)[time] != instNum;
+}
+/******************************************************************************/
+
 bool Enumerator::IsRlxdPrnng() { return prune_.rlxd; }
 /******************************************************************************/
 
@@ -38,6 +38,7 @@ enum SchedulerType {
 };
 
 // Forward declarations used to reduce the number of #includes.
+class AntState;
 class MachineModel;
 class DataDepStruct;
 class DataDepGraph;
@@ -102,6 +103,8 @@ protected:
   // Returns whether all instructions have been scheduled.
   __host__ __device__
   bool IsSchedComplete_();
+  // As above, for the schedule being built by a single ACO ant.
+  bool IsSchedComplete_(const AntState &State) const;
 };
 
 // An abstract base class for constrained schedulers, regular schedulers that
@@ -272,6 +275,18 @@ protected:
   __host__ __device__
   void UpdtSlotAvlblty_(SchedInstruction *inst);
 
+  // Versions of the above that read and update the state of a single ant
+  // instead of the scheduler's members, the instructions and the registers.
+  // They only touch the passed AntState and may therefore be called for
+  // several ants at the same time.
+  bool Initialize_(AntState &State);
+  void InitNewCycle_(AntState &State);
+  void SchdulInst_(AntState &State, SchedInstruction *inst);
+  void DoRsrvSlots_(AntState &State, SchedInstruction *inst);
+  bool MovToNxtSlot_(AntState &State, SchedInstruction *inst);
+  bool ChkInstLglty_(const AntState &State, SchedInstruction *inst) const;
+  void UpdtSlotAvlblty_(AntState &State, SchedInstruction *inst);
+
   // A pure virtual function for updating the ready list. Each concrete
   // scheduler should define its own version.
   //__host__ __device__
@@ -40,6 +40,7 @@ public:
   void Clean();
   void ReplaceParent(HistEnumTreeNode *newParent);
   // Does the scheduled inst. list of this node match that of the given node
+  // (compares the hashes and sizes of the two sets)
   bool DoesMatch(EnumTreeNode *node, Enumerator *enumrtr);
   // Is the sub-problem at this node dominated by the given node's?
   bool IsDominated(EnumTreeNode *node, Enumerator *enumrtr);
@@ -53,6 +54,27 @@ public:
   SetSuffix(const std::shared_ptr<std::vector<SchedInstruction *>> &suffix);
   std::vector<InstCount> GetPrefix() const;
 
+  // Counts another reference to this node, from the history table or from
+  // the history node of a child.
+  void AddRef() { refCnt_++; }
+  // Drops a reference to this node. Returns true if it was the last one.
+  bool Release() { return --refCnt_ == 0; }
+  // Marks the node as having dominated another node.
+  void SetDmntnHit() { dmntnHit_ = true; }
+  // Returns whether the node dominated another node since the last call.
+  bool TakeDmntnHit() {
+    bool dmntnHit = dmntnHit_;
+    dmntnHit_ = false;
+    return dmntnHit;
+  }
+  HashTblEntry<HistEnumTreeNode> *GetTblEntry() const { return tblEntry_; }
+  void SetTblEntry(HashTblEntry<HistEnumTreeNode> *tblEntry) {
+    tblEntry_ = tblEntry;
+  }
+  // Returns the number of bytes used by this node. A suffix shared with
+  // other nodes is counted for each of them.
+  size_t GetMemSize(int issuRate) const;
+
   //not implemented for this class
   void CopyPointersToDevice(HistEnumTreeNode *dev_node){
       Logger::Fatal("Unimplemented.\n");
@@ -61,26 +83,48 @@ public:
 
 
 protected:
+  // The members are ordered by size to keep the node free of padding.
   HistEnumTreeNode *prevNode_;
 
+  ReserveSlot *rsrvSlots_;
+
+  // (Chris)
+  std::shared_ptr<std::vector<SchedInstruction *>> suffix_ = nullptr;
+
+  // The entry of this node in the history table, if it is in the table.
+  HashTblEntry<HistEnumTreeNode> *tblEntry_ = nullptr;
+
+  // A hash of the set of scheduled instructions, independent of their order.
+  // The low 16 bits hold the size of the set and the rest a 48-bit hash of
+  // its instructions, so that matching sets can be told apart from other
+  // sets in the same table entry without tracing back the parents.
+  uint64_t schduldSetHash_;
+
   // The current time or position (or step number) in the scheduling process.
   // This is equal to the length of the path from the root node to this node.
   InstCount time_;
 
-  SchedInstruction *inst_;
+  // The number of the instruction scheduled at this node, or SCHD_STALL.
+  InstCount instNum_;
+
+  // The number of references to this node (see AddRef()). The node is
+  // referenced by its tree node until it is added to the history table.
+  int refCnt_ = 0;
+
+  bool crntCycleBlkd_;
+
+  // Did this node dominate another node since the history table last
+  // considered it for eviction?
+  bool dmntnHit_ = false;
 
 #ifdef IS_DEBUG
   bool isCnstrctd_;
 #endif
 
-  bool crntCycleBlkd_;
-  ReserveSlot *rsrvSlots_;
-
-  // (Chris)
-  std::shared_ptr<std::vector<SchedInstruction *>> suffix_ = nullptr;
+  virtual size_t GetObjSize_() const { return sizeof(HistEnumTreeNode); }
 
   InstCount SetLastInsts_(SchedInstruction *lastInsts[], InstCount thisTime,
-                          InstCount minTimeToExmn);
+                          InstCount minTimeToExmn, Enumerator *enumrtr);
   void SetInstsSchduld_(BitVector *instsSchduld);
   // Does this history node dominate the given node or history node?
   bool DoesDominate_(EnumTreeNode *node, HistEnumTreeNode *othrHstry,
@@ -99,8 +143,18 @@ protected:
   InstCount GetMinTimeToExmn_(InstCount nodeTime, Enumerator *enumrtr);
   InstCount GetLwrBound_(SchedInstruction *inst, int16_t issuRate);
   void SetRsrvSlots_(EnumTreeNode *node);
+  SchedInstruction *GetInst_(Enumerator *enumrtr) const;
 };
 
+// Should a node be pruned based on RP cost by an examined sub-problem of the
+// given time and costs that scheduled the same instructions and dominates it
+// otherwise?
+bool doesHistoryCostDominate(EnumTreeNode *Node, Enumerator *E,
+                             InstCount HistTime, InstCount HistCost,
+                             InstCount HistPartialCost,
+                             InstCount HistTotalCost,
+                             InstCount HistSpillCostSum);
+
 class CostHistEnumTreeNode : public HistEnumTreeNode {
 public:
   CostHistEnumTreeNode();
@@ -118,6 +172,13 @@ public:
   }
 
 protected:
+  // The flags come first to fill the end of the base node.
+  bool totalCostIsActualCost_ = false;
+  bool isLngthFsbl_;
+#ifdef IS_DEBUG
+  bool costInfoSet_;
+#endif
+
   // Why do we need to copy this data from region->tree_node->hist_node
   InstCount cost_;
   InstCount peakSpillCost_;
@@ -126,13 +187,11 @@ protected:
   // (Chris)
   InstCount totalCost_ = -1;
   InstCount partialCost_ = -1;
-  bool totalCostIsActualCost_ = false;
-
-  bool isLngthFsbl_;
-#ifdef IS_DEBUG
-  bool costInfoSet_;
-#endif
+  // The best cost when the node was archived. The costs below the node only
+  // rule out the schedules that could not have beaten it.
+  InstCount costBound_;
 
+  size_t GetObjSize_() const { return sizeof(CostHistEnumTreeNode); }
   bool ChkCostDmntnForBBSpill_(EnumTreeNode *node, Enumerator *enumrtr);
   bool ChkCostDmntn_(EnumTreeNode *node, Enumerator *enumrtr,
                      InstCount &maxShft);
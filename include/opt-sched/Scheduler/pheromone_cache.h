@@ -0,0 +1,69 @@
+/*******************************************************************************
+Description:  Defines a cache of converged ACO pheromone tables shared by all
+              regions scheduled by the process. The tables are keyed by a
+              hash of the region's data dependence graph and of the
+              objective of the run, so a region that is scheduled again
+              for the same objective can start from what an earlier run
+              learned. The graph is kept with the table and compared on
+              lookup, so a hash collision never returns another region's
+              table.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_PHEROMONE_CACHE_H
+#define OPTSCHED_PHEROMONE_CACHE_H
+
+#include "opt-sched/Scheduler/ddg_blob.h"
+#include "opt-sched/Scheduler/defines.h"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+class PheromoneCache {
+public:
+  static PheromoneCache &getInstance();
+
+  PheromoneCache(const PheromoneCache &) = delete;
+  void operator=(const PheromoneCache &) = delete;
+
+  // Sets the maximum number of tables kept. The oldest tables are dropped
+  // first. 0 disables the cache.
+  void SetCapacity(size_t capacity);
+
+  // Copies the table stored for key into table. Returns false if there is
+  // none or it was stored for a different graph, with a different layout
+  // (sparse or not) or size.
+  bool Lookup(uint64_t key, const DDGBlob &graph, bool sparse,
+              std::vector<pheromone_t> &table);
+  // Stores a table for key and graph, replacing any table stored for the key
+  // before.
+  void Insert(uint64_t key, const DDGBlob &graph, bool sparse,
+              std::vector<pheromone_t> table);
+
+private:
+  PheromoneCache() : capacity_(0) {}
+
+  struct Entry {
+    DDGBlob graph;
+    bool sparse;
+    std::vector<pheromone_t> table;
+  };
+
+  std::mutex mutex_;
+  size_t capacity_;
+  std::unordered_map<uint64_t, Entry> entries_;
+  // Keys in insertion order, oldest first.
+  std::deque<uint64_t> order_;
+
+  void Evict_();
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
@@ -0,0 +1,68 @@
+/*******************************************************************************
+Description:  Defines a compressed pheromone table for host ACO. Only the
+              (from, to) pairs that can be adjacent in some legal schedule of
+              the region are stored, which on large regions is a small
+              fraction of the dense (n + 1) x n table.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_PHEROMONE_TABLE_H
+#define OPTSCHED_PHEROMONE_TABLE_H
+
+#include "opt-sched/Scheduler/defines.h"
+#include <cstddef>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+class DataDepGraph;
+
+class SparsePheromoneTable {
+public:
+  SparsePheromoneTable();
+
+  // Finds the pairs that can be adjacent in a schedule of the given graph
+  // and allocates an entry for each of them. Requires the transitive closure
+  // of the graph. Gives up and returns false, leaving the table empty, as
+  // soon as more than maxEntryCnt pairs are found.
+  bool Construct(DataDepGraph *dataDepGraph, size_t maxEntryCnt);
+  // Frees all entries.
+  void Clear();
+
+  // Returns the pheromone on the path from instruction from to instruction
+  // to. A from of -1 means the empty schedule. Pairs that are not stored can
+  // never be adjacent, so they have no pheromone.
+  pheromone_t Get(InstCount from, InstCount to) const;
+  // Returns the entry of the pair to update it, or NULL if the pair is not
+  // stored.
+  pheromone_t *Find(InstCount from, InstCount to);
+  // Sets every entry to value.
+  void Fill(pheromone_t value);
+
+  // Entries of row from (-1 for the empty schedule) are the indices in
+  // [GetRowBgn(from), GetRowEnd(from)).
+  size_t GetRowBgn(InstCount from) const { return rowOffsets_[from + 1]; }
+  size_t GetRowEnd(InstCount from) const { return rowOffsets_[from + 2]; }
+  InstCount GetTo(size_t indx) const { return cols_[indx]; }
+  pheromone_t &GetEntry(size_t indx) { return vals_[indx]; }
+
+  // Returns the total number of stored pairs.
+  size_t GetEntryCnt() const { return vals_.size(); }
+
+private:
+  InstCount instCnt_;
+  // Row from + 1 holds the pairs starting at from, sorted by to.
+  std::vector<size_t> rowOffsets_;
+  std::vector<InstCount> cols_;
+  std::vector<pheromone_t> vals_;
+
+  // Returns the index of the entry of the pair, or GetEntryCnt() if the pair
+  // is not stored.
+  size_t FindIndx_(InstCount from, InstCount to) const;
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
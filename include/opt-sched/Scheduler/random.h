@@ -14,6 +14,8 @@ Last Update:  Mar. 2011
 namespace llvm {
 namespace opt_sched {
 
+// The generator state is kept per thread; a thread that schedules a region
+// must seed its own generator.
 namespace RandomGen {
 // Initialize the random number generator with a seed.
 void SetSeed(int32_t iseed);
@@ -26,6 +28,17 @@ uint64_t GetRand64();
 // Fill a buffer with a specified number of random bits, rounded to the
 // nearest byte boundary.
 void GetRandBits(uint16_t bitCnt, unsigned char *dest);
+// Get the seed the generator was last initialized with.
+int32_t GetSeed();
+
+// Counter-based generation. These keep no state: the value for a given key
+// and counter is always the same, so independent streams can be drawn in any
+// order or on any thread.
+// Derive a new key from a key and one more value, e.g. a region, iteration
+// or ant number.
+uint64_t MixKey(uint64_t key, uint64_t value);
+// Get the random 64-bit value at position counter of the stream of key.
+uint64_t GetCounterRand64(uint64_t key, uint64_t counter);
 } // namespace RandomGen
 
 } // namespace opt_sched
@@ -0,0 +1,151 @@
+/*******************************************************************************
+Description:  Defines a tree over the heuristic factors of the entries of a
+              host ant's ready list. Every node keeps the sum and the maximum
+              of the factors of the entries below it, so an entry can be drawn
+              in proportion to its factor, and the entries whose scores may
+              still be the highest can be found, in time logarithmic in the
+              size of the ready list. Entries are indexed like the ready list.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_READY_HEUR_TREE_H
+#define OPTSCHED_READY_HEUR_TREE_H
+
+#include "opt-sched/Scheduler/defines.h"
+#include <algorithm>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+class ReadyHeurTree {
+public:
+  ReadyHeurTree() : leafCnt_(0) {}
+
+  // Sets the factors of all entries to 0.
+  void Clear() {
+    std::fill(sums_.begin(), sums_.end(), 0);
+    std::fill(maxs_.begin(), maxs_.end(), 0);
+  }
+
+  // Sets the factor of the entry at the given index. An entry that is not in
+  // the ready list has a factor of 0.
+  void Set(InstCount indx, pheromone_t factor) {
+    if (indx >= leafCnt_)
+      Grow_(indx + 1);
+    size_t node = leafCnt_ + indx;
+    sums_[node] = factor;
+    maxs_[node] = factor;
+    for (node /= 2; node > 0; node /= 2) {
+      sums_[node] = sums_[2 * node] + sums_[2 * node + 1];
+      maxs_[node] = std::max(maxs_[2 * node], maxs_[2 * node + 1]);
+    }
+  }
+
+  pheromone_t Get(InstCount indx) const {
+    return indx < leafCnt_ ? sums_[leafCnt_ + indx] : 0;
+  }
+
+  // Returns the sum of the factors of all entries.
+  pheromone_t GetSum() const { return leafCnt_ == 0 ? 0 : sums_[1]; }
+
+  // Returns the index of the entry at which the running sum of the factors
+  // passes point, for a point in [0, GetSum()). Rounding may lead past the
+  // last entry, to an entry with a factor of 0.
+  InstCount Find(pheromone_t point) const {
+    size_t node = 1;
+    while (node < (size_t)leafCnt_) {
+      if (point < sums_[2 * node]) {
+        node = 2 * node;
+      } else {
+        point -= sums_[2 * node];
+        node = 2 * node + 1;
+      }
+    }
+    return node - leafCnt_;
+  }
+
+  // Returns the lowest index of the entries with the highest score, or -1 if
+  // all scores are negative. score(indx) gives the score of an entry, which
+  // must not exceed max(bound * factor, minScore). A subtree is only
+  // searched if that limit allows an entry in it to beat the best entry so
+  // far, and the subtree with the higher factor is searched first.
+  template <typename ScoreFn>
+  InstCount FindMax(pheromone_t bound, pheromone_t minScore,
+                    ScoreFn score) const {
+    InstCount bestIndx = -1;
+    pheromone_t bestScore = -1;
+    if (leafCnt_ == 0)
+      return bestIndx;
+
+    // At most one unsearched sibling per level is left on the stack.
+    struct Subtree {
+      size_t node;
+      InstCount bgn;
+      InstCount size;
+    } stack[2 * 8 * sizeof(InstCount) + 2];
+    int top = 0;
+    stack[top++] = Subtree{1, 0, leafCnt_};
+    while (top > 0) {
+      Subtree crnt = stack[--top];
+      if (maxs_[crnt.node] == 0)
+        continue;
+      pheromone_t limit = std::max(bound * maxs_[crnt.node], minScore);
+      if (limit < bestScore || (limit == bestScore && crnt.bgn > bestIndx))
+        continue;
+
+      if (crnt.size == 1) {
+        pheromone_t crntScore = score(crnt.bgn);
+        if (crntScore > bestScore ||
+            (crntScore == bestScore && crnt.bgn < bestIndx)) {
+          bestScore = crntScore;
+          bestIndx = crnt.bgn;
+        }
+        continue;
+      }
+
+      InstCount half = crnt.size / 2;
+      Subtree left{2 * crnt.node, crnt.bgn, half};
+      Subtree right{2 * crnt.node + 1, crnt.bgn + half, half};
+      if (maxs_[left.node] >= maxs_[right.node]) {
+        stack[top++] = right;
+        stack[top++] = left;
+      } else {
+        stack[top++] = left;
+        stack[top++] = right;
+      }
+    }
+    return bestIndx;
+  }
+
+private:
+  // The number of leaves, a power of 2. Node 1 is the root, the children of
+  // node n are nodes 2n and 2n + 1, and the leaf of entry i is node
+  // leafCnt_ + i.
+  InstCount leafCnt_;
+  std::vector<pheromone_t> sums_;
+  std::vector<pheromone_t> maxs_;
+
+  void Grow_(InstCount entryCnt) {
+    InstCount leafCnt = std::max<InstCount>(leafCnt_, 1);
+    while (leafCnt < entryCnt)
+      leafCnt *= 2;
+    std::vector<pheromone_t> sums(2 * leafCnt, 0), maxs(2 * leafCnt, 0);
+    for (InstCount i = 0; i < leafCnt_; i++) {
+      sums[leafCnt + i] = sums_[leafCnt_ + i];
+      maxs[leafCnt + i] = maxs_[leafCnt_ + i];
+    }
+    for (size_t node = leafCnt - 1; node > 0; node--) {
+      sums[node] = sums[2 * node] + sums[2 * node + 1];
+      maxs[node] = std::max(maxs[2 * node], maxs[2 * node + 1]);
+    }
+    sums_.swap(sums);
+    maxs_.swap(maxs);
+    leafCnt_ = leafCnt;
+  }
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
@@ -90,9 +90,10 @@ class KeysHelper2 {
   __host__ __device__
   void initForRegion(DataDepGraph *DDG);
 
-  // compute key
+  // compute key. On the device the block selects the priorities instead of
+  // whichPrirts.
   __host__ __device__
-  HeurType computeKey(SchedInstruction *Inst, bool IncludeDynamic, RegisterFile *RegFiles = NULL, DataDepGraph *ddg = NULL) const;
+  HeurType computeKey(SchedInstruction *Inst, bool IncludeDynamic, RegisterFile *RegFiles = NULL, DataDepGraph *ddg = NULL, int whichPrirts = 1) const;
   __host__ __device__
   HeurType computeKey(const uint64_t *Values, int whichPrirts = 1) const;
 
@@ -123,10 +123,8 @@ public:
   // for reinitialization in the next region
   __device__
   void ResetLiveIntervals();
-  // Allocates a device array that holds values for each parallel thread
-  void AllocDevArrayForParallelACO(int numThreads);
-  // Calls hipFree on all arrays/objects that were allocated with hipMalloc
-  void FreeDevicePointers();
+  // Sets the device array that holds values for each parallel thread
+  void SetDevArrayForParallelACO(int *dev_crntUseCnt);
 
 private:
   int16_t type_;
@@ -214,10 +212,10 @@ public:
   // so they can be reinitialized for the next region
   __device__
   void Reset();
-  // Copies all array/objects to device and links them to device pointer
-  void CopyPointersToDevice(RegisterFile *dev_regFile);
-  // Calls hipFree on all arrays/objects that were allocated with hipMalloc
-  void FreeDevicePointers();
+  // Copies the registers to device arrays of the ACOContext, together with
+  // the values they keep for each parallel thread, and links them to the
+  // device register file
+  void CopyToDevice(RegisterFile *dev_regFile, int numThreads);
 
 private:
   int16_t regType_;
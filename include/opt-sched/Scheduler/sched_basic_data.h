@@ -329,9 +329,10 @@ public:
   // function will return true and set rdyCycle to the cycle in which this
   // instruction will become ready. Otherwise it will return false and set
   // rdyCycle to -1, indicating that it isn't yet known when it will be ready.
+  // ltncy is the latency of the edge from that predecessor.
   __host__ __device__
   bool PrdcsrSchduld(InstCount prdcsrNum, InstCount cycle, InstCount &rdyCycle,
-                     InstCount *ltncyPerPrdcsr = NULL);
+                     UDT_GLABEL ltncy);
   // Undoes the effect of PrdcsrSchduld().
   __host__ __device__
   bool PrdcsrUnSchduld(InstCount prdcsrNum, InstCount &rdyCycle);
@@ -547,36 +548,17 @@ public:
   __device__
   void Reset();
 
-  // Copies pointers to device and links them to device inst. Also uses
-  // the device nodes_ array to set nodes_ in GraphNode
-  void CopyPointersToDevice(SchedInstruction *dev_inst,
-                            SchedInstruction *dev_instsArray,
-                            RegisterFile *dev_regFiles);
-  // Calls hipFree on all arrays/objects that were allocated with hipMalloc
-  void FreeDevicePointers(int numThreads);
-  // Allocates arrays used for storing individual values for each thread in
-  // parallel ACO on device
-  void AllocDevArraysForParallelACO(int numThreads);
+  // Prepares the instruction to be copied to the device. Sets the arrays
+  // that hold its values for each thread in parallel ACO and stores the
+  // attributes that the device cannot compute without the edges.
+  void SetupForDevice(int16_t *dev_lastUseCnt, InstCount *dev_minRdyCycle,
+                      InstCount *dev_unschduldPrdcsrCnt);
 
   friend class SchedRange;
 
-  // This instruction's index in the scsrs_, latencies_, predOrder_ arrays
-  // in the DDG.
-  int ddgIndex;
-
-  // This instruction's index in the ltncyPerPrdcsr_ array in the DDG.
-  int ddgPredecessorIndex;
-
-  // This instruction's indices for the uses_ and defs_ arrays in the DDG.
-  int ddgUseIndex;
-  int ddgDefIndex;
-
   __device__
   int GetScsrCnt_();
 
-  __host__
-  void SetupForDevice();
-
 
 protected:
   // The "name" of this instruction. Usually a string indicating its type.
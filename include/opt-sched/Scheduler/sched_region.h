@@ -18,6 +18,8 @@ Last Update:  Jan. 2020
 #include "opt-sched/Scheduler/data_dep.h"
 // For Enumerator, LengthCostEnumerator, EnumTreeNode and Pruning.
 #include "opt-sched/Scheduler/enumerator.h"
+#include <algorithm>
+#include <atomic>
 #include <hip/hip_runtime.h>
 
 namespace llvm {
@@ -70,8 +72,14 @@ public:
   inline InstCount GetExecCostLwrBound() { return ExecCostLwrBound_; }
   __host__ __device__
   inline InstCount GetRPCostLwrBound() { return RpCostLwrBound_; }
-  // Returns the best cost found so far for this region.
-  inline InstCount GetBestCost() { return bestCost_; }
+  // Returns the best cost found so far for this region, or by any region
+  // it shares its best cost with.
+  inline InstCount GetBestCost() {
+    if (sharedBestCost_ == nullptr)
+      return bestCost_;
+    return std::min(bestCost_,
+                    sharedBestCost_->load(std::memory_order_relaxed));
+  }
   // Returns the heuristic cost for this region.
   __host__ __device__
   inline InstCount GetHeuristicCost() { return hurstcCost_; }
@@ -79,6 +87,12 @@ public:
   inline SchedPriorities GetHeuristicPriorities() { return hurstcPrirts_; }
   // Get the number of simulated spills code added for this block.
   inline int GetSimSpills() { return totalSimSpills_; }
+  // Returns the number of this region within the function.
+  inline long GetRgnNum() { return rgnNum_; }
+  // Limits the total time spent in ACO for this region. 0 means no limit.
+  inline void SetAcoTimeout(Milliseconds timeout) { acoTimeout_ = timeout; }
+  // Returns the total time spent in ACO for this region so far.
+  inline Milliseconds GetAcoTime() { return acoTime_; }
 
   // TODO(max): Document.
   virtual FUNC_RESULT
@@ -139,6 +153,10 @@ private:
   LB_ALG lbAlg_;
   // The number of this region.
   long rgnNum_;
+
+  // ACO time limit of the region, or 0, and the ACO time used so far.
+  Milliseconds acoTimeout_ = 0;
+  Milliseconds acoTime_ = 0;
   // Is this region the last region of the function
   bool isLastRgn_;
   // Whether to verify the schedule after calculating it.
@@ -168,6 +186,10 @@ private:
   InstCount bestCost_;
   InstCount bestSchedLngth_;
 
+  // If set, the best cost of all the regions that search the same region
+  // in parallel.
+  std::atomic<InstCount> *sharedBestCost_ = nullptr;
+
   // (Chris): The cost function. Defaults to PERP.
   SPILL_COST_FUNCTION spillCostFunc_ = SCF_PERP;
 
@@ -231,7 +253,31 @@ protected:
   // protected accessors:
   SchedulerType GetHeuristicSchedulerType() const { return HeurSchedType_; }
 
-  void SetBestCost(InstCount bestCost) { bestCost_ = bestCost; }
+  LB_ALG GetLwrBoundAlg() const { return lbAlg_; }
+
+  void SetBestCost(InstCount bestCost) {
+    bestCost_ = bestCost;
+
+    if (sharedBestCost_ != nullptr) {
+      InstCount sharedCost = sharedBestCost_->load(std::memory_order_relaxed);
+      while (bestCost < sharedCost &&
+             !sharedBestCost_->compare_exchange_weak(sharedCost, bestCost))
+        ;
+    }
+  }
+
+  // Shares the best cost with the other regions that use sharedBestCost, or
+  // stops sharing it if sharedBestCost is NULL.
+  void ShareBestCost(std::atomic<InstCount> *sharedBestCost) {
+    sharedBestCost_ = sharedBestCost;
+  }
+
+  // Makes this region, whose graph is a copy of the graph of mainRgn, ready
+  // to enumerate schedules of mainRgn in parallel with it. Repeats the setup
+  // that FindOptimalSchedule() did for mainRgn up to the enumeration, then
+  // takes over the bounds and the best cost of mainRgn.
+  FUNC_RESULT SetupForEnumWorker_(SchedRegion *mainRgn,
+                                  Milliseconds lngthTimeout);
 
   void SetBestSchedLength(InstCount bestSchedLngth) {
     bestSchedLngth_ = bestSchedLngth;
@@ -298,6 +344,13 @@ protected:
   FUNC_RESULT runACO(InstSchedule *ReturnSched, InstSchedule *InitSched,
                      bool IsPostBB, unsigned long randSeed, int numBlocks,
                      bool devACOEnabled);
+  // Runs host ACO as islandCnt colonies on their own threads, which
+  // exchange their best schedules every ACO_MIGRATION_INTERVAL iterations,
+  // and returns the best schedule of all colonies.
+  FUNC_RESULT runACOIslands_(InstSchedule *ReturnSched,
+                             InstSchedule *InitSched, bool IsPostBB,
+                             int numBlocks, Milliseconds Timeout,
+                             int islandCnt);
 };
 
 } // namespace opt_sched
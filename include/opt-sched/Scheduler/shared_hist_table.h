@@ -0,0 +1,120 @@
+/*******************************************************************************
+Description:  Defines a history table that the enumerator threads of a region
+              share. Unlike the table of one enumerator it does not link its
+              entries to the tree nodes of that enumerator. Each entry holds
+              the scheduled instructions of a searched sub-problem as a bit
+              set, together with the last instructions and the costs needed
+              to check it for domination on another thread's copy of the
+              graph. The entries are kept in sets of a few ways in flat
+              arrays. Each set is locked by one of a fixed number of mutexes,
+              and once a set is full its least recently used entry is
+              replaced, so the memory used is bounded.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_SHARED_HIST_TABLE_H
+#define OPTSCHED_SHARED_HIST_TABLE_H
+
+#include "opt-sched/Scheduler/defines.h"
+#include "opt-sched/Scheduler/gen_sched.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+class DataDepGraph;
+class EnumTreeNode;
+class Enumerator;
+
+class SharedHistTable {
+public:
+  // Creates a table of at most entryCnt entries for sub-problems of the
+  // given graph.
+  SharedHistTable(DataDepGraph *dataDepGraph, int issuRate, size_t entryCnt);
+
+  SharedHistTable(const SharedHistTable &) = delete;
+  SharedHistTable &operator=(const SharedHistTable &) = delete;
+
+  // Removes all entries. Must not be called while other threads use the
+  // table.
+  void Clear();
+  // Clears the table unless the last search was at the same target length,
+  // whose entries still apply. Must not be called while other threads use
+  // the table.
+  void StartLength(InstCount trgtLngth);
+  // Adds the sub-problem below a node whose sub-tree has been searched
+  // completely.
+  void Insert(EnumTreeNode *node, Enumerator *enumrtr);
+  // Was a sub-problem that dominates the one below the given node searched
+  // by any thread?
+  bool IsDominated(EnumTreeNode *node, Enumerator *enumrtr);
+
+  size_t GetCapacity() const { return setCnt_ * WAY_CNT; }
+  uint64_t GetEntryCnt() const { return entryCnt_; }
+  uint64_t GetHitCnt() const { return hitCnt_; }
+  uint64_t GetEvictionCnt() const { return evictionCnt_; }
+
+private:
+  struct Entry {
+    InstSignature sig;
+    // The value of clock_ when the entry was added or last dominated a node.
+    // Zero if the entry is not in use.
+    uint64_t lastUse;
+    InstCount time;
+    bool crntCycleBlkd;
+    bool isLngthFsbl;
+    InstCount cost;
+    InstCount partialCost;
+    InstCount totalCost;
+    InstCount spillCostSum;
+    // The best cost when the entry was added. The costs of the entry only
+    // apply under this bound or a lower one.
+    InstCount costBound;
+  };
+
+  // The number of entries in each set.
+  static const size_t WAY_CNT = 4;
+  static const size_t MAX_LOCK_CNT = 64;
+
+  InstCount instCnt_;
+  int issuRate_;
+  // The target length of the entries, or INVALID_VALUE after Clear().
+  InstCount trgtLngth_;
+  UDT_GLABEL maxLtncy_;
+  // The number of 64-bit words in the bit set of an entry.
+  size_t wordCnt_;
+  // The number of last instructions kept for an entry, enough to cover the
+  // latency of any instruction plus one slot of the previous cycle.
+  size_t lastInstCnt_;
+  size_t setCnt_;
+
+  std::vector<Entry> entries_;
+  // The scheduled instructions of each entry, wordCnt_ words per entry.
+  std::vector<uint64_t> schduldInsts_;
+  // The instruction (or SCHD_STALL) in each of the last lastInstCnt_ slots
+  // of each entry, starting at the entry's time and going back.
+  std::vector<InstCount> lastInsts_;
+  // lock_[i] guards all sets s with s % lockCnt == i.
+  std::vector<std::mutex> locks_;
+
+  std::atomic<uint64_t> clock_;
+  std::atomic<uint64_t> entryCnt_;
+  std::atomic<uint64_t> hitCnt_;
+  std::atomic<uint64_t> evictionCnt_;
+
+  size_t GetSet_(InstSignature sig) const;
+  // Fills the bit set of the instructions scheduled at the given node.
+  void SetInstsSchduld_(EnumTreeNode *node, uint64_t *words) const;
+  // Does the entry dominate the given node, given that both scheduled the
+  // same instructions?
+  bool DoesDominate_(size_t entry, EnumTreeNode *node, Enumerator *enumrtr);
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
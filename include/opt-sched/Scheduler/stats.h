@@ -2,7 +2,8 @@
 Description:  Provides a flexible set of classes to keep track of statistical
               records. All records are intended to be write-only to ensure that
               no hidden dependences are introduced due to stat records being
-              global. The actual records are also defined here.
+              global. Records may be updated from several threads at once.
+              The actual records are also defined here.
 Author:       Max Shawabkeh
 Created:      Mar. 2011
 Last Update:  Mar. 2011
@@ -12,9 +13,11 @@ Last Update:  Mar. 2011
 #define OPTSCHED_GENERIC_STATS_H
 
 #include "opt-sched/Scheduler/defines.h"
+#include <atomic>
 #include <iostream>
 #include <list>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
 
@@ -39,6 +42,8 @@ public:
 protected:
   // The human-friendly name of the stat.
   const string name_;
+  // Guards the values of records that cannot be updated atomically.
+  mutable std::mutex mutex_;
 };
 
 // A simple single-value numerical record. Holds only one value at a time.
@@ -50,49 +55,38 @@ public:
   void Set(T value) { value_ = value; }
   // Sets the stat value to the maximum of the current and the argument.
   void SetMax(T value) {
-    if (value > value_)
-      value_ = value;
+    T crnt = value_.load(std::memory_order_relaxed);
+    while (value > crnt && !value_.compare_exchange_weak(crnt, value))
+      ;
   }
   // Sets the stat value to the minimum of the current and the argument.
   void SetMin(T value) {
-    if (value < value_)
-      value_ = value;
+    T crnt = value_.load(std::memory_order_relaxed);
+    while (value < crnt && !value_.compare_exchange_weak(crnt, value))
+      ;
   }
   // Increments the value in the record.
-  NumericStat &operator++() {
-    value_++;
-    return *this;
-  }
-  NumericStat &operator++(int) {
-    value_++;
-    return *this;
-  }
+  NumericStat &operator++() { return *this += 1; }
+  NumericStat &operator++(int) { return *this += 1; }
   // Decrements the value in the record.
-  NumericStat &operator--() {
-    value_--;
-    return *this;
-  }
-  NumericStat &operator--(int) {
-    value_--;
-    return *this;
-  }
+  NumericStat &operator--() { return *this -= 1; }
+  NumericStat &operator--(int) { return *this -= 1; }
   // Adds the specified amount to the value in the record.
   NumericStat &operator+=(T change) {
-    value_ += change;
+    T crnt = value_.load(std::memory_order_relaxed);
+    while (!value_.compare_exchange_weak(crnt, crnt + change))
+      ;
     return *this;
   }
   // Subtracts the specified amount from the value in the record.
-  NumericStat &operator-=(T change) {
-    value_ -= change;
-    return *this;
-  }
+  NumericStat &operator-=(T change) { return *this += -change; }
 
 protected:
   // The value tracked by this record.
-  T value_;
+  std::atomic<T> value_;
   // Prints the stat to a stream.
   void Print(std::ostream &out) const {
-    out << name_ << ": " << value_ << "\n";
+    out << name_ << ": " << value_.load() << "\n";
   }
 };
 
@@ -130,7 +124,10 @@ public:
   // Constructs a string stat record.
   StringStat(const string name) : Stat(name) {}
   // Sets the stat value.
-  void Set(string &value) { value_ = value; }
+  void Set(string &value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    value_ = value;
+  }
 
 protected:
   // The string tracked by this record.
@@ -147,9 +144,15 @@ public:
   // Constructs a set stat record.
   SetStat(const string name) : Stat(name) {}
   // Clears the values set.
-  void Clear() { values_.clear(); }
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.clear();
+  }
   // Add a new value to the set.
-  void Add(const T &value) { values_.insert(value); }
+  void Add(const T &value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.insert(value);
+  }
 
 protected:
   // The values tracked by this record.
@@ -166,11 +169,18 @@ public:
   // Constructs an indexed stat record.
   IndexedSetStat(const string name) : Stat(name) {}
   // Clears all the sets.
-  void Clear() { values_.clear(); }
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.clear();
+  }
   // Clears a specified set.
-  void Clear(const string &index) { values_[index].clear(); }
+  void Clear(const string &index) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_[index].clear();
+  }
   // Add a new value to the set.
   void Add(const string &index, const T &value) {
+    std::lock_guard<std::mutex> lock(mutex_);
     values_[index].insert(value);
   }
 
@@ -224,25 +234,33 @@ public:
   // Constructs an indexed stat record.
   IndexedNumericStat(const string name) : Stat(name) {}
   // Sets a stat value.
-  void Set(const string &index, T value) { values_[index] = value; }
+  void Set(const string &index, T value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_[index] = value;
+  }
   // Sets a stat value to the maximum of the current and the supplied.
   void SetMax(const string &index, T value) {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (value > values_[index])
       values_[index] = value;
   }
   // Sets a stat value to the minimum of the current and the supplied.
   void SetMin(const string &index, T value) {
+    std::lock_guard<std::mutex> lock(mutex_);
     if (value < values_[index])
       values_[index] = value;
   }
   // Increments a value in the record.
-  void Increment(const string &index) { values_[index]++; }
+  void Increment(const string &index) { Add(index, 1); }
   // Decrements a value in the record.
-  void Decrement(const string &index) { values_[index]--; }
+  void Decrement(const string &index) { Add(index, -1); }
   // Adds the specified amount to a value in the record.
-  void Add(const string &index, T delta) { values_[index] += delta; }
+  void Add(const string &index, T delta) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_[index] += delta;
+  }
   // Subtracts the specified amount from a value in the record.
-  void Subtract(const string &index, T delta) { values_[index] -= delta; }
+  void Subtract(const string &index, T delta) { Add(index, -delta); }
 
 protected:
   // The values tracked by this record.
@@ -287,6 +305,7 @@ extern IntDistributionStat traceOptimalScheduleLength;
 extern IntDistributionStat regionBuildTime;
 extern IntDistributionStat heuristicTime;
 extern IntDistributionStat AcoTime;
+extern IntDistributionStat acoScheduleAllocations;
 extern IntDistributionStat boundComputationTime;
 extern IntDistributionStat enumerationTime;
 extern IntDistributionStat enumerationToHeuristicTimeRatio;
@@ -299,12 +318,41 @@ extern IntDistributionStat traversedHistoryListSize;
 extern IntDistributionStat historyDominationPosition;
 extern IntDistributionStat historyDominationPositionToListSize;
 extern IntDistributionStat historyTableInitializationTime;
+// The number of entries in the history table at the end of each search.
+extern IntDistributionStat historyTableEntries;
+// The peak number of bytes used by the history table in each search.
+extern IntDistributionStat historyTableMemory;
 
 extern IntDistributionStat scheduledLatency;
 
 // The number of regions whose scheduling timed out.
 extern TimeoutStat timeouts;
 
+// The number of ACO runs that started from a cached pheromone table.
+extern IntStat acoPheromoneCacheHits;
+// The number of ACO runs stopped by their time limit.
+extern IntStat acoTimeouts;
+// The number of host ants not run because their ACO run timed out.
+extern IntStat acoTimedOutAnts;
+// The number of times an ACO colony took a better schedule from another one.
+extern IntStat acoImmigrants;
+// The number of ACO schedules improved by the local search after the colony.
+extern IntStat acoLocalSearchImprovements;
+// The number of host ants that rebuilt a schedule already seen in the region.
+extern IntStat acoDuplicateAnts;
+// The number of enumerator nodes dominated by a sub-problem that another
+// thread examined, found in the shared history table.
+extern IntStat sharedHistoryDominationHits;
+// The number of shared history entries replaced by newer ones.
+extern IntStat sharedHistoryEvictions;
+// The number of history table lookups that found a dominating node.
+extern IntStat historyTableHits;
+// The number of history table lookups that did not find a dominating node.
+extern IntStat historyTableMisses;
+// The number of nodes removed from the history table to stay within
+// HIST_TABLE_MAX_MEMORY_MB.
+extern IntStat historyTableEvictions;
+
 // The number of perfectly matched blocks (when comparing to input).
 extern IntStat perfectMatchCount;
 // The number of positively mismatched blocks (when comparing to input).
@@ -23,8 +23,9 @@ uint16_t clcltBitsNeededToHoldNum(uint64_t value);
 // milliseconds.
 Milliseconds GetProcessorTime();
 // Returns a reference to an object that is supposed to initialized with the
-// start time of the process
-extern std::chrono::high_resolution_clock::time_point startTime;
+// start time of the process. Each thread has its own, so threads scheduling
+// different regions can each time their region.
+extern thread_local std::chrono::high_resolution_clock::time_point startTime;
 } // namespace Utilities
 
 __host__ __device__
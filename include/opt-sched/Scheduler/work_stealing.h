@@ -0,0 +1,74 @@
+/*******************************************************************************
+Description:  Defines a set of work-stealing queues, one per worker. A worker
+              takes items from the back of its own queue and, once that is
+              empty, steals from the front of the other workers' queues, so
+              the work stays balanced without a single shared queue.
+Created:      Oct. 2026
+*******************************************************************************/
+
+#ifndef OPTSCHED_WORK_STEALING_H
+#define OPTSCHED_WORK_STEALING_H
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace llvm {
+namespace opt_sched {
+
+template <typename T> class WorkStealingQueues {
+public:
+  explicit WorkStealingQueues(size_t queueCnt) : queues_(queueCnt) {}
+
+  WorkStealingQueues(const WorkStealingQueues &) = delete;
+  WorkStealingQueues &operator=(const WorkStealingQueues &) = delete;
+
+  size_t GetQueueCnt() const { return queues_.size(); }
+
+  // Adds an item to the back of the given queue.
+  void Push(size_t queue, T item) {
+    std::lock_guard<std::mutex> lock(queues_[queue].mutex);
+    queues_[queue].items.push_back(std::move(item));
+  }
+
+  // Takes an item from the back of the given queue, or if it is empty from
+  // the front of the next non-empty queue after it. Returns false if all
+  // queues are empty.
+  bool Pop(size_t queue, T &item) {
+    size_t queueCnt = queues_.size();
+
+    for (size_t i = 0; i < queueCnt; i++) {
+      Queue &q = queues_[(queue + i) % queueCnt];
+      std::lock_guard<std::mutex> lock(q.mutex);
+
+      if (q.items.empty())
+        continue;
+
+      if (i == 0) {
+        item = std::move(q.items.back());
+        q.items.pop_back();
+      } else {
+        item = std::move(q.items.front());
+        q.items.pop_front();
+      }
+      return true;
+    }
+
+    return false;
+  }
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<T> items;
+  };
+
+  std::vector<Queue> queues_;
+};
+
+} // namespace opt_sched
+} // namespace llvm
+
+#endif
@@ -1,15 +1,23 @@
 #include "hip/hip_runtime.h"
 #include "opt-sched/Scheduler/aco.h"
+#include "opt-sched/Scheduler/aco_context.h"
+#include "opt-sched/Scheduler/aco_islands.h"
+#include "opt-sched/Scheduler/ant_state.h"
 #include "opt-sched/Scheduler/config.h"
 #include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/pheromone_cache.h"
 #include "opt-sched/Scheduler/random.h"
 #include "opt-sched/Scheduler/register.h"
 #include "opt-sched/Scheduler/sched_region.h"
+#include "opt-sched/Scheduler/stats.h"
+#include "opt-sched/Scheduler/utilities.h"
 #include "opt-sched/Scheduler/bb_spill.h"
 #include "opt-sched/Scheduler/dev_defines.h"
 // #include <thrust/functional.h>
 #include <hip/hip_cooperative_groups.h>
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/ThreadPool.h"
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 #include <unordered_map>
@@ -25,18 +33,15 @@ static void PrintInstruction(SchedInstruction *inst);
 __host__ __device__
 void PrintSchedule(InstSchedule *schedule);
 
-double RandDouble(double min, double max) {
-  double rand = (double)RandomGen::GetRand32() / INT32_MAX;
-  return (rand * (max - min)) + min;
-}
-
 #define USE_ACS 0
 #define TWO_STEP 1
 #define MIN_DEPOSITION 1
 #define MAX_DEPOSITION 6
 #define MAX_DEPOSITION_MINUS_MIN (MAX_DEPOSITION - MIN_DEPOSITION)
 #define ACO_SCHED_STALLS 1
-//#define CHECK_DIFFERENT_SCHEDULES 1
+// Stored host pheromone is renormalized once the evaporation scale drops
+// below this, which keeps the stored values finite for float pheromone too.
+#define MIN_PHEROMONE_SCALE 1e-30
 //#define BIASED_CHOICES 10000000
 //#define LOCAL_DECAY 0.1
 
@@ -67,16 +72,48 @@ ACOScheduler::ACOScheduler(DataDepGraph *dataDepGraph,
   dev_states_ = dev_states;
   dev_pheromone_elmnts_alloced_ = false;
   numAntsTerminated_ = 0;
+  numAntsTimedOut_ = 0;
   numBlocks_ = numBlocks;
   numThreads_ = numBlocks_ * NUMTHREADSPERBLOCK;
 
   use_dev_ACO = schedIni.GetBool("DEV_ACO");
-  if(!use_dev_ACO || count_ < REGION_MIN_SIZE)
+  // Without a GPU, run one host ant per device thread and reduce their
+  // schedules in the order of the kernel
+  devAcoOnHost_ = use_dev_ACO && schedIni.GetBool("DEV_ACO_ON_HOST", false) &&
+                  count_ >= REGION_MIN_SIZE;
+  if (use_dev_ACO && schedIni.GetBool("DEV_ACO_ON_HOST", false))
+    use_dev_ACO = false;
+  if (devAcoOnHost_)
+    Logger::Info("Emulating Dev_ACO with %d blocks of %d threads on the host",
+                 numBlocks_, NUMTHREADSPERBLOCK);
+  else if(!use_dev_ACO || count_ < REGION_MIN_SIZE)
     numThreads_ = schedIni.GetInt("HOST_ANTS");
   else {
     dev_rgn_->SetNumThreads(numThreads_);
     dev_DDG_->SetNumThreads(numThreads_);
   }
+  hostThreadCnt_ = std::max<int>(1, schedIni.GetInt("HOST_ACO_THREADS", 1));
+  hostThreadPool_ = nullptr;
+  islands_ = nullptr;
+  islandIndx_ = 0;
+  localSearchPasses_ =
+      std::max<int>(0, schedIni.GetInt("ACO_LOCAL_SEARCH_PASSES", 0));
+  timeout_ = 0;
+  deadline_ = 0;
+  timedOut_ = false;
+  pherStaleness_ = std::min<int>(
+      std::max<int>(0, schedIni.GetInt("HOST_ACO_PHEROMONE_STALENESS", 0)), 1);
+#if USE_ACS
+  // ACS updates the pheromone after every iteration from the global best
+  pherStaleness_ = 0;
+#endif
+  pherCacheEn_ = schedIni.GetBool("ACO_PHEROMONE_CACHE", false);
+  if (pherCacheEn_)
+    PheromoneCache::getInstance().SetCapacity(std::max<int>(
+        0, schedIni.GetInt("ACO_PHEROMONE_CACHE_SIZE", 64)));
+  sparsePherMinSize_ = schedIni.GetInt("ACO_SPARSE_PHEROMONE_MIN_SIZE", 0);
+  useSparsePher_ = (!use_dev_ACO || count_ < REGION_MIN_SIZE) &&
+                   sparsePherMinSize_ > 0 && count_ >= sparsePherMinSize_;
 
   use_fixed_bias = schedIni.GetBool("ACO_USE_FIXED_BIAS");
   use_tournament = schedIni.GetBool("ACO_TOURNAMENT");
@@ -95,8 +132,11 @@ ACOScheduler::ACOScheduler(DataDepGraph *dataDepGraph,
   std::cerr << "ants_per_iteration===="<<ants_per_iteration<<"\n\n";
   */
 
-  int pheromone_size = (count_ + 1) * count_;
-  pheromone_.resize(pheromone_size);
+  // The sparse table needs the transitive closure and is built in
+  // FindSchedule().
+  if (!useSparsePher_)
+    pheromone_.resize((count_ + 1) * count_);
+  pherScale_ = 1;
 
   //construct the ACOReadyList member and a key helper
   readyLs = new ACOReadyList(dataDepGraph->GetMaxIndependentInstructions());
@@ -111,9 +151,11 @@ ACOScheduler::ACOScheduler(DataDepGraph *dataDepGraph,
   }
 
   InitialSchedule = nullptr;
+  schedAllocCnt_ = 0;
 }
 
 ACOScheduler::~ACOScheduler() {
+  ACOContext::getInstance().ReleaseSchedules(freeScheds_);
   if (readyLs)
     delete readyLs;
   if (kHelper1)
@@ -131,25 +173,47 @@ hiprandState_t *getDevRandStates(ACOScheduler *ACOSchedulr) {
 // -1 means no instruction, so e.g. pheromone(-1, 10) gives pheromone on path
 // from empty schedule to schedule only containing instruction 10
 __host__ __device__
-pheromone_t &ACOScheduler::Pheromone(SchedInstruction *from,
-                                     SchedInstruction *to) {
+pheromone_t ACOScheduler::Pheromone(InstCount from, InstCount to) {
+#ifndef __HIP_DEVICE_COMPILE__
+  if (useSparsePher_)
+    return sparsePher_.Get(from, to);
+#endif
+  int row = 0;
+  if (from != -1)
+    row = from + 1;
+  return pheromone_[(row * count_) + to];
+}
+
+__host__ __device__
+pheromone_t *ACOScheduler::PheromonePtr(SchedInstruction *from,
+                                        SchedInstruction *to) {
   assert(to != NULL);
   int fromNum = -1;
   if (from != NULL)
     fromNum = from->GetNum();
-  return Pheromone(fromNum, to->GetNum());
+  return PheromonePtr(fromNum, to->GetNum());
 }
 
 __host__ __device__
-pheromone_t &ACOScheduler::Pheromone(InstCount from, InstCount to) {
+pheromone_t *ACOScheduler::PheromonePtr(InstCount from, InstCount to) {
+#ifndef __HIP_DEVICE_COMPILE__
+  if (useSparsePher_) {
+    pheromone_t *pheromone = sparsePher_.Find(from, to);
+    if (pheromone == NULL)
+      Logger::Fatal("No pheromone for instructions %d and %d, which can never "
+                    "be adjacent in a schedule.",
+                    from, to);
+    return pheromone;
+  }
+#endif
   int row = 0;
   if (from != -1)
     row = from + 1;
-  return pheromone_[(row * count_) + to];
+  return &pheromone_[(row * count_) + to];
 }
 
 __host__ __device__
-pheromone_t ACOScheduler::Score(InstCount FromId, InstCount ToId, HeurType ToHeuristic, bool IsFirstPass) {
+pheromone_t ACOScheduler::Score(InstCount FromId, InstCount ToId, HeurType ToHeuristic, bool IsFirstPass, int WhichPrirts) {
   // tuneable heuristic importance is temporarily disabled
   // double Hf = pow(ToHeuristic, heuristicImportance_);
   pheromone_t HeurScore;
@@ -159,10 +223,48 @@ pheromone_t ACOScheduler::Score(InstCount FromId, InstCount ToId, HeurType ToHeu
     else
       HeurScore = ToHeuristic * MaxPriorityInv2 + 1;
   #else
-    HeurScore = ToHeuristic * MaxPriorityInv + 1;
+    if (WhichPrirts == 1 || IsFirstPass)
+      HeurScore = ToHeuristic * MaxPriorityInv + 1;
+    else
+      HeurScore = ToHeuristic * MaxPriorityInv2 + 1;
   #endif
   pheromone_t Hf = heuristicImportance_ ? HeurScore : 1.0;
+#ifdef __HIP_DEVICE_COMPILE__
   return Pheromone(FromId, ToId) * Hf;
+#else
+  return Pheromone(FromId, ToId) * pherScale_ * Hf;
+#endif
+}
+
+void ACOScheduler::NormalizePheromone_() {
+  if (pherScale_ == 1)
+    return;
+  if (useSparsePher_) {
+    for (size_t i = 0; i < sparsePher_.GetEntryCnt(); i++)
+      sparsePher_.GetEntry(i) *= pherScale_;
+  } else {
+    int pheromone_size = (count_ + 1) * count_;
+    for (int i = 0; i < pheromone_size; i++)
+      pheromone_[i] *= pherScale_;
+  }
+  for (pheromone_t &RowMax : pherRowMax_)
+    RowMax *= pherScale_;
+  pherScale_ = 1;
+}
+
+void ACOScheduler::CmputPherRowMax_() {
+  pherRowMax_.assign(count_ + 1, 0);
+  for (InstCount From = -1; From < count_; From++) {
+    pheromone_t &RowMax = pherRowMax_[From + 1];
+    if (useSparsePher_) {
+      size_t End = sparsePher_.GetRowEnd(From);
+      for (size_t I = sparsePher_.GetRowBgn(From); I < End; I++)
+        RowMax = std::max(RowMax, sparsePher_.GetEntry(I));
+    } else {
+      for (InstCount To = 0; To < count_; To++)
+        RowMax = std::max(RowMax, pheromone_[(From + 1) * count_ + To]);
+    }
+  }
 }
 
 __host__ __device__
@@ -247,11 +349,10 @@ bool ACOScheduler::shouldReplaceSchedule(InstSchedule *OldSched,
   }
 }
 
-__host__ __device__
+__device__
 InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst, InstCount totalStalls,
                                           SchedRegion *rgn, bool &unnecessarilyStalling,
                                           bool closeToRPTarget, bool currentlyWaiting) {
-#ifdef __HIP_DEVICE_COMPILE__
   #ifdef DEBUG_ACO_CRASH_LOCATIONS
     if (hipThreadIdx_x == 0) {
       printf("Crash Beginning of SelectInstruction()\n");
@@ -327,14 +428,10 @@ InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst, InstCount
 
         // check if any reg types used by the instructions are above the physical register limit
         SchedInstruction *tempInst = dataDepGraph_->GetInstByIndx(*dev_readyLs->getInstIdAtIndex(I));
-        // TODO(bruce): convert to dev uses
-        RegIndxTuple *uses;
-        Register *use;
+        const DDGBlobView &ddgBlob = dataDepGraph_->GetDevDDGBlob();
         uint16_t usesCount = tempInst->GetUseCnt();
-        int useStart = tempInst->ddgUseIndex;
         for (uint16_t i = 0; i < usesCount; i++) {
-          use = dataDepGraph_->getRegByTuple(dataDepGraph_->getUseByIndex(useStart + i));
-          int16_t regType = use->GetType();
+          int16_t regType = ddgBlob.GetUse(tempInst->GetNum(), i).regType_;
           if ( ((BBWithSpill *)rgn)->IsRPHigh(regType) ) {
             RPIsHigh = true;
             break;
@@ -369,103 +466,6 @@ InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst, InstCount
       MaxScore = IScore;
     }
   }
-#else
-  // if we are waiting and have no fully-ready instruction that is 
-  // net 0 or benefit to RP, then return -1 to schedule a stall
-  if (currentlyWaiting && RP0OrPositiveCount == 0)
-    return -1;
-
-  // calculate MaxScoringInst, and ScoreSum
-  pheromone_t MaxScore = -1;
-  InstCount MaxScoreIndx = 0;
-  readyLs->ScoreSum = 0;
-  int lastInstId = lastInst->GetNum();
-  // this bool is to check if stalling could be avoided
-  bool couldAvoidStalling = false;
-  // this bool is to check if we should currently avoid unnecessary stalls
-  // because RP is low or we have too many stalls in the schedule
-  bool RPIsHigh = false;
-  bool tooManyStalls = totalStalls >= globalBestStalls_ * 5 / 10;
-  readyLs->ScoreSum = 0;
-
-  for (InstCount I = 0; I < readyLs->getReadyListSize(); ++I) {
-    RPIsHigh = false;
-    InstCount CandidateId = *readyLs->getInstIdAtIndex(I);
-    SchedInstruction *candidateInst = dataDepGraph_->GetInstByIndx(CandidateId);
-    HeurType candidateLUC = candidateInst->GetLastUseCnt();
-    int16_t candidateDefs = candidateInst->GetDefCnt();
-
-    // compute the score
-    HeurType Heur = *readyLs->getInstHeuristicAtIndex(I);
-    pheromone_t IScore = Score(lastInstId, *readyLs->getInstIdAtIndex(I), Heur, !rgn->IsSecondPass());
-    if (RP0OrPositiveCount != 0 && candidateDefs > candidateLUC)
-      IScore = IScore * 9/10;
-
-    *readyLs->getInstScoreAtIndex(I) = IScore;
-    readyLs->ScoreSum += IScore;
-
-    if (currentlyWaiting) {
-      // if currently waiting on an instruction, do not consider semi-ready instructions 
-      if (*readyLs->getInstReadyOnAtIndex(I) > crntCycleNum_)
-        continue;
-
-      // as well as instructions with a net negative impact on RP
-      if (candidateDefs > candidateLUC)
-        continue;
-    }
-    
-    // add a score penalty for instructions that are not ready yet
-    // unnecessary stalls should not be considered if current RP is low, or if we already have too many stalls
-    if (*readyLs->getInstReadyOnAtIndex(I) > crntCycleNum_) {
-      if (RP0OrPositiveCount != 0) {
-        IScore = 0.0000001;
-      }
-      else {
-        int cyclesNeededToWait = *readyLs->getInstReadyOnAtIndex(I) - crntCycleNum_;
-        if (cyclesNeededToWait < globalBestStalls_)
-          IScore = IScore * (globalBestStalls_ - cyclesNeededToWait * 2) / globalBestStalls_;
-        else 
-          IScore = IScore / globalBestStalls_;
-
-        // check if any reg types used by the instructions are above the physical limit
-        SchedInstruction *tempInst = dataDepGraph_->GetInstByIndx(*readyLs->getInstIdAtIndex(I));
-        RegIndxTuple *uses;
-        Register *use;
-        uint16_t usesCount = tempInst->GetUses(uses);
-        for (uint16_t i = 0; i < usesCount; i++) {
-          use = dataDepGraph_->getRegByTuple(&uses[i]);
-          int16_t regType = use->GetType();
-          if ( ((BBWithSpill *)rgn)->IsRPHigh(regType) ) {
-            RPIsHigh = true;
-            break;
-          }
-        }
-
-        // reduce likelihood of selecting an instruction we have to wait for IF
-        // RP is low or we have too many stalls already
-        if (!(closeToRPTarget && RPIsHigh) || tooManyStalls) {
-          if (globalBestStalls_ > totalStalls)
-            IScore = IScore * (globalBestStalls_ - totalStalls * 2) / globalBestStalls_;
-          else
-            IScore = IScore / globalBestStalls_;
-        }
-      }
-    }
-    else {
-      couldAvoidStalling = true;
-    }
-
-    if (IScore < 0.0000001)
-      IScore = 0.0000001;
-    *readyLs->getInstScoreAtIndex(I) = IScore;
-    readyLs->ScoreSum += IScore;
-    
-    if(IScore > MaxScore) {
-      MaxScoreIndx = I;
-      MaxScore = IScore;
-    }
-  }
-#endif
 
   //generate the random numbers that we will need for deciding if
   //we are going to use the fixed bias or if we are going to use
@@ -473,14 +473,9 @@ InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst, InstCount
   //the fitness proportional selection point
   double rand;
   pheromone_t point;
-#ifdef __HIP_DEVICE_COMPILE__
   auto dev_states = getDevRandStates(this);
   rand = hiprand_uniform(&dev_states[GLOBALTID]);
   point = dev_readyLs->dev_ScoreSum[GLOBALTID] * hiprand_uniform(&dev_states[GLOBALTID]);
-#else
-  rand = RandDouble(0, 1);
-  point = RandDouble(0, readyLs->ScoreSum);
-#endif
 
   //here we compute the chance that we will use fp selection or auto pick the best
   double choose_best_chance;
@@ -497,7 +492,6 @@ InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst, InstCount
 
   // select the instruction index for fp choice
   size_t fpIndx=0;
-  #ifdef __HIP_DEVICE_COMPILE__
   __shared__ bool dev_useMax;
   // only explore and exploit at block level for first pass
   if (!dev_rgn_->IsSecondPass()) {
@@ -528,29 +522,14 @@ InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst, InstCount
       }
     }
   }
-  #else
-    for (size_t i = 0; i < readyLs->getReadyListSize(); ++i) {
-      point -= *readyLs->getInstScoreAtIndex(i);
-      if (point <= 0) {
-        fpIndx = i;
-        break;
-      }
-    }
-  #endif
   //finally we pick whether we will return the fp choice or max score inst w/o using a branch
   size_t indx;
-  #ifdef __HIP_DEVICE_COMPILE__
     if (!dev_rgn_->IsSecondPass())
       indx = dev_useMax ? MaxScoreIndx : fpIndx;
     else {
       bool UseMax = (rand < choose_best_chance) || currentlyWaiting;
       indx = UseMax ? MaxScoreIndx : fpIndx;
     }
-  #else
-    bool UseMax = (rand < choose_best_chance) || currentlyWaiting;
-    indx = UseMax ? MaxScoreIndx : fpIndx;
-  #endif
-  #ifdef __HIP_DEVICE_COMPILE__
     #ifdef DEBUG_INSTR_SELECTION
     if (GLOBALTID==0) {
       printf("Selecting: %d\n", *dev_readyLs->getInstIdAtIndex(indx));
@@ -565,12 +544,6 @@ InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst, InstCount
       printf("End of SelectInstruction()\n");
     }
   #endif
-  #else
-    if (couldAvoidStalling && *readyLs->getInstReadyOnAtIndex(indx) > crntCycleNum_)
-      unnecessarilyStalling = true;
-    else
-      unnecessarilyStalling = false;
-  #endif
   return indx;
 }
 
@@ -707,7 +680,7 @@ InstSchedule *ACOScheduler::FindOneSchedule(InstCount RPTarget,
         if (inst != NULL) {
 #if USE_ACS
           // local pheromone decay
-          pheromone_t *pheromone = &Pheromone(lastInst, inst);
+          pheromone_t *pheromone = PheromonePtr(lastInst, inst);
           *pheromone = 
             (1 - local_decay) * *pheromone + local_decay * initialValue_;
 #endif
@@ -806,71 +779,243 @@ InstSchedule *ACOScheduler::FindOneSchedule(InstCount RPTarget,
   return schedule;
 
 #else  // **** Host version of function ****
+  InstSchedule *schedule = AcquireSchedule_();
+  antStates_[0]->blockIndx = -1;
+  if (!FindOneSchedule(RPTarget, *antStates_[0], schedule)) {
+    ReleaseSchedule_(schedule);
+    return NULL;
+  }
+  return schedule;
+#endif
+}
+
+InstCount ACOScheduler::SelectInstruction(SchedInstruction *lastInst,
+                                          InstCount totalStalls,
+                                          bool &unnecessarilyStalling,
+                                          bool closeToRPTarget,
+                                          bool currentlyWaiting,
+                                          AntState &State) {
+  ACOReadyList &RdyLs = State.readyLs;
+  // if we are waiting and have no fully-ready instruction that is
+  // net 0 or benefit to RP, then return -1 to schedule a stall
+  if (currentlyWaiting && State.RP0OrPositiveCount == 0)
+    return -1;
+
+  int lastInstId = lastInst->GetNum();
+  bool tooManyStalls = totalStalls >= globalBestStalls_ * 5 / 10;
+  bool IsFirstPass = !rgn_->IsSecondPass();
+  int WhichPrirts = GetAntPrirts_(State);
+  const pheromone_t MinScore = 0.0000001;
+  // no penalty may raise a score above its bound, which a division by a
+  // global best of 0 stalls would
+  const int StallDivisor = std::max(globalBestStalls_, 1);
+
+  // computes the score of the instruction at index I of the ready list, or
+  // -1 if it may not be selected while waiting. Only the instructions that
+  // can still be selected are scored.
+  auto CmputScore = [&](InstCount I) -> pheromone_t {
+    // this bool is to check if we should currently avoid unnecessary stalls
+    // because RP is low or we have too many stalls in the schedule
+    bool RPIsHigh = false;
+    InstCount CandidateId = *RdyLs.getInstIdAtIndex(I);
+    SchedInstruction *candidateInst = dataDepGraph_->GetInstByIndx(CandidateId);
+    HeurType candidateLUC = State.lastUseCnt[CandidateId];
+    HeurType candidateDefs = candidateInst->GetDefCnt();
+    InstCount ReadyOn = *RdyLs.getInstReadyOnAtIndex(I);
+
+    if (currentlyWaiting) {
+      // if currently waiting on an instruction, do not consider semi-ready instructions
+      // as well as instructions with a net negative impact on RP
+      if (ReadyOn > State.crntCycleNum || candidateDefs > candidateLUC)
+        return -1;
+    }
+
+    // compute the score
+    HeurType Heur = *RdyLs.getInstHeuristicAtIndex(I);
+    pheromone_t IScore =
+        Score(lastInstId, CandidateId, Heur, IsFirstPass, WhichPrirts);
+    if (State.RP0OrPositiveCount != 0 && candidateDefs > candidateLUC)
+      IScore = IScore * 9/10;
+
+    // add a score penalty for instructions that are not ready yet
+    // unnecessary stalls should not be considered if current RP is low, or if we already have too many stalls
+    if (ReadyOn > State.crntCycleNum) {
+      // like Dev_ACO, the first blocks never add an optional stall
+      if (State.RP0OrPositiveCount != 0 ||
+          (State.blockIndx >= 0 && State.blockIndx < BLOCKOPTSTALLTHRESHOLD)) {
+        IScore = MinScore;
+      }
+      else {
+        int cyclesNeededToWait = ReadyOn - State.crntCycleNum;
+        if (cyclesNeededToWait < globalBestStalls_)
+          IScore = IScore * (globalBestStalls_ - cyclesNeededToWait * 2) / globalBestStalls_;
+        else
+          IScore = IScore / StallDivisor;
+
+        // check if any reg types used by the instructions are above the physical limit
+        RegIndxTuple *uses;
+        uint16_t usesCount = candidateInst->GetUses(uses);
+        for (uint16_t i = 0; i < usesCount; i++) {
+          int16_t regType = dataDepGraph_->getRegByTuple(&uses[i])->GetType();
+          if ( ((BBWithSpill *)rgn_)->IsRPHigh(State, regType) ) {
+            RPIsHigh = true;
+            break;
+          }
+        }
+
+        // reduce likelihood of selecting an instruction we have to wait for IF
+        // RP is low or we have too many stalls already
+        if (!(closeToRPTarget && RPIsHigh) || tooManyStalls) {
+          if (globalBestStalls_ > totalStalls)
+            IScore = IScore * (globalBestStalls_ - totalStalls * 2) / globalBestStalls_;
+          else
+            IScore = IScore / StallDivisor;
+        }
+      }
+    }
+
+    if (IScore < MinScore)
+      IScore = MinScore;
+    return IScore;
+  };
+
+  //generate the random number that we will use for deciding if
+  //we are going to use the fixed bias or if we are going to use
+  //fitness proportional selection
+  double rand = State.RandDouble(0, 1);
+
+  //here we compute the chance that we will use fp selection or auto pick the best
+  double choose_best_chance;
+  if (use_fixed_bias)
+    choose_best_chance = (1 - (double)fixed_bias / count_) * (0 < 1 - (double)fixed_bias / count_);
+  else
+    choose_best_chance = bias_ratio;
+  bool UseMax = (rand < choose_best_chance) || currentlyWaiting;
+
+  // A score is the pheromone of its edge times the heuristic factor of its
+  // instruction, and the penalties only lower it, so no score exceeds the
+  // highest pheromone of the row times its heuristic factor, or MinScore.
+  pheromone_t RowBound = pherRowMax_[lastInstId + 1] * pherScale_;
+  InstCount indx = -1;
+  if (UseMax) {
+    // only the instructions whose heuristic factors could still beat the
+    // best score so far are scored
+    indx = State.heurTree.FindMax(RowBound, MinScore, CmputScore);
+    if (indx == -1)
+      indx = 0;
+  } else {
+    // draw an instruction in proportion to its heuristic factor and accept
+    // it in proportion to its score over the bound of its score, which
+    // selects it in proportion to its score
+    pheromone_t AcceptBound = std::max(RowBound, MinScore);
+    for (int Draw = 0; Draw < ACO_ROULETTE_DRAWS && indx == -1; Draw++) {
+      InstCount I =
+          State.heurTree.Find(State.RandDouble(0, State.heurTree.GetSum()));
+      pheromone_t HeurFactor = State.heurTree.Get(I);
+      if (HeurFactor == 0)
+        continue;
+      if (State.RandDouble(0, AcceptBound * HeurFactor) < CmputScore(I))
+        indx = I;
+    }
+
+    // if the bound is too loose for the draws to succeed, select the first
+    // instruction whose running score sum reaches the selection point
+    if (indx == -1) {
+      size_t RdyLsSize = RdyLs.getReadyListSize();
+      if (State.scorePrefix.size() < RdyLsSize)
+        State.scorePrefix.resize(RdyLsSize);
+      pheromone_t *Prefix = State.scorePrefix.data();
+      pheromone_t RunningSum = 0;
+      for (size_t i = 0; i < RdyLsSize; ++i) {
+        RunningSum += CmputScore(i);
+        Prefix[i] = RunningSum;
+      }
+      pheromone_t point = State.RandDouble(0, RunningSum);
+      pheromone_t *Chosen = std::lower_bound(Prefix, Prefix + RdyLsSize, point);
+      indx = Chosen != Prefix + RdyLsSize ? Chosen - Prefix : 0;
+    }
+  }
+
+  // stalling could have been avoided if any instruction is ready. While
+  // waiting only ready instructions are selected.
+  unnecessarilyStalling = false;
+  if (!currentlyWaiting &&
+      *RdyLs.getInstReadyOnAtIndex(indx) > State.crntCycleNum) {
+    for (InstCount I = 0; I < RdyLs.getReadyListSize(); ++I) {
+      if (*RdyLs.getInstReadyOnAtIndex(I) <= State.crntCycleNum) {
+        unnecessarilyStalling = true;
+        break;
+      }
+    }
+  }
+  return indx;
+}
+
+InstSchedule *ACOScheduler::FindOneSchedule(InstCount RPTarget,
+                                            AntState &State,
+                                            InstSchedule *Sched) {
+  BBWithSpill *SpillRgn = (BBWithSpill *)rgn_;
+  ACOReadyList &RdyLs = State.readyLs;
   SchedInstruction *lastInst = NULL;
   ACOReadyListEntry LastInstInfo;
-  InstSchedule *schedule;
-  schedule = new InstSchedule(machMdl_, dataDepGraph_, true);
+  InstSchedule *schedule = Sched;
   bool IsSecondPass = rgn_->IsSecondPass();
   bool unnecessarilyStalling = false;
-  // The MaxPriority that we are getting from the ready list represents the maximum possible heuristic/key value that we can have
-  // I want to move all the heuristic computation stuff to another class for code tidiness reasons.
-  HeurType MaxPriority = kHelper1->getMaxValue();
-  if (MaxPriority == 0)
-    MaxPriority = 1; // divide by 0 is bad
-  Initialize_();
+  // The second pass compares schedules on several costs at once, so ants
+  // are only cut off against the iteration best in the first pass.
+  bool CutoffEn = !IsTwoPassEn || !IsSecondPass;
+  InstCount SchedLwrBound = dataDepGraph_->GetSchedLwrBound();
+  Initialize_(State);
 
   SchedInstruction *waitFor = NULL;
   InstCount waitUntil = 0;
-  MaxPriorityInv = 1 / (pheromone_t)MaxPriority;
 
   // initialize the aco ready list so that the start instruction is ready
   // The luc component is 0 since the root inst uses no instructions
   InstCount RootId = rootInst_->GetNum();
-  HeurType RootHeuristic = kHelper1->computeKey(rootInst_, true, dataDepGraph_->RegFiles);
-  pheromone_t RootScore = Score(-1, RootId, RootHeuristic, !IsSecondPass);
+  HeurType RootHeuristic = ComputeAntKey_(rootInst_, State);
+  pheromone_t RootScore =
+      Score(-1, RootId, RootHeuristic, !IsSecondPass, GetAntPrirts_(State));
   ACOReadyListEntry InitialRoot{RootId, 0, RootHeuristic, RootScore};
-  readyLs->addInstructionToReadyList(InitialRoot);
-  readyLs->ScoreSum = RootScore;
-  MaxScoringInst = 0;
+  ClearReadyList_(State);
+  AddToReadyList_(InitialRoot, State);
   lastInst = dataDepGraph_->GetInstByIndx(RootId);
   bool closeToRPTarget = false;
-  RP0OrPositiveCount = 0;
+  State.RP0OrPositiveCount = 0;
 
   SchedInstruction *inst = NULL;
-  while (!IsSchedComplete_()) {
+  while (!IsSchedComplete_(State)) {
     // incrementally calculate if there are any instructions with a neutral
     // or positive effect on RP
-    for (InstCount I = 0; I < readyLs->getReadyListSize(); ++I) {
-      if (*readyLs->getInstReadyOnAtIndex(I) == crntCycleNum_) {
-        InstCount CandidateId = *readyLs->getInstIdAtIndex(I);
+    for (InstCount I = 0; I < RdyLs.getReadyListSize(); ++I) {
+      if (*RdyLs.getInstReadyOnAtIndex(I) == State.crntCycleNum) {
+        InstCount CandidateId = *RdyLs.getInstIdAtIndex(I);
         SchedInstruction *candidateInst = dataDepGraph_->GetInstByIndx(CandidateId);
-        HeurType candidateLUC = candidateInst->GetLastUseCnt();
-        int16_t candidateDefs = candidateInst->GetDefCnt();
-        if (candidateDefs <= candidateLUC) {
-          RP0OrPositiveCount = RP0OrPositiveCount + 1;
-        }
+        if (candidateInst->GetDefCnt() <= State.lastUseCnt[CandidateId])
+          State.RP0OrPositiveCount++;
       }
     }
 
     // there are two steps to scheduling an instruction:
     // 1)Select the instruction(if we are not waiting on another instruction)
     inst = NULL;
-    if (!(waitFor && waitUntil <= crntCycleNum_)) {
+    if (!(waitFor && waitUntil <= State.crntCycleNum)) {
       // If an instruction is ready select it
-      assert(readyLs->getReadyListSize() > 0  || waitFor != NULL); // we should always have something in the rl
+      assert(RdyLs.getReadyListSize() > 0  || waitFor != NULL); // we should always have something in the rl
 
       InstCount closeToRPCheck = RPTarget - 2 < RPTarget * 9 / 10 ? RPTarget - 2 : RPTarget * 9 / 10;
-      closeToRPTarget = ((BBWithSpill *)rgn_)->GetCrntSpillCost() >= closeToRPCheck;
+      closeToRPTarget = SpillRgn->GetCrntSpillCost(State) >= closeToRPCheck;
       // select the instruction and get info on it
-      InstCount SelIndx = SelectInstruction(lastInst, schedule->getTotalStalls(), rgn_, unnecessarilyStalling, closeToRPTarget, waitFor ? true: false);
+      InstCount SelIndx = SelectInstruction(lastInst, schedule->getTotalStalls(), unnecessarilyStalling,
+                                            closeToRPTarget, waitFor ? true : false, State);
 
       if (SelIndx != -1) {
-        LastInstInfo = readyLs->removeInstructionAtIndex(SelIndx);
-        
+        LastInstInfo = RemoveFromReadyList_(SelIndx, State);
+
         InstCount InstId = LastInstInfo.InstId;
         inst = dataDepGraph_->GetInstByIndx(InstId);
         // potentially wait on the current instruction
-        if (LastInstInfo.ReadyOn > crntCycleNum_ || !ChkInstLglty_(inst)) {
+        if (LastInstInfo.ReadyOn > State.crntCycleNum || !ChkInstLglty_(State, inst)) {
           waitUntil = LastInstInfo.ReadyOn;
           // should not wait for an instruction while already
           // waiting for another instruction
@@ -880,11 +1025,6 @@ InstSchedule *ACOScheduler::FindOneSchedule(InstCount RPTarget,
         }
 
         if (inst != NULL) {
-  #if USE_ACS
-          // local pheromone decay
-          pheromone_t *pheromone = &Pheromone(lastInst, inst);
-          *pheromone = (1 - local_decay) * *pheromone + local_decay * initialValue_;
-  #endif
           // save the last instruction scheduled
           lastInst = inst;
         }
@@ -893,8 +1033,8 @@ InstSchedule *ACOScheduler::FindOneSchedule(InstCount RPTarget,
 
     // 2)Schedule a stall if we are still waiting, Schedule the instruction we
     // are waiting for if possible, decrement waiting time
-    if (waitFor && waitUntil <= crntCycleNum_) {
-      if (ChkInstLglty_(waitFor)) {
+    if (waitFor && waitUntil <= State.crntCycleNum) {
+      if (ChkInstLglty_(State, waitFor)) {
         inst = waitFor;
         waitFor = NULL;
         lastInst = inst;
@@ -910,35 +1050,758 @@ InstSchedule *ACOScheduler::FindOneSchedule(InstCount RPTarget,
         schedule->incrementUnnecessaryStalls();
     } else {
       instNum = inst->GetNum();
-      SchdulInst_(inst, crntCycleNum_);
-      inst->Schedule(crntCycleNum_, crntSlotNum_);
-      rgn_->SchdulInst(inst, crntCycleNum_, crntSlotNum_, false);
+      SchdulInst_(State, inst);
+      SpillRgn->SchdulInst(State, inst, State.crntCycleNum, State.crntSlotNum);
       // If an ant violates the RP cost constraint, terminate further
       // schedule construction
-      if (((BBWithSpill*)rgn_)->GetCrntSpillCost() > RPTarget) {
-        // end schedule construction
-        // keep track of ants terminated
-        numAntsTerminated_++;
-        readyLs->clearReadyList();
-        delete schedule;
+      if (SpillRgn->GetCrntSpillCost(State) > RPTarget) {
+        ClearReadyList_(State);
         return NULL;
       }
-      DoRsrvSlots_(inst);
-      // this is annoying
-      UpdtSlotAvlblty_(inst);
+      // Likewise terminate an ant that is strictly worse than an ant that
+      // already completed this iteration. Ties are kept, so the iteration
+      // best does not depend on which ants happen to finish first.
+      if (CutoffEn) {
+        InstCount CostLB = SpillRgn->CmputCostLwrBound(
+            State, std::max(schedule->GetCrntLngth(), SchedLwrBound),
+            IsTwoPassEn);
+        if (CostLB != INVALID_VALUE &&
+            CostLB > hostIterBestCost_.load(std::memory_order_relaxed)) {
+          ClearReadyList_(State);
+          State.antsCutOff++;
+          return NULL;
+        }
+      }
+      DoRsrvSlots_(State, inst);
+      UpdtSlotAvlblty_(State, inst);
 
       // new readylist update
-      UpdateACOReadyList(inst, IsSecondPass);
+      UpdateACOReadyList(inst, State);
     }
-    /* Logger::Info("Chose instruction %d (for some reason)", instNum); */
     schedule->AppendInst(instNum);
-    if (MovToNxtSlot_(inst))
-      InitNewCycle_();
+    if (MovToNxtSlot_(State, inst))
+      InitNewCycle_(State);
+  }
+  // Ants that rebuild a schedule seen before take its costs instead of
+  // computing them again
+  if (FindSeenCost_(schedule, State)) {
+    schedule->SetSpillCosts(State.spillCosts);
+    schedule->SetPeakRegPressures(State.peakRegPressures);
+    State.duplicateAnts++;
+  } else {
+    SpillRgn->UpdateScheduleCost(State, schedule);
+    AddSeenCost_(schedule);
+  }
+  schedule->setIsZeroPerp(SpillRgn->ReturnPeakSpillCost(State) == 0);
+  if (CutoffEn && schedule->GetCost() != INVALID_VALUE) {
+    InstCount Cost =
+        IsTwoPassEn ? schedule->GetNormSpillCost() : schedule->GetCost();
+    InstCount Best = hostIterBestCost_.load(std::memory_order_relaxed);
+    while (Cost < Best && !hostIterBestCost_.compare_exchange_weak(Best, Cost))
+      ;
   }
-  rgn_->UpdateScheduleCost(schedule);
-  schedule->setIsZeroPerp( ((BBWithSpill *)rgn_)->ReturnPeakSpillCost() == 0 );
   return schedule;
-#endif
+}
+
+void ACOScheduler::UpdateACOReadyList(SchedInstruction *inst,
+                                      AntState &State) {
+  ACOReadyList &RdyLs = State.readyLs;
+  InstCount InstNum = inst->GetNum();
+
+  // Notify each successor of this instruction that it has been scheduled.
+  size_t ScsrEnd = ddgBlob_.GetScsrEnd(InstNum);
+  for (size_t I = ddgBlob_.GetScsrBgn(InstNum); I < ScsrEnd; ++I) {
+    InstCount ScsrNum = ddgBlob_.GetScsr(I);
+    InstCount RdyCycle = State.crntCycleNum + ddgBlob_.GetScsrLtncy(I);
+    if (RdyCycle > State.minRdyCycle[ScsrNum])
+      State.minRdyCycle[ScsrNum] = RdyCycle;
+
+    if (--State.unschduldPrdcsrCnt[ScsrNum] == 0) {
+      // If all other predecessors of this successor have been scheduled then
+      // we now know in which cycle this successor will become ready.
+      SchedInstruction *crntScsr = dataDepGraph_->GetInstByIndx(ScsrNum);
+      HeurType HeurWOLuc = ComputeAntKey_(crntScsr, State);
+      AddToReadyList_(ACOReadyListEntry{ScsrNum, State.minRdyCycle[ScsrNum], HeurWOLuc, 0}, State);
+    }
+  }
+
+  // The scheduling of an instruction may have increased another
+  // instruction's LUC
+  PriorityEntry LUCEntry =
+      State.blockIndx >= 0 && kHelper2
+          ? kHelper2->getPriorityEntry(LSH_LUC, GetAntPrirts_(State))
+          : kHelper1->getPriorityEntry(LSH_LUC);
+  if (LUCEntry.Width) {
+    for (InstCount I = 0; I < RdyLs.getReadyListSize(); ++I) {
+      InstCount CandidateId = *RdyLs.getInstIdAtIndex(I);
+      State.lastUseCnt[CandidateId] =
+          CmputLastUseCnt_(dataDepGraph_->GetInstByIndx(CandidateId), State);
+    }
+  }
+  State.RP0OrPositiveCount = 0;
+}
+
+int ACOScheduler::GetAntPrirts_(const AntState &State) const {
+  // kHelper2 only exists in the second pass
+  if (State.blockIndx >= 0 && kHelper2 && State.blockIndx % 2 != 0)
+    return 2;
+  return 1;
+}
+
+HeurType ACOScheduler::ComputeAntKey_(SchedInstruction *Inst,
+                                      const AntState &State) const {
+  if (State.blockIndx >= 0 && kHelper2)
+    return kHelper2->computeKey(Inst, false, dataDepGraph_->RegFiles, NULL,
+                                GetAntPrirts_(State));
+  return kHelper1->computeKey(Inst, false, dataDepGraph_->RegFiles);
+}
+
+pheromone_t ACOScheduler::HeurFactor_(HeurType Heur,
+                                      const AntState &State) const {
+  if (!heuristicImportance_)
+    return 1.0;
+  if (GetAntPrirts_(State) == 1 || !rgn_->IsSecondPass())
+    return Heur * MaxPriorityInv + 1;
+  return Heur * MaxPriorityInv2 + 1;
+}
+
+void ACOScheduler::AddToReadyList_(const ACOReadyListEntry &Entry,
+                                   AntState &State) {
+  State.heurTree.Set(State.readyLs.getReadyListSize(),
+                     HeurFactor_(Entry.Heuristic, State));
+  State.readyLs.addInstructionToReadyList(Entry);
+}
+
+ACOReadyListEntry ACOScheduler::RemoveFromReadyList_(InstCount Indx,
+                                                     AntState &State) {
+  // the ready list moves its last entry into the removed one's place
+  InstCount LastIndx = State.readyLs.getReadyListSize() - 1;
+  State.heurTree.Set(Indx, State.heurTree.Get(LastIndx));
+  State.heurTree.Set(LastIndx, 0);
+  return State.readyLs.removeInstructionAtIndex(Indx);
+}
+
+void ACOScheduler::ClearReadyList_(AntState &State) {
+  State.readyLs.clearReadyList();
+  State.heurTree.Clear();
+}
+
+int16_t ACOScheduler::CmputLastUseCnt_(SchedInstruction *Inst,
+                                       const AntState &State) {
+  RegIndxTuple *uses;
+  int16_t LastUseCnt = 0;
+  uint16_t usesCount = Inst->GetUses(uses);
+  for (uint16_t i = 0; i < usesCount; i++) {
+    Register *use = dataDepGraph_->getRegByTuple(&uses[i]);
+    int CrntUseCnt = State.crntUseCnt[State.GetRegIndx(use->GetType(), use->GetNum())];
+    assert(CrntUseCnt < use->GetUseCnt());
+    if (CrntUseCnt + 1 == use->GetUseCnt())
+      LastUseCnt++;
+  }
+  return LastUseCnt;
+}
+
+void ACOScheduler::StartHostAnts_(InstCount RPTarget, int Iteration,
+                                  HostAntBatch &Batch) {
+  hostIterBestCost_ = std::numeric_limits<InstCount>::max();
+  // The pool is not thread safe, so take every ant's schedule from it here
+  // and give back the ones of terminated ants once all ants are done.
+  Batch.Bufs.resize(numThreads_);
+  for (int i = 0; i < numThreads_; i++)
+    Batch.Bufs[i] = AcquireSchedule_();
+  Batch.Scheds.assign(numThreads_, nullptr);
+  Batch.Started.assign(numThreads_, false);
+
+  int ThreadCnt = antStates_.size();
+  auto StartTime = Utilities::startTime;
+  auto RunAnts = [this, RPTarget, Iteration, ThreadCnt, StartTime,
+                  &Batch](int Thread) {
+    // Measure time from the start of the region like the calling thread.
+    Utilities::startTime = StartTime;
+    AntState &State = *antStates_[Thread];
+    for (int i = Thread; i < numThreads_; i += ThreadCnt) {
+      // Ants not started before the deadline are dropped
+      if (TimedOut_())
+        break;
+      // Each ant's random stream is keyed by its number, so the schedules
+      // built do not depend on how the ants are spread over the threads.
+      State.SetRandKey(randSeed_, randRgnKey_, Iteration, i);
+      // The ants of an emulated Dev_ACO grid make the same per block choices
+      // as the threads of the kernel
+      State.blockIndx = devAcoOnHost_ ? i / NUMTHREADSPERBLOCK : -1;
+      Batch.Started[i] = true;
+      Batch.Scheds[i] = FindOneSchedule(RPTarget, State, Batch.Bufs[i]);
+    }
+  };
+
+  if (!hostThreadPool_) {
+    RunAnts(0);
+  } else {
+    for (int Thread = 0; Thread < ThreadCnt; Thread++)
+      hostThreadPool_->async(RunAnts, Thread);
+  }
+}
+
+void ACOScheduler::FinishHostAnts_(HostAntBatch &Batch) {
+  if (hostThreadPool_)
+    hostThreadPool_->wait();
+  for (int i = 0; i < numThreads_; i++)
+    if (!Batch.Scheds[i])
+      ReleaseSchedule_(Batch.Bufs[i]);
+}
+
+bool ACOScheduler::TimedOut_() {
+  if (deadline_ == 0)
+    return false;
+  if (!timedOut_ && Utilities::GetProcessorTime() >= deadline_)
+    timedOut_ = true;
+  return timedOut_;
+}
+
+bool ACOScheduler::LoadCachedPheromone_() {
+  size_t EntryCnt = useSparsePher_ ? sparsePher_.GetEntryCnt()
+                                   : (size_t)(count_ + 1) * count_;
+  std::vector<pheromone_t> Table(EntryCnt);
+  if (!PheromoneCache::getInstance().Lookup(pherCacheKey_, ddgBlob_,
+                                            useSparsePher_, Table))
+    return false;
+  // The cached table is stored with an average of 1
+  pherScale_ = 1;
+  for (size_t I = 0; I < EntryCnt; ++I) {
+    pheromone_t Value = Table[I] * initialValue_;
+    if (useSparsePher_)
+      sparsePher_.GetEntry(I) = Value;
+    else
+      pheromone_[I] = Value;
+  }
+  CmputPherRowMax_();
+  return true;
+}
+
+void ACOScheduler::StoreCachedPheromone_() {
+  NormalizePheromone_();
+  size_t EntryCnt = useSparsePher_ ? sparsePher_.GetEntryCnt()
+                                   : (size_t)(count_ + 1) * count_;
+  std::vector<pheromone_t> Table(EntryCnt);
+  pheromone_t Sum = 0;
+  for (size_t I = 0; I < EntryCnt; ++I) {
+    Table[I] = useSparsePher_ ? sparsePher_.GetEntry(I) : pheromone_[I];
+    Sum += Table[I];
+  }
+  if (EntryCnt == 0 || !(Sum > 0))
+    return;
+  pheromone_t Avg = Sum / EntryCnt;
+  for (pheromone_t &Value : Table)
+    Value /= Avg;
+  PheromoneCache::getInstance().Insert(pherCacheKey_, ddgBlob_,
+                                       useSparsePher_, std::move(Table));
+}
+
+void ACOScheduler::SetIsland(ACOIslands *Islands, int Island) {
+  islands_ = Islands;
+  islandIndx_ = Island;
+  pherStaleness_ = 0;
+}
+
+bool ACOScheduler::Migrate_(InstSchedule *&BestSchedule, InstCount &RPTarget) {
+  InstSchedule *Immigrant = AcquireSchedule_();
+  islands_->Migrate(islandIndx_, BestSchedule, Immigrant);
+  if (!shouldReplaceSchedule(BestSchedule, Immigrant, true, RPTarget)) {
+    ReleaseSchedule_(Immigrant);
+    return false;
+  }
+  stats::acoImmigrants++;
+  // Pull this colony's search towards the immigrant
+  UpdatePheromone(Immigrant, false);
+  if (BestSchedule != InitialSchedule)
+    ReleaseSchedule_(BestSchedule);
+  BestSchedule = Immigrant;
+  if (!((BBWithSpill *)rgn_)->needsSLIL())
+    RPTarget = BestSchedule->GetSpillCost();
+  if (BestSchedule->getTotalStalls() < GetGlobalBestStalls())
+    SetGlobalBestStalls(BestSchedule->GetCrntLngth() -
+                        dataDepGraph_->GetInstCnt());
+  Logger::Info("ACO colony %d took the best schedule of colony %d, cost %d",
+               islandIndx_, (islandIndx_ + 1) % islands_->GetIslandCnt(),
+               BestSchedule->GetCost());
+  return true;
+}
+
+InstSchedule *ACOScheduler::AcquireSchedule_() {
+  if (freeScheds_.empty()) {
+    bool Allocated;
+    InstSchedule *Sched = ACOContext::getInstance().AcquireSchedule(
+        machMdl_, dataDepGraph_, Allocated);
+    if (Allocated)
+      schedAllocCnt_++;
+    return Sched;
+  }
+  InstSchedule *Sched = freeScheds_.back();
+  freeScheds_.pop_back();
+  Sched->Reset();
+  Sched->resetTotalStalls();
+  Sched->resetUnnecessaryStalls();
+  Sched->setIsZeroPerp(false);
+  return Sched;
+}
+
+void ACOScheduler::ReleaseSchedule_(InstSchedule *Sched) {
+  if (Sched)
+    freeScheds_.push_back(Sched);
+}
+
+InstSchedule *ACOScheduler::ReduceLikeDevice_(
+    std::vector<InstSchedule *> &Scheds, InstCount RPTarget) {
+  // Every round pairs neighbours and keeps the winner of each pair. An odd
+  // schedule out is carried to the next round, which is also what the
+  // per block trees followed by the tree over the block bests amount to.
+  size_t Cnt = Scheds.size();
+  while (Cnt > 1) {
+    size_t Kept = 0;
+    for (size_t i = 0; i < Cnt; i += 2) {
+      InstSchedule *Winner = Scheds[i];
+      if (i + 1 < Cnt) {
+        InstSchedule *Loser = Scheds[i + 1];
+        if (shouldReplaceSchedule(Winner, Loser, false, RPTarget))
+          std::swap(Winner, Loser);
+        ReleaseSchedule_(Loser);
+      }
+      Scheds[Kept++] = Winner;
+    }
+    Cnt = Kept;
+  }
+  InstSchedule *Best = Cnt ? Scheds[0] : nullptr;
+  std::fill(Scheds.begin(), Scheds.end(), nullptr);
+  return Best;
+}
+
+InstSchedule *ACOScheduler::ReplayOrder_(const std::vector<InstCount> &Order,
+                                         InstCount RPTarget, AntState &State,
+                                         InstSchedule *Sched) {
+  BBWithSpill *SpillRgn = (BBWithSpill *)rgn_;
+  Initialize_(State);
+  size_t Next = 0;
+  while (!IsSchedComplete_(State)) {
+    SchedInstruction *inst = dataDepGraph_->GetInstByIndx(Order[Next]);
+    InstCount InstNum = inst->GetNum();
+    // The root has no predecessors to set its ready cycle
+    InstCount ReadyOn = std::max<InstCount>(State.minRdyCycle[InstNum], 0);
+    if (ReadyOn > State.crntCycleNum || !ChkInstLglty_(State, inst)) {
+      inst = NULL;
+      Sched->incrementTotalStalls();
+      Sched->AppendInst(SCHD_STALL);
+    } else {
+      assert(State.unschduldPrdcsrCnt[InstNum] == 0);
+      SchdulInst_(State, inst);
+      SpillRgn->SchdulInst(State, inst, State.crntCycleNum, State.crntSlotNum);
+      if (SpillRgn->GetCrntSpillCost(State) > RPTarget)
+        return NULL;
+      DoRsrvSlots_(State, inst);
+      UpdtSlotAvlblty_(State, inst);
+      size_t ScsrEnd = ddgBlob_.GetScsrEnd(InstNum);
+      for (size_t I = ddgBlob_.GetScsrBgn(InstNum); I < ScsrEnd; ++I) {
+        InstCount ScsrNum = ddgBlob_.GetScsr(I);
+        InstCount RdyCycle = State.crntCycleNum + ddgBlob_.GetScsrLtncy(I);
+        if (RdyCycle > State.minRdyCycle[ScsrNum])
+          State.minRdyCycle[ScsrNum] = RdyCycle;
+        State.unschduldPrdcsrCnt[ScsrNum]--;
+      }
+      Sched->AppendInst(InstNum);
+      Next++;
+    }
+    if (MovToNxtSlot_(State, inst))
+      InitNewCycle_(State);
+  }
+  if (FindSeenCost_(Sched, State)) {
+    Sched->SetSpillCosts(State.spillCosts);
+    Sched->SetPeakRegPressures(State.peakRegPressures);
+  } else {
+    SpillRgn->UpdateScheduleCost(State, Sched);
+    AddSeenCost_(Sched);
+  }
+  Sched->setIsZeroPerp(SpillRgn->ReturnPeakSpillCost(State) == 0);
+  return Sched;
+}
+
+bool ACOScheduler::FindSeenCost_(InstSchedule *Sched, AntState &State) {
+  std::lock_guard<std::mutex> Lock(seenSchedsMutex_);
+  auto It = seenScheds_.find(Sched->GetHash());
+  if (It == seenScheds_.end())
+    return false;
+  const std::vector<InstCount> &Slots = It->second.Slots;
+  if (Slots.size() != (size_t)Sched->GetSlotCnt() ||
+      !std::equal(Slots.begin(), Slots.end(), Sched->GetInstsInSlots()))
+    return false;
+  // UpdateScheduleCost() leaves the spill cost in the state too, e.g. the
+  // one found by the register allocator for SCF_SPILLS
+  State.crntSpillCost = It->second.SpillCost;
+  Sched->SetCost(It->second.Cost);
+  Sched->SetExecCost(It->second.ExecCost);
+  Sched->SetSpillCost(It->second.SpillCost);
+  Sched->SetNormSpillCost(It->second.NormSpillCost);
+  return true;
+}
+
+void ACOScheduler::AddSeenCost_(InstSchedule *Sched) {
+  std::lock_guard<std::mutex> Lock(seenSchedsMutex_);
+  const InstCount *Slots = Sched->GetInstsInSlots();
+  // A different schedule with the same hash keeps the entry of the first
+  // one and is costed every time.
+  seenScheds_.emplace(
+      Sched->GetHash(),
+      SeenSchedCost{std::vector<InstCount>(Slots, Slots + Sched->GetSlotCnt()),
+                    Sched->GetCost(), Sched->GetExecCost(),
+                    Sched->GetSpillCost(), Sched->GetNormSpillCost()});
+}
+
+void ACOScheduler::BuildLocalSearchProfile_(InstSchedule *Sched,
+                                            LocalSearchProfile &Prof,
+                                            AntState &State) {
+  BBWithSpill *SpillRgn = (BBWithSpill *)rgn_;
+  int16_t RegTypeCnt = machMdl_->GetRegTypeCnt();
+  RegisterFile *RegFiles = dataDepGraph_->getRegFiles();
+  InstCount InstCnt = dataDepGraph_->GetInstCnt();
+  int RegCnt = 0;
+  for (int16_t i = 0; i < RegTypeCnt; i++)
+    RegCnt += RegFiles[i].GetRegCnt();
+
+  Prof.Order.clear();
+  Prof.Steps.assign(InstCnt, INVALID_VALUE);
+  Prof.Slots.assign(InstCnt, INVALID_VALUE);
+  const InstCount *InstsInSlots = Sched->GetInstsInSlots();
+  for (InstCount Slot = 0; Slot < Sched->GetSlotCnt(); Slot++) {
+    InstCount InstNum = InstsInSlots[Slot];
+    if (InstNum == SCHD_STALL)
+      continue;
+    Prof.Steps[InstNum] = Prof.Order.size();
+    Prof.Slots[InstNum] = Slot;
+    Prof.Order.push_back(InstNum);
+  }
+  InstCount StepCnt = Prof.Order.size();
+
+  Prof.DefSteps.assign(RegCnt, -1);
+  Prof.LastUseSteps.assign(3 * RegCnt, -1);
+  for (InstCount Step = 0; Step < StepCnt; Step++) {
+    SchedInstruction *Inst = dataDepGraph_->GetInstByIndx(Prof.Order[Step]);
+    RegIndxTuple *Regs;
+    int16_t UseCnt = Inst->GetUses(Regs);
+    for (int16_t i = 0; i < UseCnt; i++) {
+      InstCount *LastUses =
+          &Prof.LastUseSteps[3 * State.GetRegIndx(Regs[i].regType_,
+                                                  Regs[i].regNum_)];
+      LastUses[2] = LastUses[1];
+      LastUses[1] = LastUses[0];
+      LastUses[0] = Step;
+    }
+    int16_t DefCnt = Inst->GetDefs(Regs);
+    for (int16_t i = 0; i < DefCnt; i++) {
+      int RegIndx = State.GetRegIndx(Regs[i].regType_, Regs[i].regNum_);
+      if (Prof.DefSteps[RegIndx] == -1)
+        Prof.DefSteps[RegIndx] = Step;
+    }
+  }
+
+  // A register is live after the steps from its definition up to, but not
+  // including, its last use, as in BBWithSpill::UpdateSpillInfoForSchdul_()
+  std::vector<int> Changes((StepCnt + 1) * RegTypeCnt, 0);
+  Prof.LiveSum = 0;
+  for (int16_t i = 0; i < RegTypeCnt; i++) {
+    for (int j = 0; j < RegFiles[i].GetRegCnt(); j++) {
+      int RegIndx = State.GetRegIndx(i, j);
+      InstCount DefStep = Prof.DefSteps[RegIndx];
+      if (DefStep == -1)
+        continue;
+      Register *Reg = RegFiles[i].GetReg(j);
+      InstCount EndStep = Reg->GetUseCnt() == 0
+                              ? StepCnt
+                              : Prof.LastUseSteps[3 * RegIndx];
+      if (EndStep <= DefStep)
+        continue;
+      Changes[DefStep * RegTypeCnt + i] += Reg->GetWght();
+      Changes[EndStep * RegTypeCnt + i] -= Reg->GetWght();
+      Prof.LiveSum += EndStep - DefStep;
+    }
+  }
+
+  SPILL_COST_FUNCTION SpillCostFunc = SpillRgn->GetSpillCostFunc();
+  Prof.StepCostFunc =
+      SpillCostFunc == SCF_SLIL || SpillCostFunc == SCF_PEAK_PER_TYPE
+          ? SCF_PERP
+          : SpillCostFunc;
+  Prof.Pressures.resize(StepCnt * RegTypeCnt);
+  Prof.PrefixPeaks.resize(StepCnt * RegTypeCnt);
+  Prof.SuffixPeaks.resize(StepCnt * RegTypeCnt);
+  Prof.StepCosts.resize(StepCnt);
+  Prof.PrefixMaxCosts.resize(StepCnt);
+  Prof.SuffixMaxCosts.resize(StepCnt);
+  Prof.TotStepCost = 0;
+  for (InstCount Step = 0; Step < StepCnt; Step++) {
+    for (int16_t i = 0; i < RegTypeCnt; i++) {
+      size_t Indx = Step * RegTypeCnt + i;
+      int Pressure = Changes[Indx] +
+                     (Step == 0 ? 0 : (int)Prof.Pressures[Indx - RegTypeCnt]);
+      Prof.Pressures[Indx] = Pressure;
+      Prof.PrefixPeaks[Indx] =
+          Step == 0 ? Pressure
+                    : std::max<unsigned>(Pressure,
+                                         Prof.PrefixPeaks[Indx - RegTypeCnt]);
+      State.regPressures[i] = Pressure;
+    }
+    Prof.StepCosts[Step] =
+        SpillRgn->CmputCostForFunction(State, Prof.StepCostFunc);
+    Prof.PrefixMaxCosts[Step] =
+        Step == 0 ? Prof.StepCosts[Step]
+                  : std::max(Prof.StepCosts[Step],
+                             Prof.PrefixMaxCosts[Step - 1]);
+    Prof.TotStepCost += Prof.StepCosts[Step];
+  }
+  for (InstCount Step = StepCnt - 1; Step >= 0; Step--) {
+    for (int16_t i = 0; i < RegTypeCnt; i++) {
+      size_t Indx = Step * RegTypeCnt + i;
+      Prof.SuffixPeaks[Indx] =
+          Step == StepCnt - 1
+              ? Prof.Pressures[Indx]
+              : std::max(Prof.Pressures[Indx],
+                         Prof.SuffixPeaks[Indx + RegTypeCnt]);
+    }
+    Prof.SuffixMaxCosts[Step] =
+        Step == StepCnt - 1 ? Prof.StepCosts[Step]
+                            : std::max(Prof.StepCosts[Step],
+                                       Prof.SuffixMaxCosts[Step + 1]);
+  }
+
+  for (int16_t i = 0; i < RegTypeCnt; i++)
+    State.peakRegPressures[i] =
+        Prof.PrefixPeaks[(StepCnt - 1) * RegTypeCnt + i];
+  Prof.SpillCost =
+      CmputProfileSpillCost_(Prof, Prof.PrefixMaxCosts[StepCnt - 1],
+                             Prof.TotStepCost, Prof.LiveSum, State);
+}
+
+InstCount ACOScheduler::CmputSwapSpillCost_(LocalSearchProfile &Prof,
+                                            InstCount XStep, InstCount YStep,
+                                            AntState &State) {
+  BBWithSpill *SpillRgn = (BBWithSpill *)rgn_;
+  int16_t RegTypeCnt = machMdl_->GetRegTypeCnt();
+  InstCount StepCnt = Prof.Order.size();
+  SchedInstruction *X = dataDepGraph_->GetInstByIndx(Prof.Order[XStep]);
+  SchedInstruction *Y = dataDepGraph_->GetInstByIndx(Prof.Order[YStep]);
+  // The scheduled set only differs in the steps from XStep to YStep - 1
+  Prof.PressureDeltas.assign((YStep - XStep) * RegTypeCnt, 0);
+  InstCount LiveDelta = 0;
+
+  auto NewStep = [&](InstCount Step) {
+    return Step == XStep ? YStep : Step == YStep ? XStep : Step;
+  };
+  auto UsesReg = [](SchedInstruction *Inst, const RegIndxTuple &Reg) {
+    RegIndxTuple *Uses;
+    int16_t UseCnt = Inst->GetUses(Uses);
+    for (int16_t i = 0; i < UseCnt; i++)
+      if (Uses[i].regType_ == Reg.regType_ && Uses[i].regNum_ == Reg.regNum_)
+        return true;
+    return false;
+  };
+  // Adds the change of the live range of a register of X or Y
+  auto MoveLiveRange = [&](const RegIndxTuple &Tuple) {
+    int RegIndx = State.GetRegIndx(Tuple.regType_, Tuple.regNum_);
+    InstCount DefStep = Prof.DefSteps[RegIndx];
+    if (DefStep == -1)
+      return;
+    Register *Reg =
+        dataDepGraph_->getRegByTuple(const_cast<RegIndxTuple *>(&Tuple));
+    InstCount EndStep = StepCnt, NewEndStep = StepCnt;
+    if (Reg->GetUseCnt() > 0) {
+      // Any use of X or Y that is not among the last three uses moves to
+      // the step of the other instruction, which may make it the last one
+      const InstCount *LastUses = &Prof.LastUseSteps[3 * RegIndx];
+      EndStep = LastUses[0];
+      NewEndStep = -1;
+      for (int i = 0; i < 3; i++)
+        if (LastUses[i] != -1)
+          NewEndStep = std::max(NewEndStep, NewStep(LastUses[i]));
+      if (UsesReg(X, Tuple))
+        NewEndStep = std::max(NewEndStep, YStep);
+      if (UsesReg(Y, Tuple))
+        NewEndStep = std::max(NewEndStep, XStep);
+    }
+    InstCount NewDefStep = NewStep(DefStep);
+    for (InstCount Step = XStep; Step < YStep; Step++) {
+      int Delta = (NewDefStep <= Step && Step < NewEndStep) -
+                  (DefStep <= Step && Step < EndStep);
+      if (Delta == 0)
+        continue;
+      Prof.PressureDeltas[(Step - XStep) * RegTypeCnt + Tuple.regType_] +=
+          Delta * Reg->GetWght();
+      LiveDelta += Delta;
+    }
+  };
+
+  // A register used by both instructions is only moved once. Without an
+  // edge between them, they cannot share a register in any other way.
+  RegIndxTuple *Regs;
+  int16_t RegCnt = X->GetDefs(Regs);
+  for (int16_t i = 0; i < RegCnt; i++)
+    MoveLiveRange(Regs[i]);
+  RegCnt = X->GetUses(Regs);
+  for (int16_t i = 0; i < RegCnt; i++)
+    MoveLiveRange(Regs[i]);
+  RegCnt = Y->GetDefs(Regs);
+  for (int16_t i = 0; i < RegCnt; i++)
+    MoveLiveRange(Regs[i]);
+  RegCnt = Y->GetUses(Regs);
+  for (int16_t i = 0; i < RegCnt; i++)
+    if (!UsesReg(X, Regs[i]))
+      MoveLiveRange(Regs[i]);
+
+  InstCount PeakCost = XStep == 0 ? 0 : Prof.PrefixMaxCosts[XStep - 1];
+  PeakCost = std::max(PeakCost, Prof.SuffixMaxCosts[YStep]);
+  InstCount TotCost = Prof.TotStepCost;
+  for (int16_t i = 0; i < RegTypeCnt; i++)
+    State.peakRegPressures[i] =
+        std::max(XStep == 0 ? 0
+                            : Prof.PrefixPeaks[(XStep - 1) * RegTypeCnt + i],
+                 Prof.SuffixPeaks[YStep * RegTypeCnt + i]);
+  for (InstCount Step = XStep; Step < YStep; Step++) {
+    for (int16_t i = 0; i < RegTypeCnt; i++) {
+      unsigned Pressure =
+          Prof.Pressures[Step * RegTypeCnt + i] +
+          Prof.PressureDeltas[(Step - XStep) * RegTypeCnt + i];
+      State.regPressures[i] = Pressure;
+      State.peakRegPressures[i] =
+          std::max<InstCount>(State.peakRegPressures[i], Pressure);
+    }
+    InstCount StepCost =
+        SpillRgn->CmputCostForFunction(State, Prof.StepCostFunc);
+    PeakCost = std::max(PeakCost, StepCost);
+    TotCost += StepCost - Prof.StepCosts[Step];
+  }
+  return CmputProfileSpillCost_(Prof, PeakCost, TotCost,
+                                Prof.LiveSum + LiveDelta, State);
+}
+
+InstCount ACOScheduler::CmputProfileSpillCost_(const LocalSearchProfile &Prof,
+                                               InstCount PeakCost,
+                                               InstCount TotCost,
+                                               InstCount LiveSum,
+                                               AntState &State) {
+  BBWithSpill *SpillRgn = (BBWithSpill *)rgn_;
+  // Same as BBWithSpill::CmputCrntSpillCost_(). The spills found by the
+  // register allocator are estimated by the peak excess pressure.
+  switch (SpillRgn->GetSpillCostFunc()) {
+  case SCF_PEAK_PER_TYPE:
+    return SpillRgn->CmputCostForFunction(State, SCF_PEAK_PER_TYPE);
+  case SCF_SUM:
+    return TotCost;
+  case SCF_PEAK_PLUS_AVG:
+    return PeakCost + TotCost / dataDepGraph_->GetInstCnt();
+  case SCF_SLIL:
+    return LiveSum;
+  default:
+    return PeakCost;
+  }
+}
+
+bool ACOScheduler::LocalSearch_(InstSchedule *&BestSchedule,
+                                InstCount &RPTarget) {
+  // The host ants are done, so their first state is free
+  AntState &State = *antStates_[0];
+  LocalSearchProfile Prof;
+  BuildLocalSearchProfile_(BestSchedule, Prof, State);
+  InstCount StepCnt = Prof.Order.size();
+  std::vector<InstCount> Order;
+
+  // The first slot in which an instruction can be issued without breaking
+  // the latency of a predecessor, and the last one in which it can be issued
+  // without breaking the latency of a successor
+  auto GetRlsSlot = [&](InstCount InstNum) {
+    InstCount RlsSlot = 0;
+    size_t PrdcsrEnd = ddgBlob_.GetPrdcsrEnd(InstNum);
+    for (size_t E = ddgBlob_.GetPrdcsrBgn(InstNum); E < PrdcsrEnd; ++E) {
+      InstCount PrdcsrSlot = Prof.Slots[ddgBlob_.GetPrdcsr(E)];
+      InstCount RdyCycle = PrdcsrSlot / issuRate_ + ddgBlob_.GetPrdcsrLtncy(E);
+      RlsSlot = std::max(RlsSlot,
+                         std::max(PrdcsrSlot + 1, RdyCycle * issuRate_));
+    }
+    return RlsSlot;
+  };
+  auto GetDdlnSlot = [&](InstCount InstNum) {
+    InstCount DdlnSlot = std::numeric_limits<InstCount>::max();
+    size_t ScsrEnd = ddgBlob_.GetScsrEnd(InstNum);
+    for (size_t E = ddgBlob_.GetScsrBgn(InstNum); E < ScsrEnd; ++E) {
+      InstCount ScsrSlot = Prof.Slots[ddgBlob_.GetScsr(E)];
+      InstCount LastCycle = ScsrSlot / issuRate_ - ddgBlob_.GetScsrLtncy(E);
+      DdlnSlot = std::min(DdlnSlot, std::min(ScsrSlot - 1,
+                                             LastCycle * issuRate_ +
+                                                 issuRate_ - 1));
+    }
+    return DdlnSlot;
+  };
+  // Instructions that reserve or block slots stay where they are
+  auto IsMovable = [](SchedInstruction *Inst) {
+    return Inst->IsPipelined() && !Inst->BlocksCycle();
+  };
+
+  bool Improved = false;
+  int PassCnt = 0;
+  while (PassCnt < localSearchPasses_ && !TimedOut_()) {
+    PassCnt++;
+    bool PassImproved = false;
+    for (InstCount XStep = 0; XStep + 1 < StepCnt && !TimedOut_(); XStep++) {
+      InstCount XNum = Prof.Order[XStep];
+      SchedInstruction *X = dataDepGraph_->GetInstByIndx(XNum);
+      if (!IsMovable(X))
+        continue;
+      // X and a later Y can trade slots if X's slot is within Y's window and
+      // Y's slot within X's. All other instructions then keep their slots,
+      // so the schedule gets no longer, and only the spill cost changes. A
+      // successor of X ends the window of X, so the order stays legal.
+      InstCount XSlot = Prof.Slots[XNum];
+      InstCount XDdlnSlot = GetDdlnSlot(XNum);
+      for (InstCount YStep = XStep + 1;
+           YStep < StepCnt && YStep - XStep <= LOCAL_SEARCH_MAX_DIST;
+           YStep++) {
+        InstCount YNum = Prof.Order[YStep];
+        InstCount YSlot = Prof.Slots[YNum];
+        if (YSlot > XDdlnSlot)
+          break;
+        SchedInstruction *Y = dataDepGraph_->GetInstByIndx(YNum);
+        if (!IsMovable(Y) || GetRlsSlot(YNum) > XSlot)
+          continue;
+        if (X->GetIssueType() != Y->GetIssueType() &&
+            XSlot / issuRate_ != YSlot / issuRate_)
+          continue;
+        if (CmputSwapSpillCost_(Prof, XStep, YStep, State) >= Prof.SpillCost)
+          continue;
+
+        // Only the swaps that lower the spill cost are replayed, which may
+        // also close stalls that the swap made unnecessary
+        Order = Prof.Order;
+        std::swap(Order[XStep], Order[YStep]);
+        InstSchedule *Cand = AcquireSchedule_();
+        if (ReplayOrder_(Order, RPTarget, State, Cand) &&
+            shouldReplaceSchedule(BestSchedule, Cand, true, RPTarget)) {
+          if (BestSchedule != InitialSchedule)
+            ReleaseSchedule_(BestSchedule);
+          BestSchedule = Cand;
+          if (!((BBWithSpill *)rgn_)->needsSLIL())
+            RPTarget = BestSchedule->GetSpillCost();
+          BuildLocalSearchProfile_(BestSchedule, Prof, State);
+          PassImproved = true;
+          break;
+        }
+        ReleaseSchedule_(Cand);
+      }
+    }
+    Improved |= PassImproved;
+    if (!PassImproved)
+      break;
+  }
+  if (Improved) {
+    stats::acoLocalSearchImprovements++;
+    Logger::Info("ACO local search improved the best schedule to cost %d "
+                 "in %d passes", BestSchedule->GetCost(), PassCnt);
+  }
+  return Improved;
 }
 
 // Reduce to only index of best schedule per 2 blocks in output array
@@ -1262,6 +2125,8 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out,
                                        SchedRegion *region,
 				       ACOScheduler *dev_AcoSchdulr) {
   rgn_ = region;
+  deadline_ = timeout_ > 0 ? Utilities::GetProcessorTime() + timeout_ : 0;
+  timedOut_ = false;
 
   // get settings
   Config &schedIni = SchedulerOptions::getInstance();
@@ -1292,13 +2157,83 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out,
   // compute the relative maximum score inverse
   ScRelMax = rgn_->GetHeuristicCost();
 
+  // The colonies of an island model set up concurrently, but compressing
+  // the pheromone table and building the DDG image walk iterators that are
+  // stored in the DDG
+  std::unique_lock<std::mutex> SetupLock;
+  if (islands_)
+    SetupLock = std::unique_lock<std::mutex>(islands_->GetSetupMutex());
+
   // initialize pheromone
   // for this, we need the cost of the pure heuristic schedule
   int pheromone_size = (count_ + 1) * count_;
-  for (int i = 0; i < pheromone_size; i++)
-    pheromone_[i] = 1;
+  if (useSparsePher_) {
+    // Fall back to the dense table if compressing it would not halve it.
+    if (sparsePher_.Construct(dataDepGraph_, pheromone_size / 2)) {
+      Logger::Info("Storing %lu of %d pheromone entries",
+                   (unsigned long)sparsePher_.GetEntryCnt(), pheromone_size);
+    } else {
+      Logger::Info("Pheromone table is too dense to compress");
+      useSparsePher_ = false;
+      pheromone_.resize(pheromone_size);
+    }
+  }
+  pherScale_ = 1;
+  if (useSparsePher_)
+    sparsePher_.Fill(1);
+  else
+    for (int i = 0; i < pheromone_size; i++)
+      pheromone_[i] = 1;
   initialValue_ = 1;
+  CmputPherRowMax_();
   InstCount MaxRPTarget = std::numeric_limits<InstCount>::max();
+
+  // set up the host ants. The heuristic schedule is always built on the
+  // host, even when the remaining ants run on the device.
+  // The emulated Dev_ACO grid uses both priorities in the second pass, like
+  // the kernel
+  if (devAcoOnHost_ && rgn_->IsSecondPass() && !kHelper2) {
+    kHelper2 = new KeysHelper2(priorities1_, priorities2_);
+    kHelper2->initForRegion(dataDepGraph_);
+  }
+  HeurType MaxPriority = kHelper1->getMaxValue();
+  HeurType MaxPriority2 = 1;
+  if (devAcoOnHost_ && kHelper2) {
+    MaxPriority = kHelper2->getMaxValue(1);
+    MaxPriority2 = kHelper2->getMaxValue(2);
+  }
+  if (MaxPriority == 0)
+    MaxPriority = 1; // divide by 0 is bad
+  if (MaxPriority2 == 0)
+    MaxPriority2 = 1; // divide by 0 is bad
+  MaxPriorityInv = 1 / (pheromone_t)MaxPriority;
+  MaxPriorityInv2 = 1 / (pheromone_t)MaxPriority2;
+  ddgBlob_.Build(dataDepGraph_);
+  if (pherCacheEn_) {
+    // The passes and the spill cost functions have different objectives, so
+    // they do not warm start each other.
+    pherCacheKey_ = RandomGen::MixKey(ddgBlob_.GetHash(), rgn_->IsSecondPass());
+    pherCacheKey_ = RandomGen::MixKey(pherCacheKey_, rgn_->GetSpillCostFunc());
+  }
+  if (SetupLock.owns_lock())
+    SetupLock.unlock();
+  bool HostACO = !use_dev_ACO || count_ < REGION_MIN_SIZE;
+  int AntStateCnt =
+      HostACO ? std::min(hostThreadCnt_, std::max(numThreads_, 1)) : 1;
+  ACOContext &Ctx = ACOContext::getInstance();
+  antStates_ = Ctx.GetAntStates(dataDepGraph_, machMdl_, AntStateCnt);
+  // Pipelined iterations run the ants in the background even on one thread
+  if (HostACO && (AntStateCnt > 1 || pherStaleness_ > 0) && !hostThreadPool_)
+    hostThreadPool_ = Ctx.GetThreadPool(AntStateCnt);
+  randSeed_ = (uint32_t)RandomGen::GetSeed();
+  randRgnKey_ = ((uint64_t)rgn_->GetRgnNum() << 1) | rgn_->IsSecondPass();
+  // Every colony draws its own random streams
+  if (islandIndx_ > 0)
+    randRgnKey_ = RandomGen::MixKey(randRgnKey_, islandIndx_);
+  antStates_[0]->SetRandKey(randSeed_, randRgnKey_, 0, 0);
+  hostIterBestCost_ = std::numeric_limits<InstCount>::max();
+  schedAllocCnt_ = 0;
+  seenScheds_.clear();
   InstSchedule *heuristicSched = FindOneSchedule(MaxRPTarget);
   InstCount heuristicCost =
       heuristicSched->GetCost() + 1; // prevent divide by zero
@@ -1310,9 +2245,18 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out,
 #else
   initialValue_ = (double)numThreads_ / heuristicCost;
 #endif
-  for (int i = 0; i < pheromone_size; i++)
-    pheromone_[i] = initialValue_;
+  pherScale_ = 1;
+  if (useSparsePher_)
+    sparsePher_.Fill(initialValue_);
+  else
+    for (int i = 0; i < pheromone_size; i++)
+      pheromone_[i] = initialValue_;
+  CmputPherRowMax_();
   std::cerr << "initialValue_" << initialValue_ << std::endl;
+  if (pherCacheEn_ && LoadCachedPheromone_()) {
+    stats::acoPheromoneCacheHits++;
+    Logger::Info("Starting ACO from the cached pheromone table");
+  }
   InstSchedule *bestSchedule = InitialSchedule;
 
   // check if heuristic schedule is better than the initial
@@ -1324,6 +2268,7 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out,
   }
   else {
     bestSchedule = std::move(InitialSchedule);
+    ReleaseSchedule_(heuristicSched);
     printf("Initial schedule is better\n");
   }
   if (bestSchedule) {
@@ -1447,70 +2392,97 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out,
     hipFree(dev_schedules);
 
   } else { // Run ACO on cpu
-    Logger::Info("Running host ACO with %d ants per iteration", numThreads_);
+    Logger::Info("Running host ACO with %d ants per iteration on %d threads "
+                 "(random seed %u, region key %llu)",
+                 numThreads_, (int)antStates_.size(), (unsigned)randSeed_,
+                 (unsigned long long)randRgnKey_);
     InstCount RPTarget;
     if (!((BBWithSpill *)rgn_)->needsSLIL())
       RPTarget = bestSchedule->GetSpillCost();
     else
       RPTarget = MaxRPTarget;
-    #ifdef CHECK_DIFFERENT_SCHEDULES
-      std::unordered_map<string, int> schedMap;
-      int diffSchedCount = 0;
-    #endif
-    while (noImprovement < noImprovementMax) {
+    HostAntBatch Batches[2];
+    // The batch of the next iteration if its ants are already running
+    HostAntBatch *Running = nullptr;
+    // While the next iteration's ants run, the deposit of the current one
+    // and the stall target it sets are held back until those ants are done
+    InstSchedule *PendingDeposit = nullptr;
+    bool ReleasePendingDeposit = false;
+    int PendingBestStalls = -1;
+    while (noImprovement < noImprovementMax && !TimedOut_()) {
       iterations++;
       iterationBest = nullptr;
+      HostAntBatch &Batch = Batches[iterations % 2];
+      if (!Running)
+        StartHostAnts_(RPTarget, iterations, Batch);
+      FinishHostAnts_(Batch);
+      Running = nullptr;
+      if (PendingDeposit) {
+        UpdatePheromone(PendingDeposit, false);
+        if (ReleasePendingDeposit)
+          ReleaseSchedule_(PendingDeposit);
+        PendingDeposit = nullptr;
+        ReleasePendingDeposit = false;
+      }
+      if (PendingBestStalls >= 0) {
+        SetGlobalBestStalls(PendingBestStalls);
+        PendingBestStalls = -1;
+      }
+      // Start the next iteration before merging this one, unless this may
+      // be the last iteration
+      if (pherStaleness_ > 0 && noImprovement + 1 < noImprovementMax &&
+          !TimedOut_()) {
+        Running = &Batches[(iterations + 1) % 2];
+        StartHostAnts_(RPTarget, iterations + 1, *Running);
+      }
+      // merge in ant order so the iteration best does not depend on the
+      // number of host threads
       for (int i = 0; i < numThreads_; i++) {
-        InstSchedule *schedule = FindOneSchedule(RPTarget);
-
-        #ifdef CHECK_DIFFERENT_SCHEDULES
-          // check if schedule is in Map
-          InstCount instNum, cycleNum, slotNum;
-          // get first instruction in string
-          instNum = schedule->GetFrstInst(cycleNum, slotNum);
-          std::string schedString = std::to_string(instNum);
-          // prepare next instruction in comma separated list
-          instNum = schedule->GetNxtInst(cycleNum, slotNum);
-          while (instNum != INVALID_VALUE) {
-            schedString.append(",");
-            schedString.append(std::to_string(instNum));
-            instNum = schedule->GetNxtInst(cycleNum, slotNum);
-          }
-          schedule->ResetInstIter();
-          if (schedMap.find(schedString) == schedMap.end()) {
-            schedMap[schedString] = 1;
-            diffSchedCount++;
-          }
-          else {
-            schedMap[schedString] = schedMap[schedString] + 1;
-          }
-        #endif
+        InstSchedule *schedule = Batch.Scheds[i];
+        if (!schedule) {
+          // keep track of ants terminated and of ants never run
+          if (Batch.Started[i])
+            numAntsTerminated_++;
+          else
+            numAntsTimedOut_++;
+          continue;
+        }
 
         if (print_aco_trace)
           PrintSchedule(schedule);
+        // the device reduction below picks the iteration best instead
+        if (devAcoOnHost_)
+          continue;
         if (shouldReplaceSchedule(iterationBest, schedule, false, RPTarget)) {
-          if (iterationBest)
-            delete iterationBest;          
+          ReleaseSchedule_(iterationBest);
           iterationBest = schedule;
         } else {
-            if (schedule)
-              delete schedule;
+          ReleaseSchedule_(schedule);
         }
       }
+      if (devAcoOnHost_)
+        iterationBest = ReduceLikeDevice_(Batch.Scheds, RPTarget);
 #if !USE_ACS
-      if (iterationBest)
+      if (iterationBest && Running)
+        PendingDeposit = iterationBest;
+      else if (iterationBest)
         UpdatePheromone(iterationBest, false);
 #endif
       if (shouldReplaceSchedule(bestSchedule, iterationBest, true, RPTarget)) {
-        if (bestSchedule && bestSchedule != InitialSchedule)
-          delete bestSchedule;
+        if (bestSchedule != InitialSchedule)
+          ReleaseSchedule_(bestSchedule);
         bestSchedule = std::move(iterationBest);
         if (!((BBWithSpill *)rgn_)->needsSLIL())
           RPTarget = bestSchedule->GetSpillCost();
 
         int globalStalls = bestSchedule->getTotalStalls();
-        if (globalStalls < GetGlobalBestStalls())
-          SetGlobalBestStalls(bestSchedule->GetCrntLngth() - dataDepGraph_->GetInstCnt());
+        if (globalStalls < GetGlobalBestStalls()) {
+          int BestStalls = bestSchedule->GetCrntLngth() - dataDepGraph_->GetInstCnt();
+          if (Running)
+            PendingBestStalls = BestStalls;
+          else
+            SetGlobalBestStalls(BestStalls);
+        }
         printf("ACO found schedule "
                "cost:%d, rp cost:%d, exec cost: %d, and "
                "iteration:%d"
@@ -1528,21 +2500,52 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out,
           noImprovement++;
 #endif
         if (bestSchedule && ( IsFirst && (bestSchedule->GetNormSpillCost() == 0 ||
-        ((BBWithSpill *)rgn_)->ReturnPeakSpillCost() == 0) ||
+        bestSchedule->getIsZeroPerp()) ||
         ( !IsFirst && bestSchedule->GetExecCost() == 0 ) ) )
           break;
       } else {
-        delete iterationBest;
+        if (iterationBest && iterationBest == PendingDeposit)
+          ReleasePendingDeposit = true;
+        else
+          ReleaseSchedule_(iterationBest);
         noImprovement++;
       }
 #if USE_ACS
       UpdatePheromone(bestSchedule, false);
 #endif
+      if (islands_ && iterations % islands_->GetMigrationInterval() == 0 &&
+          Migrate_(bestSchedule, RPTarget))
+        noImprovement = 0;
     }
-    Logger::Info("%d ants terminated early", numAntsTerminated_);
-    #ifdef CHECK_DIFFERENT_SCHEDULES
-    Logger::Info("%d different schedules for %d total ants", diffSchedCount, (iterations + 1) * numThreads_ - numAntsTerminated_);
-    #endif
+    if (islands_)
+      islands_->Leave(islandIndx_, bestSchedule);
+    // Discard the ants started for an iteration that did not happen
+    if (Running) {
+      FinishHostAnts_(*Running);
+      for (InstSchedule *Sched : Running->Scheds)
+        if (Sched)
+          ReleaseSchedule_(Sched);
+    }
+    if (PendingDeposit && ReleasePendingDeposit)
+      ReleaseSchedule_(PendingDeposit);
+    if (localSearchPasses_ > 0 && !TimedOut_())
+      LocalSearch_(bestSchedule, RPTarget);
+    if (pherCacheEn_)
+      StoreCachedPheromone_();
+    int AntsCutOff = 0;
+    for (auto &State : antStates_)
+      AntsCutOff += State->antsCutOff;
+    Logger::Info("%d ants terminated early, %d of them by the iteration best",
+                 numAntsTerminated_, AntsCutOff);
+    if (numAntsTimedOut_ > 0)
+      Logger::Info("%d ants not run because ACO timed out", numAntsTimedOut_);
+    stats::acoTimedOutAnts += numAntsTimedOut_;
+    int DuplicateAnts = 0;
+    for (auto &State : antStates_)
+      DuplicateAnts += State->duplicateAnts;
+    stats::acoDuplicateAnts += DuplicateAnts;
+    Logger::Info("%d different schedules, %d ants rebuilt one of them",
+                 (int)seenScheds_.size(), DuplicateAnts);
   } // End run on CPU
 
   printf("Best schedule: ");
@@ -1550,10 +2553,16 @@ FUNC_RESULT ACOScheduler::FindSchedule(InstSchedule *schedule_out,
   PrintSchedule(bestSchedule);
   schedule_out->Copy(bestSchedule);
   if (bestSchedule != InitialSchedule)
-    delete bestSchedule;
+    ReleaseSchedule_(bestSchedule);
+  stats::acoScheduleAllocations.Record(schedAllocCnt_);
+  Logger::Info("ACO allocated %d schedules", schedAllocCnt_);
   if (!use_dev_ACO || count_ < REGION_MIN_SIZE)
     printf("ACO finished after %d iterations\n", iterations);
 
+  if (timedOut_) {
+    Logger::Info("ACO timed out after %d iterations", iterations);
+    return RES_TIMEOUT;
+  }
   return RES_SUCCESS;
 }
 __device__
@@ -1604,7 +2613,7 @@ void ACOScheduler::UpdatePheromone(InstSchedule *schedule, bool isIterationBest)
     // if instNum == count_ - 2 it has the root inst and lastInstNum = -1
     lastInstNum = schedule->GetPrevInstNum(instNum);
     // Get corresponding pheromone and update it
-    pheromone = &Pheromone(lastInstNum, instNum);
+    pheromone = PheromonePtr(lastInstNum, instNum);
     atomicAdd(pheromone, deposition);
 #if (PHER_UPDATE_SCHEME == ONE_PER_ITER)
     // parallel on global level
@@ -1632,15 +2641,17 @@ void ACOScheduler::UpdatePheromone(InstSchedule *schedule, bool isIterationBest)
   while (instNum != INVALID_VALUE) {  
     SchedInstruction *inst = dataDepGraph_->GetInstByIndx(instNum);
 
-    pheromone = &Pheromone(lastInst, inst);
+    pheromone = PheromonePtr(lastInst, inst);
 #if USE_ACS
     // ACS update rule includes decay
     // only the arcs on the current solution are decayed
     *pheromone = (1 - decay_factor) * *pheromone +
-                 decay_factor / (schedule->GetCost() + 1);
+                 decay_factor / (schedule->GetCost() + 1) / pherScale_;
 #else
-    *pheromone = *pheromone + deposition;
+    *pheromone = *pheromone + deposition / pherScale_;
 #endif
+    pheromone_t &RowMax = pherRowMax_[lastInst ? lastInst->GetNum() + 1 : 0];
+    RowMax = std::max(RowMax, *pheromone);
     lastInst = inst;
 
     instNum = schedule->GetNxtInst(cycleNum, slotNum);
@@ -1649,12 +2660,9 @@ void ACOScheduler::UpdatePheromone(InstSchedule *schedule, bool isIterationBest)
 
 #if !USE_ACS
   // decay pheromone
-  for (int i = 0; i < count_; i++) {
-    for (int j = 0; j < count_; j++) {
-      pheromone = &Pheromone(i, j);
-      *pheromone *= (1 - decay_factor);
-    }
-  }
+  pherScale_ *= (1 - decay_factor);
+  if (pherScale_ < MIN_PHEROMONE_SCALE)
+    NormalizePheromone_();
 #endif
   if (print_aco_trace)
     PrintPheromone();
@@ -1673,7 +2681,7 @@ void ACOScheduler::ScalePheromoneTable() {
   while (instNum < count_) {
     // decay pheromone for all trails leading to instNum
     for (int j = 0; j < count_; j++) {
-      pheromone = &Pheromone(j, instNum);
+      pheromone = PheromonePtr(j, instNum);
       *pheromone *= (1 - decay_factor);
       // clamp pheromone values to be between 1 and 8
       *pheromone = dmax(1, dmin(8, *pheromone));
@@ -1691,7 +2699,7 @@ void ACOScheduler::ScalePheromoneTable() {
     // restrict pheromone for all trails leading to instNum
     // to be within range
     for (int j = 0; j < count_; j++) {
-      pheromone = &Pheromone(j, instNum);
+      pheromone = PheromonePtr(j, instNum);
       *pheromone = *pheromone + scalingAdjustment;
       *pheromone = dmax(1, dmin(8, *pheromone));
     }
@@ -1707,10 +2715,33 @@ void ACOScheduler::ScalePheromoneTable() {
   pheromone_t *pheromone;
   pheromone_t totalPherInTable;
   totalPherInTable = 0;
+  // the clamping below is not linear, so it needs the actual values
+  NormalizePheromone_();
+  if (useSparsePher_) {
+    // Pairs that are not stored can never be used, so the average is taken
+    // over the stored pairs only.
+    size_t bgn = sparsePher_.GetRowBgn(0), end = sparsePher_.GetEntryCnt();
+    for (size_t i = bgn; i < end; i++) {
+      pheromone = &sparsePher_.GetEntry(i);
+      *pheromone *= (1 - decay_factor);
+      *pheromone = fmax(1, fmin(8, *pheromone));
+      totalPherInTable += *pheromone;
+    }
+    pheromone_t scalingAdjustment =
+        4.5 - totalPherInTable / std::max<size_t>(end - bgn, 1);
+    for (size_t i = bgn; i < end; i++) {
+      pheromone = &sparsePher_.GetEntry(i);
+      *pheromone = fmax(1, fmin(8, *pheromone + scalingAdjustment));
+    }
+    CmputPherRowMax_();
+    if (print_aco_trace)
+      PrintPheromone();
+    return;
+  }
   // clamp pheromone to range
   for (int i = 0; i < count_; i++) {
     for (int j = 0; j < count_; j++) {
-      pheromone = &Pheromone(i, j);
+      pheromone = PheromonePtr(i, j);
       *pheromone *= (1 - decay_factor);
       *pheromone = fmax(1, fmin(8, *pheromone));
       totalPherInTable += *pheromone;
@@ -1721,7 +2752,7 @@ void ACOScheduler::ScalePheromoneTable() {
   pheromone_t scalingAdjustment = 4.5 - totalPherInTable / (count_ * count_);
   for (int i = 0; i < count_; i++) {
     for (int j = 0; j < count_; j++) {
-      pheromone = &Pheromone(i, j);
+      pheromone = PheromonePtr(i, j);
       *pheromone = *pheromone + scalingAdjustment;
       *pheromone = fmax(1, fmin(8, *pheromone));
     }
@@ -1732,7 +2763,7 @@ void ACOScheduler::ScalePheromoneTable() {
 }
 
 __device__
-void ACOScheduler::CopyPheromonesToSharedMem(double *s_pheromone) {
+void ACOScheduler::CopyPheromonesToSharedMem(pheromone_t *s_pheromone) {
   InstCount toInstNum = hipThreadIdx_x;
   while (toInstNum < count_) {
     for (int fromInstNum = -1; fromInstNum < count_; fromInstNum++)
@@ -1742,11 +2773,10 @@ void ACOScheduler::CopyPheromonesToSharedMem(double *s_pheromone) {
   }
 }
 
-__host__ __device__
+__device__
 inline void ACOScheduler::UpdateACOReadyList(SchedInstruction *inst, bool IsSecondPass) {
   InstCount prdcsrNum, scsrRdyCycle;
   
-  #ifdef __HIP_DEVICE_COMPILE__ // device version of function
     // Notify each successor of this instruction that it has been scheduled.
     #ifdef DEBUG_INSTR_SELECTION
     if (GLOBALTID==0) {
@@ -1759,15 +2789,17 @@ inline void ACOScheduler::UpdateACOReadyList(SchedInstruction *inst, bool IsSeco
       }
     #endif
     int i = 0;
-    for (SchedInstruction *crntScsr = GetScsr(inst, i++, &prdcsrNum);
-          crntScsr != NULL; crntScsr = GetScsr(inst, i++, &prdcsrNum)) {
+    UDT_GLABEL ltncy;
+    for (SchedInstruction *crntScsr = GetScsr(inst, i++, &prdcsrNum, &ltncy);
+          crntScsr != NULL;
+          crntScsr = GetScsr(inst, i++, &prdcsrNum, &ltncy)) {
         #ifdef DEBUG_INSTR_SELECTION
         if (GLOBALTID==0) {
           printf(" %d,", crntScsr->GetNum());
         }
         #endif
         bool wasLastPrdcsr =
-            crntScsr->PrdcsrSchduld(prdcsrNum, dev_crntCycleNum_[GLOBALTID], scsrRdyCycle, dev_DDG_->ltncyPerPrdcsr_);
+            crntScsr->PrdcsrSchduld(prdcsrNum, dev_crntCycleNum_[GLOBALTID], scsrRdyCycle, ltncy);
 
         if (wasLastPrdcsr) {
           // If all other predecessors of this successor have been scheduled then
@@ -1816,49 +2848,6 @@ inline void ACOScheduler::UpdateACOReadyList(SchedInstruction *inst, bool IsSeco
         }
       }
     }
-  #else // host version of function
-    // Notify each successor of this instruction that it has been scheduled.
-    for (SchedInstruction *crntScsr = inst->GetFrstScsr(&prdcsrNum);
-          crntScsr != NULL; crntScsr = inst->GetNxtScsr(&prdcsrNum)) {
-        bool wasLastPrdcsr =
-            crntScsr->PrdcsrSchduld(prdcsrNum, crntCycleNum_, scsrRdyCycle);
-
-        if (wasLastPrdcsr) {
-          // If all other predecessors of this successor have been scheduled then
-          // we now know in which cycle this successor will become ready.
-          HeurType HeurWOLuc = kHelper1->computeKey(crntScsr, false, dataDepGraph_->RegFiles);
-          readyLs->addInstructionToReadyList(ACOReadyListEntry{crntScsr->GetNum(), scsrRdyCycle, HeurWOLuc, 0});
-        }
-    }
-
-    // Make sure the scores are valid.  The scheduling of an instruction may
-    // have increased another instruction's LUC Score
-    PriorityEntry LUCEntry = kHelper1->getPriorityEntry(LSH_LUC);
-    RP0OrPositiveCount = 0;
-    for (InstCount I = 0; I < readyLs->getReadyListSize(); ++I) {
-      //we first get the heuristic without the LUC component, add the LUC
-      //LUC component, and then compute the score
-      HeurType Heur = *readyLs->getInstHeuristicAtIndex(I);
-      InstCount CandidateId = *readyLs->getInstIdAtIndex(I);
-      if (LUCEntry.Width) {
-        SchedInstruction *ScsrInst = dataDepGraph_->GetInstByIndx(CandidateId);
-        HeurType LUCVal = ScsrInst->CmputLastUseCnt(dataDepGraph_->RegFiles);
-        LUCVal <<= LUCEntry.Offset;
-        Heur &= LUCVal;
-      }
-      if (RP0OrPositiveCount) {
-        if (*dev_readyLs->getInstReadyOnAtIndex(I) > crntCycleNum_)
-          continue;
-
-        SchedInstruction *candidateInst = dataDepGraph_->GetInstByIndx(CandidateId);
-        HeurType candidateLUC = candidateInst->GetLastUseCnt();
-        int16_t candidateDefs = candidateInst->GetDefCnt();
-        if (candidateDefs <= candidateLUC) {
-          RP0OrPositiveCount = RP0OrPositiveCount + 1;
-        }
-      }
-    }
-  #endif
 }
 
 // copied from Enumerator
@@ -1870,6 +2859,24 @@ inline void ACOScheduler::UpdtRdyLst_(InstCount cycleNum, int slotNum) {
 __host__ __device__
 void ACOScheduler::PrintPheromone() {
   printf("Pher: ");
+#ifndef __HIP_DEVICE_COMPILE__
+  NormalizePheromone_();
+  if (useSparsePher_) {
+    // pairs that can never be adjacent are printed as "-"
+    for (int i = 0; i < count_; i++) {
+      for (int j = 0; j < count_; j++) {
+        pheromone_t *pheromone = sparsePher_.Find(i, j);
+        if (pheromone)
+          printf("%.1f ", *pheromone);
+        else
+          printf("- ");
+      }
+      printf("\n");
+    }
+    printf("\n");
+    return;
+  }
+#endif
   for (int i = 0; i < count_; i++) {
     for (int j = 0; j < count_; j++) {
       //std::cerr << std::scientific << std::setprecision(8) << Pheromone(i, j)
@@ -1963,6 +2970,7 @@ void ACOScheduler::AllocDevArraysForParallelACO() {
 
 void ACOScheduler::CopyPheromonesToDevice(ACOScheduler *dev_AcoSchdulr) {
   size_t memSize;
+  NormalizePheromone_();
   // Free allocated mem sinve pheromone size can change
   if (dev_AcoSchdulr->dev_pheromone_elmnts_alloced_ == true)
     hipFree(dev_AcoSchdulr->pheromone_.elmnts_);
@@ -0,0 +1,151 @@
+#include "opt-sched/Scheduler/aco_context.h"
+#include "opt-sched/Scheduler/ant_state.h"
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/dev_defines.h"
+#include "llvm/Support/ThreadPool.h"
+#include <hip/hip_runtime.h>
+#include <algorithm>
+
+using namespace llvm::opt_sched;
+
+ACOContext &ACOContext::getInstance() {
+  static thread_local ACOContext instance;
+  return instance;
+}
+
+// Replaces pool by one of threadCnt threads unless it already has as many.
+static ThreadPool *GetPool(std::unique_ptr<ThreadPool> &pool,
+                           unsigned &poolThreadCnt, unsigned threadCnt) {
+  if (!pool || threadCnt > poolThreadCnt) {
+    pool.reset();
+    pool = std::make_unique<ThreadPool>(llvm::hardware_concurrency(threadCnt));
+    poolThreadCnt = threadCnt;
+  }
+  return pool.get();
+}
+
+ACOContext::ACOContext() : threadCnt_(0), islandThreadCnt_(0) {
+  for (int i = 0; i < DB_CNT; i++) {
+    devBuffers_[i] = NULL;
+    devBufferSizes_[i] = 0;
+  }
+}
+
+ACOContext::~ACOContext() {
+  // Wait for the colonies and the host ants before their states go away
+  islandPool_.reset();
+  threadPool_.reset();
+  for (InstSchedule *sched : freeScheds_)
+    delete sched;
+}
+
+std::vector<AntState *> ACOContext::GetAntStates(DataDepGraph *dataDepGraph,
+                                                 MachineModel *machMdl,
+                                                 int cnt) {
+  std::vector<AntState *> states;
+  for (int i = 0; i < cnt; i++) {
+    if (i < (int)antStates_.size())
+      antStates_[i]->Prepare(dataDepGraph, machMdl);
+    else
+      antStates_.push_back(std::make_unique<AntState>(dataDepGraph, machMdl));
+    states.push_back(antStates_[i].get());
+  }
+  return states;
+}
+
+ThreadPool *ACOContext::GetThreadPool(unsigned threadCnt) {
+  return GetPool(threadPool_, threadCnt_, threadCnt);
+}
+
+ThreadPool *ACOContext::GetIslandThreadPool(unsigned threadCnt) {
+  return GetPool(islandPool_, islandThreadCnt_, threadCnt);
+}
+
+InstSchedule *ACOContext::AcquireSchedule(MachineModel *machMdl,
+                                          DataDepGraph *dataDepGraph,
+                                          bool &allocated) {
+  allocated = freeScheds_.empty();
+  if (allocated)
+    return new InstSchedule(machMdl, dataDepGraph, true);
+  InstSchedule *sched = freeScheds_.back();
+  freeScheds_.pop_back();
+  sched->Reinit(machMdl, dataDepGraph);
+  return sched;
+}
+
+void ACOContext::ReleaseSchedules(std::vector<InstSchedule *> &scheds) {
+  freeScheds_.insert(freeScheds_.end(), scheds.begin(), scheds.end());
+  scheds.clear();
+}
+
+void *ACOContext::GetDevBuffer(DEV_BUFFER buf, size_t size) {
+  if (size > devBufferSizes_[buf]) {
+    if (devBuffers_[buf])
+      hipFree(devBuffers_[buf]);
+    // The random states are only touched by the device
+    if (buf == DB_RAND_STATES) {
+      gpuErrchk(hipMalloc(&devBuffers_[buf], size));
+    } else {
+      gpuErrchk(hipMallocManaged(&devBuffers_[buf], size));
+    }
+    devBufferSizes_[buf] = size;
+  }
+  return devBuffers_[buf];
+}
+
+void *ACOContext::AllocDevArray(size_t size, bool managed) {
+  // Keep every array aligned for any element type
+  const size_t ALIGNMENT = 256;
+  size = (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+  DevArena &arena = devArenas_[managed];
+  if (arena.blocks.empty() || arena.blockUsed + size > arena.blockSize) {
+    // Size the block for the rest of the largest run seen
+    size_t blockSize = std::max(size, arena.maxUsed > arena.used
+                                          ? arena.maxUsed - arena.used
+                                          : (size_t)0);
+    void *block;
+    if (managed) {
+      gpuErrchk(hipMallocManaged(&block, blockSize));
+    } else {
+      gpuErrchk(hipMalloc(&block, blockSize));
+    }
+    arena.blocks.push_back(block);
+    arena.blockSize = blockSize;
+    arena.blockUsed = 0;
+  }
+  void *array = (char *)arena.blocks.back() + arena.blockUsed;
+  arena.blockUsed += size;
+  arena.used += size;
+  return array;
+}
+
+void ACOContext::ResetDevArrays() {
+  for (DevArena &arena : devArenas_) {
+    arena.maxUsed = std::max(arena.maxUsed, arena.used);
+    arena.used = 0;
+    arena.blockUsed = 0;
+    // A single block always fits the largest run, several are merged
+    if (arena.blocks.size() > 1) {
+      size_t maxUsed = arena.maxUsed;
+      FreeDevArena_(arena);
+      arena.maxUsed = maxUsed;
+    }
+  }
+}
+
+void ACOContext::FreeDevArena_(DevArena &arena) {
+  for (void *block : arena.blocks)
+    hipFree(block);
+  arena = DevArena();
+}
+
+void ACOContext::FreeDevBuffers() {
+  for (int i = 0; i < DB_CNT; i++) {
+    if (devBuffers_[i])
+      hipFree(devBuffers_[i]);
+    devBuffers_[i] = NULL;
+    devBufferSizes_[i] = 0;
+  }
+  for (DevArena &arena : devArenas_)
+    FreeDevArena_(arena);
+}
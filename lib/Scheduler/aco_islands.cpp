@@ -0,0 +1,55 @@
+#include "opt-sched/Scheduler/aco_islands.h"
+#include "opt-sched/Scheduler/data_dep.h"
+
+using namespace llvm::opt_sched;
+
+ACOIslands::ACOIslands(int islandCnt, int migrationInterval,
+                       MachineModel *machMdl, DataDepGraph *dataDepGraph)
+    : islandCnt_(islandCnt), migrationInterval_(migrationInterval),
+      activeCnt_(islandCnt), arrivedCnt_(0), generation_(0),
+      leftGen_(islandCnt, -1) {
+  for (int i = 0; i < islandCnt; i++) {
+    published_[0].push_back(
+        std::make_unique<InstSchedule>(machMdl, dataDepGraph, true));
+    published_[1].push_back(
+        std::make_unique<InstSchedule>(machMdl, dataDepGraph, true));
+    final_.push_back(
+        std::make_unique<InstSchedule>(machMdl, dataDepGraph, true));
+  }
+}
+
+ACOIslands::~ACOIslands() {}
+
+void ACOIslands::Migrate(int island, InstSchedule *best,
+                         InstSchedule *immigrant) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  int gen = generation_;
+  published_[gen % 2][island]->Copy(best);
+  if (++arrivedCnt_ == activeCnt_)
+    Complete_();
+  else
+    migrated_.wait(lock, [&] { return generation_ != gen; });
+
+  int next = (island + 1) % islandCnt_;
+  if (leftGen_[next] >= 0 && leftGen_[next] <= gen)
+    immigrant->Copy(final_[next].get());
+  else
+    immigrant->Copy(published_[gen % 2][next].get());
+}
+
+void ACOIslands::Leave(int island, InstSchedule *best) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  final_[island]->Copy(best);
+  leftGen_[island] = generation_;
+  activeCnt_--;
+  // The islands waiting in the current migration may only have been
+  // waiting for this one
+  if (arrivedCnt_ > 0 && arrivedCnt_ == activeCnt_)
+    Complete_();
+}
+
+void ACOIslands::Complete_() {
+  arrivedCnt_ = 0;
+  generation_++;
+  migrated_.notify_all();
+}
@@ -0,0 +1,137 @@
+#include "opt-sched/Scheduler/ant_state.h"
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/machine_model.h"
+#include "opt-sched/Scheduler/random.h"
+#include "opt-sched/Scheduler/register.h"
+
+using namespace llvm::opt_sched;
+
+AntState::AntState(DataDepGraph *dataDepGraph, MachineModel *machMdl)
+    : avlblSlotsInCrntCycle(nullptr), rsrvSlots(nullptr),
+      unschduldPrdcsrCnt(nullptr), minRdyCycle(nullptr), lastUseCnt(nullptr),
+      regOffsets(nullptr), crntUseCnt(nullptr), liveRegs(nullptr),
+      livePhysRegs(nullptr), peakRegPressures(nullptr),
+      sumOfLiveIntervalLengths(nullptr), spillCosts(nullptr), issuTypeCap_(0),
+      issuRateCap_(0), instCap_(0), regTypeCap_(0), regCap_(0),
+      readyLsSize_(-1) {
+  Prepare(dataDepGraph, machMdl);
+}
+
+AntState::~AntState() {
+  delete[] avlblSlotsInCrntCycle;
+  delete[] rsrvSlots;
+  delete[] unschduldPrdcsrCnt;
+  delete[] minRdyCycle;
+  delete[] lastUseCnt;
+  delete[] regOffsets;
+  delete[] crntUseCnt;
+  delete[] liveRegs;
+  delete[] livePhysRegs;
+  delete[] peakRegPressures;
+  delete[] sumOfLiveIntervalLengths;
+  delete[] spillCosts;
+}
+
+void AntState::Prepare(DataDepGraph *dataDepGraph, MachineModel *machMdl) {
+  InstCount instCnt = dataDepGraph->GetInstCnt();
+  int16_t issuTypeCnt = machMdl->GetIssueTypeCnt();
+  int issuRate = machMdl->GetIssueRate();
+  int16_t regTypeCnt = machMdl->GetRegTypeCnt();
+  RegisterFile *regFiles = dataDepGraph->getRegFiles();
+
+  if (issuTypeCnt > issuTypeCap_) {
+    delete[] avlblSlotsInCrntCycle;
+    avlblSlotsInCrntCycle = new int16_t[issuTypeCnt];
+    issuTypeCap_ = issuTypeCnt;
+  }
+  if (issuRate > issuRateCap_) {
+    delete[] rsrvSlots;
+    rsrvSlots = new ReserveSlot[issuRate];
+    issuRateCap_ = issuRate;
+  }
+
+  if (instCnt > instCap_) {
+    delete[] unschduldPrdcsrCnt;
+    delete[] minRdyCycle;
+    delete[] lastUseCnt;
+    delete[] spillCosts;
+    unschduldPrdcsrCnt = new InstCount[instCnt];
+    minRdyCycle = new InstCount[instCnt];
+    lastUseCnt = new int16_t[instCnt];
+    spillCosts = new InstCount[instCnt];
+    instCap_ = instCnt;
+  }
+
+  if (regTypeCnt > regTypeCap_) {
+    delete[] regOffsets;
+    delete[] liveRegs;
+    delete[] livePhysRegs;
+    delete[] peakRegPressures;
+    delete[] sumOfLiveIntervalLengths;
+    regOffsets = new int[regTypeCnt];
+    liveRegs = new WeightedBitVector[regTypeCnt];
+    livePhysRegs = new WeightedBitVector[regTypeCnt];
+    peakRegPressures = new InstCount[regTypeCnt];
+    sumOfLiveIntervalLengths = new int[regTypeCnt];
+    regTypeCap_ = regTypeCnt;
+  }
+  int totRegCnt = 0;
+  for (int16_t i = 0; i < regTypeCnt; i++) {
+    regOffsets[i] = totRegCnt;
+    totRegCnt += regFiles[i].GetRegCnt();
+  }
+  if (totRegCnt > regCap_) {
+    delete[] crntUseCnt;
+    crntUseCnt = new int[totRegCnt];
+    regCap_ = totRegCnt;
+  }
+
+  // The bits are cleared before every ant, so vectors of the right length
+  // are kept as they are
+  for (int16_t i = 0; i < regTypeCnt; i++) {
+    if (liveRegs[i].GetSize() != regFiles[i].GetRegCnt())
+      liveRegs[i].Construct(regFiles[i].GetRegCnt());
+    if (livePhysRegs[i].GetSize() != regFiles[i].GetPhysRegCnt())
+      livePhysRegs[i].Construct(regFiles[i].GetPhysRegCnt());
+  }
+  regPressures.resize(regTypeCnt);
+
+  InstCount readyLsSize = dataDepGraph->GetMaxIndependentInstructions();
+  if (readyLsSize != readyLsSize_) {
+    readyLs = ACOReadyList(readyLsSize);
+    readyLsSize_ = readyLsSize;
+  }
+
+  crntCycleNum = 0;
+  crntSlotNum = 0;
+  crntRealSlotNum = 0;
+  schduldInstCnt = 0;
+  isCrntCycleBlkd = false;
+  rsrvSlotCnt = 0;
+  crntStepNum = -1;
+  peakSpillCost = 0;
+  totSpillCost = 0;
+  slilSpillCost = 0;
+  crntSpillCost = 0;
+  dynamicSlilLowerBound = 0;
+  RP0OrPositiveCount = 0;
+  blockIndx = -1;
+  antsCutOff = 0;
+  duplicateAnts = 0;
+  SetRandKey(0, 0, 0, 0);
+}
+
+void AntState::SetRandKey(uint64_t seed, uint64_t region, uint64_t iteration,
+                          uint64_t ant) {
+  randKey_ = RandomGen::MixKey(
+      RandomGen::MixKey(RandomGen::MixKey(RandomGen::MixKey(0, seed), region),
+                        iteration),
+      ant);
+  randCntr_ = 0;
+}
+
+double AntState::RandDouble(double min, double max) {
+  uint64_t rand64 = RandomGen::GetCounterRand64(randKey_, randCntr_++);
+  double rand = (double)(rand64 >> 11) / (double)(1ULL << 53);
+  return (rand * (max - min)) + min;
+}
@@ -1,4 +1,6 @@
 #include "opt-sched/Scheduler/bb_spill.h"
+#include "opt-sched/Scheduler/aco_context.h"
+#include "opt-sched/Scheduler/ant_state.h"
 #include "opt-sched/Scheduler/config.h"
 #include "opt-sched/Scheduler/data_dep.h"
 #include "opt-sched/Scheduler/enumerator.h"
@@ -8,11 +10,15 @@
 #include "opt-sched/Scheduler/reg_alloc.h"
 #include "opt-sched/Scheduler/register.h"
 #include "opt-sched/Scheduler/relaxed_sched.h"
+#include "opt-sched/Scheduler/shared_hist_table.h"
 #include "opt-sched/Scheduler/stats.h"
 #include "opt-sched/Scheduler/utilities.h"
+#include "opt-sched/Scheduler/work_stealing.h"
 #include "opt-sched/Scheduler/dev_defines.h"
 #include "Wrapper/AMDGPU/OptSchedGCNTarget.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <iostream>
 #include <map>
@@ -47,7 +53,7 @@ BBWithSpill::BBWithSpill(const OptSchedTarget *OST_, DataDepGraph *dataDepGraph,
 
   crntCycleNum_ = INVALID_VALUE;
   crntSlotNum_ = INVALID_VALUE;
-  crntSpillCost_ = INVALID_VALUE;
+  rgnState_ = NULL;
 
   SchedForRPOnly_ = SchedForRPOnly;
    
@@ -62,16 +68,6 @@ BBWithSpill::BBWithSpill(const OptSchedTarget *OST_, DataDepGraph *dataDepGraph,
   MaxOccLDS_ = ((OptSchedGCNTarget *) OST)->getMaxOccLDS();
   TargetOccupancy_ = ((OptSchedGCNTarget *) OST)->getTargetOccupancy();
   regFiles_ = dataDepGraph->getRegFiles(); 
-  liveRegs_ = new WeightedBitVector[regTypeCnt_];
-  livePhysRegs_ = new WeightedBitVector[regTypeCnt_];
-  spillCosts_ = new InstCount[dataDepGraph_->GetInstCnt()];
-  peakRegPressures_ = new InstCount[regTypeCnt_];
-  regPressures_.resize(regTypeCnt_);
-  sumOfLiveIntervalLengths_ = new int[regTypeCnt_];
-
-  //initialize all values to 0
-  for (int i = 0; i < regTypeCnt_; i++)
-    sumOfLiveIntervalLengths_[i] = 0;
 
   entryInstCnt_ = 0;
   exitInstCnt_ = 0;
@@ -85,12 +81,8 @@ BBWithSpill::~BBWithSpill() {
   if (enumrtr_ != NULL) {
     delete enumrtr_;
   }
- 
-  delete[] sumOfLiveIntervalLengths_;
-  delete[] liveRegs_;
-  delete[] livePhysRegs_;
-  delete[] spillCosts_;
-  delete[] peakRegPressures_;
+
+  delete rgnState_;
 }
 
 /*****************************************************************************/
@@ -125,12 +117,8 @@ ConstrainedScheduler *BBWithSpill::AllocHeuristicScheduler_() {
 /*****************************************************************************/
 
 void BBWithSpill::SetupPhysRegs_() {
-  int physRegCnt;
-  for (int i = 0; i < regTypeCnt_; i++) {
-    physRegCnt = regFiles_[i].FindPhysRegCnt();
-    if (physRegCnt > 0)
-      livePhysRegs_[i].Construct(physRegCnt);
-  }
+  for (int i = 0; i < regTypeCnt_; i++)
+    regFiles_[i].FindPhysRegCnt();
 }
 /*****************************************************************************/
 
@@ -328,7 +316,6 @@ InstCount BBWithSpill::CmputRPCostLwrBound() {
   if (GetSpillCostFunc() == SCF_SLIL) {
     spillCostLwrBound =
         ComputeSLILStaticLowerBound(regTypeCnt_, regFiles_, dataDepGraph_);
-    dynamicSlilLowerBound_ = spillCostLwrBound;
     staticSlilLowerBound_ = spillCostLwrBound;
   }
 
@@ -394,34 +381,13 @@ void BBWithSpill::InitForCostCmputtn_() {
 #else // Host version
   crntCycleNum_ = 0;
   crntSlotNum_ = 0;
-  crntSpillCost_ = 0;
-  crntStepNum_ = -1;
-  peakSpillCost_ = 0;
-  totSpillCost_ = 0;
 
   for (i = 0; i < regTypeCnt_; i++) {
     regFiles_[i].ResetCrntUseCnts();
     regFiles_[i].ResetCrntLngths();
   }
 
-  for (i = 0; i < regTypeCnt_; i++) {
-    liveRegs_[i].Reset();
-
-    if (regFiles_[i].GetPhysRegCnt() > 0) {
-      livePhysRegs_[i].Reset();
-    }
-
-    peakRegPressures_[i] = 0;
-    regPressures_[i] = 0;
-  }
-
-  for (i = 0; i < dataDepGraph_->GetInstCnt(); i++)
-    spillCosts_[i] = 0;
-
-  for (int i = 0; i < regTypeCnt_; i++)
-    sumOfLiveIntervalLengths_[i] = 0;
-
-  dynamicSlilLowerBound_ = staticSlilLowerBound_;
+  InitForSchdulng(*rgnState_);
 #endif
 }
 /*****************************************************************************/
@@ -464,17 +430,17 @@ InstCount BBWithSpill::CmputCost_(InstSchedule *sched, COST_COMP_MODE compMode,
       LocalRegAlloc regAlloc(sched, dataDepGraph_);
       regAlloc.SetupForRegAlloc();
       regAlloc.AllocRegs();
-      crntSpillCost_ = regAlloc.GetCost();
+      rgnState_->crntSpillCost = regAlloc.GetCost();
     }
   }
 
   assert(sched->IsComplete());
   InstCount cost = sched->GetCrntLngth() * schedCostFactor_;
   execCost = cost;
-  cost += crntSpillCost_ * SCW_;
-  sched->SetSpillCosts(spillCosts_);
-  sched->SetPeakRegPressures(peakRegPressures_);
-  sched->SetSpillCost(crntSpillCost_);
+  cost += rgnState_->crntSpillCost * SCW_;
+  sched->SetSpillCosts(rgnState_->spillCosts);
+  sched->SetPeakRegPressures(rgnState_->peakRegPressures);
+  sched->SetSpillCost(rgnState_->crntSpillCost);
   return cost;
 }
 
@@ -508,359 +474,41 @@ InstCount BBWithSpill::Dev_CmputCost_(InstSchedule *sched, COST_COMP_MODE compMo
 __host__ __device__
 void BBWithSpill::CmputCrntSpillCost_() {
 #ifdef __HIP_DEVICE_COMPILE__ //Device version of function
-  switch (GetSpillCostFunc()) {
-  case SCF_PERP:
-  case SCF_PRP:
-  case SCF_PEAK_PER_TYPE:
-  case SCF_TARGET:
-    dev_crntSpillCost_[GLOBALTID] = dev_peakSpillCost_[GLOBALTID];
-    break;
-  case SCF_SUM:
-    dev_crntSpillCost_[GLOBALTID] = dev_totSpillCost_[GLOBALTID];
-    break;
-  case SCF_PEAK_PLUS_AVG:
-    dev_crntSpillCost_[GLOBALTID] =
-        dev_peakSpillCost_[GLOBALTID] + 
-	dev_totSpillCost_[GLOBALTID] / dataDepGraph_->GetInstCnt();
-    break;
-  case SCF_SLIL:
-    dev_crntSpillCost_[GLOBALTID] = dev_slilSpillCost_[GLOBALTID];
-    break;
-  default:
-    dev_crntSpillCost_[GLOBALTID] = dev_peakSpillCost_[GLOBALTID];
-    break;
-  }
-
+  CmputCrntSpillCost_(GetDevSpillState_());
 #else // Host version of function
-  switch (GetSpillCostFunc()) {
-  case SCF_PERP:
-  case SCF_PRP:
-  case SCF_PEAK_PER_TYPE:
-  case SCF_TARGET:
-    crntSpillCost_ = peakSpillCost_;
-    break;
-  case SCF_SUM:
-    crntSpillCost_ = totSpillCost_;
-    break;
-  case SCF_PEAK_PLUS_AVG:
-    crntSpillCost_ =
-        peakSpillCost_ + totSpillCost_ / dataDepGraph_->GetInstCnt();
-    break;
-  case SCF_SLIL:
-    crntSpillCost_ = slilSpillCost_;
-    break;
-  default:
-    crntSpillCost_ = peakSpillCost_;
-    break;
-  }
+  CmputCrntSpillCost_(GetSpillState_(*rgnState_));
 #endif
 }
 /******************************i***********************************************/
 
 //#define IS_DEBUG_REG_PRESSURE
-//note: Logger::info/fatal cannot be called on device. using __HIP_DEVICE_COMPILE__ 
-//macro to call printf on device instead
 __host__ __device__
 void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
                                             bool trackCnflcts) {
-  int16_t regType;
-  int defCnt, useCnt, regNum, physRegNum;
-  RegIndxTuple *defs, *uses;
-  Register *def, *use;
-  int liveRegs;
-  InstCount newSpillCost;
-  InstCount perpValueForSlil;
-
 #ifdef __HIP_DEVICE_COMPILE__ // Device Version of function
-#ifdef IS_DEBUG_REG_PRESSURE
-  printf("Updating reg pressure after scheduling Inst %d\n",
-               inst->GetNum());
-#endif
-
-  defCnt = inst->GetDefCnt();
-  useCnt = inst->GetUseCnt();
-
-  // Update Live regs after uses
-  // TODO(bruce): convert to dev uses
-  int useStart = inst->ddgUseIndex;
-  for (int i = 0; i < useCnt; i++) {
-    use = dataDepGraph_->getRegByTuple(dataDepGraph_->getUseByIndex(useStart + i));
-    regType = use->GetType();
-    regNum = use->GetNum();
-    physRegNum = use->GetPhysicalNumber();
-
-    if (use->IsLive() == false) {
-      printf("Reg %d of type %d is used without being defined\n", regNum,
-             regType);
-    }
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    printf("Inst %d uses reg %d of type %d and %d uses\n", inst->GetNum(), 
-		                        regNum, regType, use->GetUseCnt());
-#endif
-
-    use->AddCrntUse();
-
-    if (use->IsLive() == false) {
-      // (Chris): The SLIL calculation below the def and use for-loops doesn't
-      // consider the last use of a register. Thus, an additional increment must
-      // happen here.
-      if (needsSLIL()) {
-        dev_sumOfLiveIntervalLengths_[regType*numThreads_+GLOBALTID]++;
-      }
-
-      dev_liveRegs_[regType][GLOBALTID].SetBit(regNum, false, use->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-      printf("Reg type %d now has %d live regs\n", regType,
-             dev_liveRegs_[regType][GLOBALTID].GetOneCnt());
-#endif
-    }
-  }
-
-  // Update Live regs after defs
-  // TODO(bruce): convert to dev defs
-  int defStart = inst->ddgDefIndex;
-  for (int i = 0; i < defCnt; i++) {
-    def = dataDepGraph_->getRegByTuple(dataDepGraph_->getDefByIndex(defStart + i));
-    regType = def->GetType();
-    regNum = def->GetNum();
-    physRegNum = def->GetPhysicalNumber();
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    printf("Inst %d defines reg %d of type %d and %d uses\n",inst->GetNum(),
-           regNum, regType, def->GetUseCnt());
-#endif
-
-    if (trackCnflcts && dev_liveRegs_[regType][GLOBALTID].GetOneCnt() > 0)
-      regFiles_[regType].AddConflictsWithLiveRegs(
-          regNum, dev_liveRegs_[regType][GLOBALTID].GetOneCnt());
-
-    dev_liveRegs_[regType][GLOBALTID].SetBit(regNum, true, def->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    printf("Reg type %d now has %d live regs\n", regType,
-           dev_liveRegs_[regType][GLOBALTID].GetOneCnt());
-#endif
-
-    def->ResetCrntUseCnt();
-  }
-
-  newSpillCost = 0;
-
-#ifdef IS_DEBUG_SLIL_CORRECT
-  if (OPTSCHED_gPrintSpills) {
-    printf("Printing live range lengths for instruction BEFORE calculation.\n");
-    for (int j = 0; j < regTypeCnt_; j++) {
-      printf("SLIL for regType %d %s is currently %d\n", j,
-             dev_sumOfLiveIntervalLengths_[j*numThreads_+GLOBALTID]);
-    }
-    printf("Now computing spill cost for instruction.\n");
-  }
-#endif
-
-  for (int16_t i = 0; i < regTypeCnt_; i++) {
-    liveRegs = dev_liveRegs_[i][GLOBALTID].GetWghtedCnt();
-    // Set current RP for register type "i"
-    dev_regPressures_[i*numThreads_+GLOBALTID] = liveRegs;
-    // Update peak RP for register type "i"
-    if (liveRegs > dev_peakRegPressures_[i*numThreads_+GLOBALTID])
-      dev_peakRegPressures_[i*numThreads_+GLOBALTID] = liveRegs;
-
-    // (Chris): Compute sum of live range lengths at this point
-    if (needsSLIL()) {
-      dev_sumOfLiveIntervalLengths_[i*numThreads_+GLOBALTID] += 
-	               dev_liveRegs_[i][GLOBALTID].GetOneCnt();
-    }
-  }
-
-  if (GetSpillCostFunc() == SCF_SLIL) {
-    dev_slilSpillCost_[GLOBALTID] = 
-                   Dev_CmputCostForFunction(GetSpillCostFunc());
-    // calculate PERP with SLIL to consider schedules with PERP of 0
-    // even if SLIL is higher
-    perpValueForSlil = Dev_CmputCostForFunction(SCF_PERP);
-    if (dev_peakSpillCost_[GLOBALTID] < perpValueForSlil)
-      dev_peakSpillCost_[GLOBALTID] = perpValueForSlil;
-  }
-  else
-    newSpillCost = Dev_CmputCostForFunction(GetSpillCostFunc());
-
-#ifdef IS_DEBUG_SLIL_CORRECT
-  if (OPTSCHED_gPrintSpills) {
-    printf("Printing live range lengths for instruction AFTER calculation.\n");
-    for (int j = 0; j < regTypeCnt_; j++) {
-      printf("SLIL for regType %d is currently %d\n", j,
-             dev_sumOfLiveIntervalLengths_[j*numThreads_+GLOBALTID]);
-    }
-  }
-#endif
-
-  dev_crntStepNum_[GLOBALTID]++;
-  dev_spillCosts_[dev_crntStepNum_[GLOBALTID]*numThreads_+GLOBALTID] = newSpillCost;
-
-#ifdef IS_DEBUG_REG_PRESSURE
-  printf("Spill cost at step  %d = %d\n", dev_crntStepNum_[GLOBALTID], newSpillCost);
-#endif
-
-  dev_totSpillCost_[GLOBALTID] += newSpillCost;
-
-  if (dev_peakSpillCost_[GLOBALTID] < newSpillCost)
-    dev_peakSpillCost_[GLOBALTID] = newSpillCost;
-
-  CmputCrntSpillCost_();
-
+  UpdateSpillInfoForSchdul_(GetDevSpillState_(), inst, trackCnflcts);
   dev_schduldInstCnt_[GLOBALTID]++;
 
 #else // Host Version of function
-#ifdef IS_DEBUG_REG_PRESSURE
-  Logger::Info("Updating reg pressure after scheduling Inst %d",
-               inst->GetNum());
-#endif
+  int defCnt, useCnt;
+  RegIndxTuple *defs, *uses;
+  Register *def, *use;
 
+  // The list scheduler and the enumerator read the current use counts of the
+  // registers to compute last use counts, so keep them in step with the
+  // counts of the region's scheduling state.
   defCnt = inst->GetDefs(defs);
   useCnt = inst->GetUses(uses);
-
-  // Update Live regs after uses
   for (int i = 0; i < useCnt; i++) {
     use = dataDepGraph_->getRegByTuple(&uses[i]);
-    regType = use->GetType();
-    regNum = use->GetNum();
-    physRegNum = use->GetPhysicalNumber();
-
-    if (use->IsLive() == false) {
-      Logger::Fatal("Reg %d of type %d is used without being defined", regNum,
-                    regType);
-    }
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Inst %d uses reg %d of type %d and %d uses", inst->GetNum(),
-                 regNum, regType, use->GetUseCnt());
-#endif
-
     use->AddCrntUse();
-
-    if (use->IsLive() == false) {
-      // (Chris): The SLIL calculation below the def and use for-loops doesn't
-      // consider the last use of a register. Thus, an additional increment must
-      // happen here.
-      if (needsSLIL()) {
-        sumOfLiveIntervalLengths_[regType]++;
-        // if (!use->IsInInterval(inst) && !use->IsInPossibleInterval(inst)) {
-        //   ++dynamicSlilLowerBound_;
-        // }
-      }
-
-      liveRegs_[regType].SetBit(regNum, false, use->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-      Logger::Info("Reg type %d now has %d live regs", regType,
-                   liveRegs_[regType].GetOneCnt());
-#endif
-
-      if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-        livePhysRegs_[regType].SetBit(physRegNum, false, use->GetWght());
-    }
   }
-
-  // Update Live regs after defs
   for (int i = 0; i < defCnt; i++) {
     def = dataDepGraph_->getRegByTuple(&defs[i]);
-    regType = def->GetType();
-    regNum = def->GetNum();
-    physRegNum = def->GetPhysicalNumber();
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Inst %d defines reg %d of type %d and %d uses",
-                 inst->GetNum(), regNum, regType, def->GetUseCnt());
-#endif
-
-    if (trackCnflcts && liveRegs_[regType].GetOneCnt() > 0)
-      regFiles_[regType].AddConflictsWithLiveRegs(
-          regNum, liveRegs_[regType].GetOneCnt());
-
-    liveRegs_[regType].SetBit(regNum, true, def->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Reg type %d now has %d live regs", regType,
-                 liveRegs_[regType].GetOneCnt());
-#endif
-
-    if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-      livePhysRegs_[regType].SetBit(physRegNum, true, def->GetWght());
     def->ResetCrntUseCnt();
   }
 
-  newSpillCost = 0;
-
-#ifdef IS_DEBUG_SLIL_CORRECT
-  if (OPTSCHED_gPrintSpills) {
-    Logger::Info(
-        "Printing live range lengths for instruction BEFORE calculation.");
-    for (int j = 0; j < regTypeCnt_; j++) {
-      Logger::Info("SLIL for regType %d %s is currently %d", j,
-                   sumOfLiveIntervalLengths_[j]);
-    }
-    Logger::Info("Now computing spill cost for instruction.");
-  }
-#endif
-
-  for (int16_t i = 0; i < regTypeCnt_; i++) {
-    liveRegs = liveRegs_[i].GetWghtedCnt();
-    // Set current RP for register type "i"
-    regPressures_[i] = liveRegs;
-    // Update peak RP for register type "i"
-    if (liveRegs > peakRegPressures_[i])
-      peakRegPressures_[i] = liveRegs;
-
-    // (Chris): Compute sum of live range lengths at this point
-    if (needsSLIL()) {
-      sumOfLiveIntervalLengths_[i] += liveRegs_[i].GetOneCnt();
-      // for (int j = 0; j < liveRegs_[i].GetSize(); ++j) {
-      //   if (liveRegs_[i].GetBit(j)) {
-      //     const Register *reg = regFiles_[i].GetReg(j);
-      //     if (!reg->IsInInterval(inst) && !reg->IsInPossibleInterval(inst)) {
-      //       ++dynamicSlilLowerBound_;
-      //     }
-      //   }
-      // }
-    }
-  }
-  
-  if (GetSpillCostFunc() == SCF_SLIL) {
-    slilSpillCost_ = CmputCostForFunction(GetSpillCostFunc());
-    // calculate PERP with SLIL to consider schedules with PERP of 0
-    // even if SLIL is higher
-    perpValueForSlil = CmputCostForFunction(SCF_PERP);
-    if (peakSpillCost_ < perpValueForSlil)
-      peakSpillCost_ = perpValueForSlil;
-  }
-  else
-    newSpillCost = CmputCostForFunction(GetSpillCostFunc());
-
-#ifdef IS_DEBUG_SLIL_CORRECT
-  if (OPTSCHED_gPrintSpills) {
-    Logger::Info(
-        "Printing live range lengths for instruction AFTER calculation.");
-    for (int j = 0; j < regTypeCnt_; j++) {
-      Logger::Info("SLIL for regType %d is currently %d", j,
-                   sumOfLiveIntervalLengths_[j]);
-    }
-  }
-#endif
-
-  crntStepNum_++;
-  spillCosts_[crntStepNum_] = newSpillCost;
-
-#ifdef IS_DEBUG_REG_PRESSURE
-  Logger::Info("Spill cost at step  %d = %d", crntStepNum_, newSpillCost);
-#endif
-
-  totSpillCost_ += newSpillCost;
-
-  peakSpillCost_ = std::max(peakSpillCost_, newSpillCost);
-
-  CmputCrntSpillCost_();
+  UpdateSpillInfoForSchdul_(GetSpillState_(*rgnState_), inst, trackCnflcts);
 
   schduldInstCnt_++;
   if (inst->MustBeInBBEntry())
@@ -872,114 +520,30 @@ void BBWithSpill::UpdateSpillInfoForSchdul_(SchedInstruction *inst,
 /*****************************************************************************/
 
 void BBWithSpill::UpdateSpillInfoForUnSchdul_(SchedInstruction *inst) {
-  int16_t regType;
-  int i, defCnt, useCnt, regNum, physRegNum;
+  int i, defCnt, useCnt;
   RegIndxTuple *defs, *uses;
   Register *def, *use;
-  bool isLive;
-
-#ifdef IS_DEBUG_REG_PRESSURE
-  Logger::Info("Updating reg pressure after unscheduling Inst %d",
-               inst->GetNum());
-#endif
 
   defCnt = inst->GetDefs(defs);
   useCnt = inst->GetUses(uses);
 
-  // (Chris): Update the SLIL for all live regs at this point.
-  if (GetSpillCostFunc() == SCF_SLIL) {
-    for (int i = 0; i < regTypeCnt_; ++i) {
-      for (int j = 0; j < liveRegs_[i].GetSize(); ++j) {
-        if (liveRegs_[i].GetBit(j)) {
-          // const Register *reg = regFiles_[i].GetReg(j);
-          sumOfLiveIntervalLengths_[i]--;
-          // if (!reg->IsInInterval(inst) && !reg->IsInPossibleInterval(inst)) {
-          //   --dynamicSlilLowerBound_;
-          // }
-        }
-      }
-      assert(sumOfLiveIntervalLengths_[i] >= 0 &&
-             "UpdateSpillInfoForUnSchdul_: SLIL negative!");
-    }
-  }
-
-  // Update Live regs
   for (i = 0; i < defCnt; i++) {
     def = dataDepGraph_->getRegByTuple(&defs[i]);
-    regType = def->GetType();
-    regNum = def->GetNum();
-    physRegNum = def->GetPhysicalNumber();
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Inst %d defines reg %d of type %d and %d uses",
-                 inst->GetNum(), regNum, regType, def->GetUseCnt());
-#endif
-
-    // if (def->GetUseCnt() > 0) {
-    assert(liveRegs_[regType].GetBit(regNum));
-    liveRegs_[regType].SetBit(regNum, false, def->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Reg type %d now has %d live regs", regType,
-                 liveRegs_[regType].GetOneCnt());
-#endif
-
-    if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-      livePhysRegs_[regType].SetBit(physRegNum, false, def->GetWght());
     def->ResetCrntUseCnt();
-    //}
   }
-
   for (i = 0; i < useCnt; i++) {
     use = dataDepGraph_->getRegByTuple(&uses[i]);
-    regType = use->GetType();
-    regNum = use->GetNum();
-    physRegNum = use->GetPhysicalNumber();
-
-#ifdef IS_DEBUG_REG_PRESSURE
-    Logger::Info("Inst %d uses reg %d of type %d and %d uses", inst->GetNum(),
-                 regNum, regType, use->GetUseCnt());
-#endif
-
-    isLive = use->IsLive();
     use->DelCrntUse();
     assert(use->IsLive());
+  }
 
-    if (isLive == false) {
-      // (Chris): Since this was the last use, the above SLIL calculation didn't
-      // take this instruction into account.
-      if (GetSpillCostFunc() == SCF_SLIL) {
-        sumOfLiveIntervalLengths_[regType]--;
-        // if (!use->IsInInterval(inst) && !use->IsInPossibleInterval(inst)) {
-        //   --dynamicSlilLowerBound_;
-        // }
-        assert(sumOfLiveIntervalLengths_[regType] >= 0 &&
-               "UpdateSpillInfoForUnSchdul_: SLIL negative!");
-      }
-      liveRegs_[regType].SetBit(regNum, true, use->GetWght());
-
-#ifdef IS_DEBUG_REG_PRESSURE
-      Logger::Info("Reg type %d now has %d live regs", regType,
-                   liveRegs_[regType].GetOneCnt());
-#endif
-
-      if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
-        livePhysRegs_[regType].SetBit(physRegNum, true, use->GetWght());
-    }
-  }
+  UpdateSpillInfoForUnSchdul_(*rgnState_, inst);
 
   schduldInstCnt_--;
   if (inst->MustBeInBBEntry())
     schduldEntryInstCnt_--;
   if (inst->MustBeInBBExit())
     schduldExitInstCnt_--;
-
-  totSpillCost_ -= spillCosts_[crntStepNum_];
-  crntStepNum_--;
-
-#ifdef IS_DEBUG_REG_PRESSURE
-// Logger::Info("Spill cost at step  %d = %d", crntStepNum_, newSpillCost);
-#endif
 }
 /*****************************************************************************/
 
@@ -1020,7 +584,7 @@ void BBWithSpill::UnschdulInst(SchedInstruction *inst, InstCount cycleNum,
   }
 
   UpdateSpillInfoForUnSchdul_(inst);
-  peakSpillCost_ = trgtNode->GetPeakSpillCost();
+  rgnState_->peakSpillCost = trgtNode->GetPeakSpillCost();
   CmputCrntSpillCost_();
 }
 /*****************************************************************************/
@@ -1054,10 +618,24 @@ Enumerator *BBWithSpill::AllocEnumrtr_(Milliseconds timeout) {
       GetEnumPriorities(), GetPruningStrategy(), SchedForRPOnly_, enblStallEnum,
       timeout, GetSpillCostFunc(), 0, NULL);
 
+  Config &schedIni = SchedulerOptions::getInstance();
+  uint64_t histMemLimit =
+      std::max<int>(schedIni.GetInt("HIST_TABLE_MAX_MEMORY_MB", 0), 0);
+  enumrtr_->SetHistMemLimit(histMemLimit << 20);
+  enumrtr_->SetNodeBudget(
+      std::max<int>(schedIni.GetInt("ENUM_NODE_BUDGET", 0), 0));
+
   return enumrtr_;
 }
 /*****************************************************************************/
 
+// Has the region run out of time? A search that runs out of nodes times out
+// before the region does.
+static bool isRgnTimedOut(Milliseconds rgnDeadline) {
+  return rgnDeadline != INVALID_VALUE &&
+         Utilities::GetProcessorTime() > rgnDeadline;
+}
+
 FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
                                     Milliseconds rgnTimeout,
                                     Milliseconds lngthTimeout) {
@@ -1074,19 +652,65 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
       (rgnTimeout == INVALID_VALUE) ? INVALID_VALUE : startTime + lngthTimeout;
   assert(lngthDeadline <= rgnDeadline);
 
-  for (trgtLngth = schedLwrBound_; trgtLngth <= schedUprBound_; trgtLngth++) {
+  Config &schedIni = SchedulerOptions::getInstance();
+  int enumThreads = std::max<int>(schedIni.GetInt("ENUM_THREADS", 1), 1);
+  InstCount splitDepth =
+      std::max<int>(schedIni.GetInt("ENUM_SPLIT_DEPTH", 3), 1);
+  int sharedHistEntries =
+      std::max<int>(schedIni.GetInt("ENUM_SHARED_HISTORY_ENTRIES", 65536), 0);
+  // The second pass only looks for a schedule of the first pass's RP cost,
+  // so it always searches by length.
+  bool isCostDeepening =
+      schedIni.GetString("ENUM_SEARCH_MODE", "LENGTH") == "COST_DEEPENING" &&
+      !IsSecondPass();
+  std::vector<std::unique_ptr<BBWithSpill>> workers;
+  std::unique_ptr<ThreadPool> workerPool;
+  std::unique_ptr<SharedHistTable> sharedHist;
+
+  if (enumThreads > 1 && enumWorkerGraphFactory_) {
+    workers = AllocEnumWorkers_(enumThreads, lngthTimeout);
+    if (!workers.empty())
+      workerPool = std::make_unique<ThreadPool>(
+          llvm::hardware_concurrency(enumThreads));
+    if (!workers.empty() && GetPruningStrategy().histDom &&
+        sharedHistEntries > 0)
+      sharedHist = std::make_unique<SharedHistTable>(
+          dataDepGraph_, machMdl_->GetIssueRate(), sharedHistEntries);
+  }
+
+  auto enumerateLength = [&](InstCount trgtLngth, int costLwrBound,
+                             Milliseconds lngthDeadline) {
+    FUNC_RESULT lngthRslt;
     InitForSchdulng();
     //#ifdef IS_DEBUG_ENUM_ITERS
     Logger::Info("Enumerating at target length %d", trgtLngth);
     //#endif
-    rslt = enumrtr_->FindFeasibleSchedule(enumCrntSched_, trgtLngth, this,
-                                          costLwrBound, lngthDeadline);
+    if (workers.empty())
+      lngthRslt = enumrtr_->FindFeasibleSchedule(
+          enumCrntSched_, trgtLngth, this, costLwrBound, lngthDeadline);
+    else
+      lngthRslt = EnumerateInParallel_(workers, *workerPool, sharedHist.get(),
+                                       trgtLngth, costLwrBound, splitDepth,
+                                       lngthDeadline);
+    HandlEnumrtrRslt_(lngthRslt, trgtLngth);
+    return lngthRslt;
+  };
+
+  if (isCostDeepening) {
+    rslt = EnumerateByCost_(enumerateLength, rgnDeadline, lngthTimeout,
+                            iterCnt);
+    if (rslt == RES_TIMEOUT)
+      timeout = true;
+  }
+
+  for (trgtLngth = schedLwrBound_;
+       !isCostDeepening && trgtLngth <= schedUprBound_; trgtLngth++) {
+    rslt = enumerateLength(trgtLngth, costLwrBound, lngthDeadline);
     if (rslt == RES_TIMEOUT)
       timeout = true;
-    HandlEnumrtrRslt_(rslt, trgtLngth);
 
     if (GetBestCost() == 0 || rslt == RES_ERROR ||
-        (lngthDeadline == rgnDeadline && rslt == RES_TIMEOUT) ||
+        (rslt == RES_TIMEOUT && isRgnTimedOut(rgnDeadline)) ||
         (rslt == RES_SUCCESS && IsSecondPass())) {
 
       // If doing two pass optsched and on the second pass then terminate if a
@@ -1116,6 +740,9 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
       lngthDeadline = rgnDeadline;
   }
 
+  workerPool.reset();
+  FreeEnumWorkers_(workers);
+
 #ifdef IS_DEBUG_ITERS
   stats::iterations.Record(iterCnt);
   stats::enumerations.Record(enumrtr_->GetSearchCnt());
@@ -1134,46 +761,228 @@ FUNC_RESULT BBWithSpill::Enumerate_(Milliseconds startTime,
 }
 /*****************************************************************************/
 
-InstCount BBWithSpill::CmputCostForFunction(SPILL_COST_FUNCTION SpillCF) {
-  // return the requested cost
-  switch (SpillCF) {
-  case SCF_TARGET: {
-    return OST->getCost(regPressures_);
+FUNC_RESULT BBWithSpill::EnumerateByCost_(
+    const std::function<FUNC_RESULT(InstCount, int, Milliseconds)>
+        &enumerateLength,
+    Milliseconds rgnDeadline, Milliseconds lngthTimeout, int &iterCnt) {
+  FUNC_RESULT rslt = RES_SUCCESS;
+  bool timeout = false;
+  int costLwrBound = 0;
+  // While it is shared, the threshold is lowered to the cost of each schedule
+  // found, so a pass that finds one goes on like a search by length that
+  // started with that schedule.
+  std::atomic<InstCount> costThrshld(0);
+
+  for (InstCount trgtLngth = schedLwrBound_; trgtLngth <= schedUprBound_;
+       trgtLngth++) {
+    Milliseconds lngthDeadline = Utilities::GetProcessorTime() + lngthTimeout;
+    if (lngthDeadline > rgnDeadline)
+      lngthDeadline = rgnDeadline;
+
+    int lngthCostLwrBound = costLwrBound;
+
+    // The threshold is 64-bit so that doubling it can not overflow before
+    // it reaches the best cost.
+    for (int64_t thrshld = 1;; thrshld *= 2) {
+      // Once the threshold reaches the best cost, the last pass searches
+      // without it.
+      bool isLastPass = thrshld >= GetBestCost();
+      if (!isLastPass) {
+        costThrshld = (InstCount)thrshld;
+        ShareBestCost(&costThrshld);
+      }
+
+      rslt = enumerateLength(trgtLngth, lngthCostLwrBound, lngthDeadline);
+      ShareBestCost(nullptr);
+      iterCnt++;
+
+      // A pass that found a schedule below its threshold has searched
+      // everything below the cost of that schedule.
+      if (rslt != RES_FAIL || isLastPass || GetBestCost() < thrshld)
+        break;
+
+      // The pass ruled out everything below the threshold at this length,
+      // so the next one may stop at a schedule that costs exactly that. The
+      // history is kept, and each node in it only prunes under a bound no
+      // higher than the one it was searched under.
+      lngthCostLwrBound = std::max(lngthCostLwrBound, (int)thrshld);
+      enumrtr_->ResetKeepingHistory();
+      enumCrntSched_->Reset();
+    }
+
+    if (rslt == RES_TIMEOUT)
+      timeout = true;
+
+    if (GetBestCost() == 0 || rslt == RES_ERROR ||
+        (rslt == RES_TIMEOUT && isRgnTimedOut(rgnDeadline)))
+      break;
+
+    enumrtr_->Reset();
+    enumCrntSched_->Reset();
+    CmputSchedUprBound_();
+    costLwrBound += 1;
   }
-  case SCF_SLIL: {
-    InstCount SLILCost = 0;
-    for (int i = 0; i < regTypeCnt_; i ++)
-      SLILCost += sumOfLiveIntervalLengths_[i];
-    return SLILCost;
+
+  CmputSchedUprBound_();
+
+  if (rslt == RES_ERROR)
+    return RES_ERROR;
+  return timeout ? RES_TIMEOUT : RES_SUCCESS;
+}
+/*****************************************************************************/
+
+std::vector<std::unique_ptr<BBWithSpill>>
+BBWithSpill::AllocEnumWorkers_(int workerCnt, Milliseconds lngthTimeout) {
+  std::vector<std::unique_ptr<BBWithSpill>> workers;
+
+  for (int i = 0; i < workerCnt; i++) {
+    // Workers neither verify their schedules nor run ACO.
+    workers.push_back(std::make_unique<BBWithSpill>(
+        OST, enumWorkerGraphFactory_(), GetRgnNum(), GetSigHashSize(),
+        GetLwrBoundAlg(), GetHeuristicPriorities(), GetEnumPriorities(),
+        false, GetPruningStrategy(), SchedForRPOnly_, enblStallEnum_, SCW_,
+        GetSpillCostFunc(), GetHeuristicSchedulerType(), nullptr,
+        GetHeuristicPriorities(), GetHeuristicPriorities()));
+    BBWithSpill &worker = *workers.back();
+    worker.TargetOccupancy_ = TargetOccupancy_;
+    worker.MaxOccLDS_ = MaxOccLDS_;
+
+    if (worker.SetupForEnumWorker_(this, lngthTimeout) != RES_SUCCESS) {
+      Logger::Info("Could not set up enumerator thread %d. Enumerating on "
+                   "one thread.",
+                   i);
+      FreeEnumWorkers_(workers);
+      break;
+    }
   }
-  case SCF_PRP: {
-    InstCount PRPCost = 0;
-    for (int i = 0; i < regTypeCnt_; i ++)
-      PRPCost += regPressures_[i];
-    return PRPCost;
+
+  return workers;
+}
+/*****************************************************************************/
+
+void BBWithSpill::FreeEnumWorkers_(
+    std::vector<std::unique_ptr<BBWithSpill>> &workers) {
+  for (auto &worker : workers) {
+    delete worker->enumCrntSched_;
+    delete worker->enumBestSched_;
   }
-  case SCF_PEAK_PER_TYPE: {
-    InstCount SC = 0;
-    InstCount inc;
-    for (int i = 0; i < regTypeCnt_; i++) {
-      inc = peakRegPressures_[i] - machMdl_->GetPhysRegCnt(i);
-      if (inc > 0)
-        SC += inc;
+  workers.clear();
+}
+/*****************************************************************************/
+
+FUNC_RESULT BBWithSpill::EnumerateInParallel_(
+    std::vector<std::unique_ptr<BBWithSpill>> &workers, ThreadPool &pool,
+    SharedHistTable *sharedHist, InstCount trgtLngth, int costLwrBound,
+    InstCount splitDepth, Milliseconds deadline) {
+  std::vector<std::vector<InstCount>> prefixes;
+  FUNC_RESULT rslt =
+      enumrtr_->FindSubProblems(enumCrntSched_, trgtLngth, this, costLwrBound,
+                                splitDepth, prefixes, deadline);
+
+  if (rslt == RES_ERROR || rslt == RES_TIMEOUT || prefixes.empty() ||
+      GetBestCost() == costLwrBound)
+    return rslt;
+
+  // The sub-problems are in the order in which the enumerator would have
+  // searched them. Each worker starts with the first ones of its share, and
+  // the last ones are stolen first.
+  size_t workerCnt = workers.size();
+  WorkStealingQueues<size_t> tasks(workerCnt);
+  for (size_t i = prefixes.size(); i-- > 0;)
+    tasks.Push(i % workerCnt, i);
+
+  // The history of the previous target length does not apply to this one.
+  // The history of an earlier pass at this length is kept.
+  uint64_t prevHitCnt = 0, prevEvictionCnt = 0;
+  if (sharedHist != NULL) {
+    sharedHist->StartLength(trgtLngth);
+    prevHitCnt = sharedHist->GetHitCnt();
+    prevEvictionCnt = sharedHist->GetEvictionCnt();
+  }
+
+  std::atomic<InstCount> sharedBestCost(GetBestCost());
+  for (auto &worker : workers) {
+    worker->SetBestCost(GetBestCost());
+    worker->ShareBestCost(&sharedBestCost);
+    worker->enumrtr_->SetSharedHistory(sharedHist);
+  }
+
+  std::vector<FUNC_RESULT> rslts(workerCnt, RES_FAIL);
+  auto startTime = Utilities::startTime;
+  auto runWorker = [&, startTime](size_t w) {
+    // Measure time from the start of the region like the calling thread.
+    Utilities::startTime = startTime;
+    BBWithSpill &worker = *workers[w];
+    size_t task;
+
+    while (worker.GetBestCost() != costLwrBound && tasks.Pop(w, task)) {
+      worker.InitForSchdulng();
+      worker.enumrtr_->SetPrefix(&prefixes[task]);
+      FUNC_RESULT taskRslt = worker.enumrtr_->FindFeasibleSchedule(
+          worker.enumCrntSched_, trgtLngth, &worker, costLwrBound, deadline);
+      worker.enumrtr_->SetPrefix(NULL);
+      // The history holds the nodes of the prefix, which were only searched
+      // along the prefix, so it can not be kept for another prefix. The
+      // shared history does not hold them and is kept.
+      worker.enumrtr_->Reset();
+      worker.enumCrntSched_->Reset();
+
+      if (taskRslt == RES_SUCCESS) {
+        rslts[w] = RES_SUCCESS;
+      } else if (taskRslt != RES_FAIL) {
+        rslts[w] = taskRslt;
+        break;
+      }
     }
-    return SC;
-  }
-  default: {
-    // Default is PERP (Some SCF like SUM rely on PERP being the default here)
-    InstCount inc;
-    InstCount SC = 0;
-    for (int i = 0; i < regTypeCnt_; i ++) {
-      inc = regPressures_[i] - machMdl_->GetPhysRegCnt(i);
-      if (inc > 0)
-        SC += inc;
+  };
+
+  for (size_t w = 0; w < workerCnt; w++)
+    pool.async(runWorker, w);
+  pool.wait();
+
+  Logger::Info("Searched %d sub-problems at target length %d on %d threads.",
+               (int)prefixes.size(), trgtLngth, (int)workerCnt);
+
+  if (sharedHist != NULL) {
+    Logger::Info("Shared history: %llu entries of %llu, %llu evicted, %llu "
+                 "dominated nodes.",
+                 (unsigned long long)sharedHist->GetEntryCnt(),
+                 (unsigned long long)sharedHist->GetCapacity(),
+                 (unsigned long long)sharedHist->GetEvictionCnt(),
+                 (unsigned long long)sharedHist->GetHitCnt());
+    stats::sharedHistoryDominationHits += sharedHist->GetHitCnt() - prevHitCnt;
+    stats::sharedHistoryEvictions +=
+        sharedHist->GetEvictionCnt() - prevEvictionCnt;
+  }
+
+  for (size_t w = 0; w < workerCnt; w++) {
+    BBWithSpill &worker = *workers[w];
+    worker.ShareBestCost(nullptr);
+    worker.enumrtr_->SetSharedHistory(NULL);
+
+    // A worker only records a schedule that beats every other one so far.
+    if (worker.GetBestCost() < GetBestCost()) {
+      SetBestCost(worker.GetBestCost());
+      optmlSpillCost_ = worker.optmlSpillCost_;
+      SetBestSchedLength(worker.enumBestSched_->GetCrntLngth());
+      enumBestSched_->Copy(worker.enumBestSched_);
+      bestSched_ = enumBestSched_;
     }
-    return SC;
-  }
+
+    if (rslts[w] == RES_ERROR || rslt == RES_ERROR)
+      rslt = RES_ERROR;
+    else if (rslts[w] == RES_TIMEOUT || rslt == RES_TIMEOUT)
+      rslt = RES_TIMEOUT;
+    else if (rslts[w] == RES_SUCCESS)
+      rslt = RES_SUCCESS;
   }
+
+  return rslt;
+}
+/*****************************************************************************/
+
+InstCount BBWithSpill::CmputCostForFunction(SPILL_COST_FUNCTION SpillCF) {
+  return CmputCostForFunction(*rgnState_, SpillCF);
 }
 
 __device__
@@ -1318,53 +1127,15 @@ bool BBWithSpill::closeToRPConstraint() {
                            dev_regPressures_[OptSchedDDGWrapperGCN::SGPR32*numThreads_+GLOBALTID], MaxOccLDS_);
   #else
   auto Occ =
-      getCloseToOccupancy(regPressures_[OptSchedDDGWrapperGCN::VGPR32],
-                           regPressures_[OptSchedDDGWrapperGCN::SGPR32], MaxOccLDS_);
+      getCloseToOccupancy(rgnState_->regPressures[OptSchedDDGWrapperGCN::VGPR32],
+                           rgnState_->regPressures[OptSchedDDGWrapperGCN::SGPR32], MaxOccLDS_);
   #endif
   return Occ <= TargetOccupancy_;
 }
 
 __device__
 InstCount BBWithSpill::Dev_CmputCostForFunction(SPILL_COST_FUNCTION SpillCF) {
-  // return the requested cost
-  switch (SpillCF) {
-  case SCF_TARGET: {
-    return getAMDGPUCost(dev_regPressures_, TargetOccupancy_, MaxOccLDS_, regTypeCnt_);
-  }
-  case SCF_SLIL: {
-    InstCount SLILCost = 0; 
-    for (int i = 0; i < regTypeCnt_; i++)
-      SLILCost += dev_sumOfLiveIntervalLengths_[i*numThreads_+GLOBALTID];
-    return SLILCost;
-  }
-  case SCF_PRP: {
-    InstCount PRPCost = 0; 
-    for (int i = 0; i < regTypeCnt_; i ++)
-      PRPCost += dev_regPressures_[i*numThreads_+GLOBALTID];
-    return PRPCost;
-  }
-  case SCF_PEAK_PER_TYPE: {
-    InstCount SC = 0; 
-    InstCount inc;
-    for (int i = 0; i < regTypeCnt_; i++) {
-      inc = dev_peakRegPressures_[i*numThreads_+GLOBALTID] - machMdl_->GetPhysRegCnt(i);
-      if (inc > 0) 
-        SC += inc; 
-    }    
-    return SC;
-  }
-  default: {
-    // Default is PERP (Some SCF like SUM rely on PERP being the default here)
-    InstCount inc;
-    InstCount SC = 0;
-    for (int i = 0; i < regTypeCnt_; i ++) {
-      inc = dev_regPressures_[i*numThreads_+GLOBALTID] - machMdl_->GetPhysRegCnt(i);
-      if (inc > 0) 
-        SC += inc;
-    }
-    return SC;
-  }
-  }
+  return CmputCostForFunction_(GetDevSpillState_(), SpillCF);
 }
 
 /*****************************************************************************/
@@ -1390,7 +1161,7 @@ InstCount BBWithSpill::UpdtOptmlSched(InstSchedule *crntSched,
       Logger::Info("$$$ GOOD_HIT: Better spill cost for a longer schedule");
 
     SetBestCost(crntCost);
-    optmlSpillCost_ = crntSpillCost_;
+    optmlSpillCost_ = rgnState_->crntSpillCost;
     SetBestSchedLength(crntSched->GetCrntLngth());
     enumBestSched_->Copy(crntSched);
     bestSched_ = enumBestSched_;
@@ -1407,12 +1178,13 @@ __host__ __device__
 bool BBWithSpill::needsTarget() { return needsComputeTarget; }
 
 void BBWithSpill::SetupForSchdulng_() {
-  for (int i = 0; i < regTypeCnt_; i++) {
-    liveRegs_[i].Construct(regFiles_[i].GetRegCnt());
-  }
-
   SetupPhysRegs_();
 
+  // The state is sized from the register files, so it can only be allocated
+  // once the physical register counts are known.
+  delete rgnState_;
+  rgnState_ = new AntState(dataDepGraph_, machMdl_);
+
   entryInstCnt_ = dataDepGraph_->GetEntryInstCnt();
   exitInstCnt_ = dataDepGraph_->GetExitInstCnt();
   schduldEntryInstCnt_ = 0;
@@ -1431,9 +1203,11 @@ bool BBWithSpill::ChkCostFsblty(InstCount trgtLngth, EnumTreeNode *node) {
   bool fsbl = true;
   InstCount crntCost, dynmcCostLwrBound;
   if (GetSpillCostFunc() == SCF_SLIL) {
-    crntCost = dynamicSlilLowerBound_ * SCW_ + trgtLngth * schedCostFactor_;
+    crntCost = rgnState_->dynamicSlilLowerBound * SCW_ +
+               trgtLngth * schedCostFactor_;
   } else {
-    crntCost = crntSpillCost_ * SCW_ + trgtLngth * schedCostFactor_;
+    crntCost =
+        rgnState_->crntSpillCost * SCW_ + trgtLngth * schedCostFactor_;
   }
   crntCost -= GetCostLwrBound();
   dynmcCostLwrBound = crntCost;
@@ -1448,8 +1222,8 @@ bool BBWithSpill::ChkCostFsblty(InstCount trgtLngth, EnumTreeNode *node) {
   if (fsbl) {
     node->SetCost(crntCost);
     node->SetCostLwrBound(dynmcCostLwrBound);
-    node->SetPeakSpillCost(peakSpillCost_);
-    node->SetSpillCostSum(totSpillCost_);
+    node->SetPeakSpillCost(rgnState_->peakSpillCost);
+    node->SetSpillCostSum(rgnState_->totSpillCost);
   }
   return fsbl;
 }
@@ -1499,7 +1273,7 @@ bool BBWithSpill::ChkInstLglty(SchedInstruction *inst) {
     // scheduling this instruction is illegal unless this
     // instruction is the last use of that physical reg definition.
     if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0 &&
-        livePhysRegs_[regType].GetBit(physRegNum) == true) {
+        rgnState_->livePhysRegs[regType].GetBit(physRegNum) == true) {
 
       liveDef = regFiles_[regType].FindLiveReg(physRegNum);
       assert(liveDef != NULL);
@@ -1591,7 +1365,7 @@ InstCount BBWithSpill::GetCrntSpillCost() {
 #ifdef __HIP_DEVICE_COMPILE__ // Device version of function
   return dev_crntSpillCost_[GLOBALTID];
 #else
-  return crntSpillCost_;
+  return GetCrntSpillCost(*rgnState_);
 #endif
 }
 
@@ -1600,38 +1374,483 @@ InstCount BBWithSpill::ReturnPeakSpillCost() {
 #ifdef __CUDA_ARCH__ // Device version of function
   return dev_peakSpillCost_[GLOBALTID];
 #else
-  return peakSpillCost_;
+  return ReturnPeakSpillCost(*rgnState_);
+#endif
+}
+
+/*****************************************************************************/
+
+void BBWithSpill::InitForSchdulng(AntState &State) {
+  State.crntSpillCost = 0;
+  State.crntStepNum = -1;
+  State.peakSpillCost = 0;
+  State.totSpillCost = 0;
+  State.slilSpillCost = 0;
+
+  for (int i = 0; i < regTypeCnt_; i++) {
+    for (int j = 0; j < regFiles_[i].GetRegCnt(); j++)
+      State.crntUseCnt[State.GetRegIndx(i, j)] = 0;
+
+    State.liveRegs[i].Reset();
+
+    if (regFiles_[i].GetPhysRegCnt() > 0) {
+      State.livePhysRegs[i].Reset();
+    }
+
+    State.peakRegPressures[i] = 0;
+    State.regPressures[i] = 0;
+    State.sumOfLiveIntervalLengths[i] = 0;
+  }
+
+  for (int i = 0; i < dataDepGraph_->GetInstCnt(); i++)
+    State.spillCosts[i] = 0;
+
+  State.dynamicSlilLowerBound = staticSlilLowerBound_;
+}
+
+void BBWithSpill::SchdulInst(AntState &State, SchedInstruction *inst,
+                             InstCount cycleNum, InstCount slotNum) {
+  if (inst == NULL)
+    return;
+  UpdateSpillInfoForSchdul_(GetSpillState_(State), inst, false);
+}
+
+// Conflicts are tracked through the registers themselves, so trackCnflcts may
+// only be set when updating the region's own scheduling state.
+//note: Logger::info/fatal cannot be called on device. using __HIP_DEVICE_COMPILE__ 
+//macro to call printf on device instead
+__host__ __device__
+void BBWithSpill::UpdateSpillInfoForSchdul_(const SpillStateView &State,
+                                            SchedInstruction *inst,
+                                            bool trackCnflcts) {
+  int16_t regType;
+  int defCnt, useCnt, regNum, physRegNum;
+  Register *def, *use;
+  int liveRegs;
+  InstCount newSpillCost;
+  InstCount perpValueForSlil;
+
+#ifdef IS_DEBUG_REG_PRESSURE
+  printf("Updating reg pressure after scheduling Inst %d\n", inst->GetNum());
+#endif
+
+  defCnt = inst->GetDefCnt();
+  useCnt = inst->GetUseCnt();
+
+  // Update Live regs after uses
+  for (int i = 0; i < useCnt; i++) {
+    use = GetInstReg_(inst, i, false);
+    regType = use->GetType();
+    regNum = use->GetNum();
+    physRegNum = use->GetPhysicalNumber();
+
+    if (!IsRegLive_(State, use)) {
+#ifdef __HIP_DEVICE_COMPILE__
+      printf("Reg %d of type %d is used without being defined\n", regNum,
+             regType);
+#else
+      Logger::Fatal("Reg %d of type %d is used without being defined", regNum,
+                    regType);
+#endif
+    }
+
+    AddRegUse_(State, use);
+
+    if (!IsRegLive_(State, use)) {
+      // (Chris): The SLIL calculation below the def and use for-loops doesn't
+      // consider the last use of a register. Thus, an additional increment must
+      // happen here.
+      if (needsSLIL())
+        State.SLIL(regType)++;
+
+      State.LiveRegs(regType).SetBit(regNum, false, use->GetWght());
+
+      if (State.livePhysRegs && regFiles_[regType].GetPhysRegCnt() > 0 &&
+          physRegNum >= 0)
+        State.livePhysRegs[regType].SetBit(physRegNum, false, use->GetWght());
+    }
+  }
+
+  // Update Live regs after defs
+  for (int i = 0; i < defCnt; i++) {
+    def = GetInstReg_(inst, i, true);
+    regType = def->GetType();
+    regNum = def->GetNum();
+    physRegNum = def->GetPhysicalNumber();
+
+    if (trackCnflcts && State.LiveRegs(regType).GetOneCnt() > 0)
+      regFiles_[regType].AddConflictsWithLiveRegs(
+          regNum, State.LiveRegs(regType).GetOneCnt());
+
+    State.LiveRegs(regType).SetBit(regNum, true, def->GetWght());
+
+    if (State.livePhysRegs && regFiles_[regType].GetPhysRegCnt() > 0 &&
+        physRegNum >= 0)
+      State.livePhysRegs[regType].SetBit(physRegNum, true, def->GetWght());
+    ResetRegUses_(State, def);
+  }
+
+  newSpillCost = 0;
+
+  for (int16_t i = 0; i < regTypeCnt_; i++) {
+    liveRegs = State.LiveRegs(i).GetWghtedCnt();
+    // Set current RP for register type "i"
+    State.RegPressure(i) = liveRegs;
+    // Update peak RP for register type "i"
+    if (liveRegs > State.PeakRegPressure(i))
+      State.PeakRegPressure(i) = liveRegs;
+
+    // (Chris): Compute sum of live range lengths at this point
+    if (needsSLIL())
+      State.SLIL(i) += State.LiveRegs(i).GetOneCnt();
+  }
+
+  if (GetSpillCostFunc() == SCF_SLIL) {
+    *State.slilSpillCost = CmputCostForFunction_(State, GetSpillCostFunc());
+    // calculate PERP with SLIL to consider schedules with PERP of 0
+    // even if SLIL is higher
+    perpValueForSlil = CmputCostForFunction_(State, SCF_PERP);
+    if (*State.peakSpillCost < perpValueForSlil)
+      *State.peakSpillCost = perpValueForSlil;
+  }
+  else
+    newSpillCost = CmputCostForFunction_(State, GetSpillCostFunc());
+
+  (*State.crntStepNum)++;
+  State.SpillCost(*State.crntStepNum) = newSpillCost;
+
+#ifdef IS_DEBUG_REG_PRESSURE
+  printf("Spill cost at step  %d = %d\n", *State.crntStepNum, newSpillCost);
+#endif
+
+  *State.totSpillCost += newSpillCost;
+  if (*State.peakSpillCost < newSpillCost)
+    *State.peakSpillCost = newSpillCost;
+
+  CmputCrntSpillCost_(State);
+}
+
+void BBWithSpill::UpdateSpillInfoForUnSchdul_(AntState &State,
+                                              SchedInstruction *inst) {
+  int16_t regType;
+  int i, defCnt, useCnt, regNum, physRegNum, regIndx;
+  RegIndxTuple *defs, *uses;
+  Register *def, *use;
+  bool isLive;
+
+#ifdef IS_DEBUG_REG_PRESSURE
+  Logger::Info("Updating reg pressure after unscheduling Inst %d",
+               inst->GetNum());
+#endif
+
+  defCnt = inst->GetDefs(defs);
+  useCnt = inst->GetUses(uses);
+
+  // (Chris): Update the SLIL for all live regs at this point.
+  if (GetSpillCostFunc() == SCF_SLIL) {
+    for (i = 0; i < regTypeCnt_; ++i) {
+      for (int j = 0; j < State.liveRegs[i].GetSize(); ++j) {
+        if (State.liveRegs[i].GetBit(j))
+          State.sumOfLiveIntervalLengths[i]--;
+      }
+      assert(State.sumOfLiveIntervalLengths[i] >= 0 &&
+             "UpdateSpillInfoForUnSchdul_: SLIL negative!");
+    }
+  }
+
+  // Update Live regs
+  for (i = 0; i < defCnt; i++) {
+    def = dataDepGraph_->getRegByTuple(&defs[i]);
+    regType = def->GetType();
+    regNum = def->GetNum();
+    physRegNum = def->GetPhysicalNumber();
+
+    assert(State.liveRegs[regType].GetBit(regNum));
+    State.liveRegs[regType].SetBit(regNum, false, def->GetWght());
+
+    if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
+      State.livePhysRegs[regType].SetBit(physRegNum, false, def->GetWght());
+    State.crntUseCnt[State.GetRegIndx(regType, regNum)] = 0;
+  }
+
+  for (i = 0; i < useCnt; i++) {
+    use = dataDepGraph_->getRegByTuple(&uses[i]);
+    regType = use->GetType();
+    regNum = use->GetNum();
+    physRegNum = use->GetPhysicalNumber();
+    regIndx = State.GetRegIndx(regType, regNum);
+
+    isLive = State.crntUseCnt[regIndx] < use->GetUseCnt();
+    State.crntUseCnt[regIndx]--;
+
+    if (isLive == false) {
+      // (Chris): Since this was the last use, the above SLIL calculation didn't
+      // take this instruction into account.
+      if (GetSpillCostFunc() == SCF_SLIL) {
+        State.sumOfLiveIntervalLengths[regType]--;
+        assert(State.sumOfLiveIntervalLengths[regType] >= 0 &&
+               "UpdateSpillInfoForUnSchdul_: SLIL negative!");
+      }
+      State.liveRegs[regType].SetBit(regNum, true, use->GetWght());
+
+      if (regFiles_[regType].GetPhysRegCnt() > 0 && physRegNum >= 0)
+        State.livePhysRegs[regType].SetBit(physRegNum, true, use->GetWght());
+    }
+  }
+
+  State.totSpillCost -= State.spillCosts[State.crntStepNum];
+  State.crntStepNum--;
+}
+
+__host__ __device__
+void BBWithSpill::CmputCrntSpillCost_(const SpillStateView &State) {
+  switch (GetSpillCostFunc()) {
+  case SCF_PERP:
+  case SCF_PRP:
+  case SCF_PEAK_PER_TYPE:
+  case SCF_TARGET:
+    *State.crntSpillCost = *State.peakSpillCost;
+    break;
+  case SCF_SUM:
+    *State.crntSpillCost = *State.totSpillCost;
+    break;
+  case SCF_PEAK_PLUS_AVG:
+    *State.crntSpillCost = *State.peakSpillCost +
+                           *State.totSpillCost / dataDepGraph_->GetInstCnt();
+    break;
+  case SCF_SLIL:
+    *State.crntSpillCost = *State.slilSpillCost;
+    break;
+  default:
+    *State.crntSpillCost = *State.peakSpillCost;
+    break;
+  }
+}
+
+InstCount BBWithSpill::CmputCostForFunction(const AntState &State,
+                                            SPILL_COST_FUNCTION SpillCF) {
+  // The view is only read
+  return CmputCostForFunction_(GetSpillState_(const_cast<AntState &>(State)),
+                               SpillCF);
+}
+
+__host__ __device__
+InstCount BBWithSpill::CmputCostForFunction_(const SpillStateView &State,
+                                             SPILL_COST_FUNCTION SpillCF) {
+  // return the requested cost
+  switch (SpillCF) {
+  case SCF_TARGET: {
+#ifdef __HIP_DEVICE_COMPILE__
+    return getAMDGPUCost(State.regPressures, TargetOccupancy_, MaxOccLDS_,
+                         regTypeCnt_);
+#else
+    SmallVector<unsigned, 8> PRP;
+    for (int i = 0; i < regTypeCnt_; i++)
+      PRP.push_back(State.RegPressure(i));
+    return OST->getCost(PRP);
 #endif
+  }
+  case SCF_SLIL: {
+    InstCount SLILCost = 0;
+    for (int i = 0; i < regTypeCnt_; i ++)
+      SLILCost += State.SLIL(i);
+    return SLILCost;
+  }
+  case SCF_PRP: {
+    InstCount PRPCost = 0;
+    for (int i = 0; i < regTypeCnt_; i ++)
+      PRPCost += State.RegPressure(i);
+    return PRPCost;
+  }
+  case SCF_PEAK_PER_TYPE: {
+    InstCount SC = 0;
+    InstCount inc;
+    for (int i = 0; i < regTypeCnt_; i++) {
+      inc = State.PeakRegPressure(i) - machMdl_->GetPhysRegCnt(i);
+      if (inc > 0)
+        SC += inc;
+    }
+    return SC;
+  }
+  default: {
+    // Default is PERP (Some SCF like SUM rely on PERP being the default here)
+    InstCount inc;
+    InstCount SC = 0;
+    for (int i = 0; i < regTypeCnt_; i ++) {
+      inc = State.RegPressure(i) - machMdl_->GetPhysRegCnt(i);
+      if (inc > 0)
+        SC += inc;
+    }
+    return SC;
+  }
+  }
+}
+
+SpillStateView BBWithSpill::GetSpillState_(AntState &State) {
+  SpillStateView View;
+  View.liveRegs = State.liveRegs;
+  View.livePhysRegs = State.livePhysRegs;
+  View.regPressures = State.regPressures.data();
+  View.peakRegPressures = State.peakRegPressures;
+  View.sumOfLiveIntervalLengths = State.sumOfLiveIntervalLengths;
+  View.spillCosts = State.spillCosts;
+  View.crntStepNum = &State.crntStepNum;
+  View.peakSpillCost = &State.peakSpillCost;
+  View.totSpillCost = &State.totSpillCost;
+  View.slilSpillCost = &State.slilSpillCost;
+  View.crntSpillCost = &State.crntSpillCost;
+  View.crntUseCnt = State.crntUseCnt;
+  View.regOffsets = State.regOffsets;
+  View.stride = 1;
+  return View;
+}
+
+__device__
+SpillStateView BBWithSpill::GetDevSpillState_() {
+  // CopyPointersToDevice() places the live register sets of all types and
+  // threads in one array, in the same order as the other arrays.
+  SpillStateView View;
+  View.liveRegs = &dev_liveRegs_[0][GLOBALTID];
+  View.livePhysRegs = NULL;
+  View.regPressures = &dev_regPressures_[GLOBALTID];
+  View.peakRegPressures = &dev_peakRegPressures_[GLOBALTID];
+  View.sumOfLiveIntervalLengths =
+      needsSLIL() ? &dev_sumOfLiveIntervalLengths_[GLOBALTID] : NULL;
+  View.spillCosts = &dev_spillCosts_[GLOBALTID];
+  View.crntStepNum = &dev_crntStepNum_[GLOBALTID];
+  View.peakSpillCost = &dev_peakSpillCost_[GLOBALTID];
+  View.totSpillCost = &dev_totSpillCost_[GLOBALTID];
+  View.slilSpillCost = needsSLIL() ? &dev_slilSpillCost_[GLOBALTID] : NULL;
+  View.crntSpillCost = &dev_crntSpillCost_[GLOBALTID];
+  View.crntUseCnt = NULL;
+  View.regOffsets = NULL;
+  View.stride = numThreads_;
+  return View;
+}
+
+__host__ __device__
+llvm::opt_sched::Register *
+BBWithSpill::GetInstReg_(SchedInstruction *inst, int16_t indx, bool isDef) {
+#ifdef __HIP_DEVICE_COMPILE__
+  const DDGBlobView &ddgBlob = dataDepGraph_->GetDevDDGBlob();
+  RegIndxTuple tuple = isDef ? ddgBlob.GetDef(inst->GetNum(), indx)
+                             : ddgBlob.GetUse(inst->GetNum(), indx);
+  return dataDepGraph_->getRegByTuple(&tuple);
+#else
+  RegIndxTuple *regs;
+  if (isDef)
+    inst->GetDefs(regs);
+  else
+    inst->GetUses(regs);
+  return dataDepGraph_->getRegByTuple(&regs[indx]);
+#endif
+}
+
+__host__ __device__
+bool BBWithSpill::IsRegLive_(const SpillStateView &State, Register *reg) {
+  if (!State.crntUseCnt)
+    return reg->IsLive();
+  int regIndx = State.regOffsets[reg->GetType()] + reg->GetNum();
+  return State.crntUseCnt[regIndx] < reg->GetUseCnt();
+}
+
+__host__ __device__
+void BBWithSpill::AddRegUse_(const SpillStateView &State, Register *reg) {
+  if (!State.crntUseCnt)
+    reg->AddCrntUse();
+  else
+    State.crntUseCnt[State.regOffsets[reg->GetType()] + reg->GetNum()]++;
+}
+
+__host__ __device__
+void BBWithSpill::ResetRegUses_(const SpillStateView &State, Register *reg) {
+  if (!State.crntUseCnt)
+    reg->ResetCrntUseCnt();
+  else
+    State.crntUseCnt[State.regOffsets[reg->GetType()] + reg->GetNum()] = 0;
+}
+
+InstCount BBWithSpill::GetCrntSpillCost(const AntState &State) const {
+  return State.crntSpillCost;
+}
+
+InstCount BBWithSpill::ReturnPeakSpillCost(const AntState &State) const {
+  return State.peakSpillCost;
+}
+
+bool BBWithSpill::IsRPHigh(const AntState &State, int regType) const {
+  return State.regPressures[regType] >
+         (unsigned int) machMdl_->GetPhysRegCnt(regType);
+}
+
+const int *BBWithSpill::GetSLIL_() const {
+  return rgnState_->sumOfLiveIntervalLengths;
+}
+
+void BBWithSpill::UpdateScheduleCost(AntState &State, InstSchedule *sched) {
+  if (GetSpillCostFunc() == SCF_SPILLS) {
+    LocalRegAlloc regAlloc(sched, dataDepGraph_);
+    regAlloc.SetupForRegAlloc();
+    regAlloc.AllocRegs();
+    State.crntSpillCost = regAlloc.GetCost();
+  }
+
+  assert(sched->IsComplete());
+  InstCount execCost = sched->GetCrntLngth() * schedCostFactor_;
+  InstCount cost = execCost + State.crntSpillCost * SCW_;
+  sched->SetSpillCosts(State.spillCosts);
+  sched->SetPeakRegPressures(State.peakRegPressures);
+  sched->SetSpillCost(State.crntSpillCost);
+
+  cost -= GetCostLwrBound();
+  execCost -= GetExecCostLwrBound();
+
+  sched->SetCost(cost);
+  sched->SetExecCost(execCost);
+  sched->SetNormSpillCost(sched->GetSpillCost() * SCW_ - GetRPCostLwrBound());
+}
+
+InstCount BBWithSpill::CmputCostLwrBound(const AntState &State,
+                                         InstCount lngthLB,
+                                         bool spillOnly) {
+  // Every other spill cost function only accumulates non-negative per-step
+  // costs or takes their maximum, so the current cost can only grow.
+  if (GetSpillCostFunc() == SCF_SPILLS)
+    return INVALID_VALUE;
+
+  InstCount spillCost = State.crntSpillCost * SCW_;
+  if (spillOnly)
+    return spillCost - GetRPCostLwrBound();
+  return lngthLB * schedCostFactor_ + spillCost - GetCostLwrBound();
 }
 
 void BBWithSpill::AllocDevArraysForParallelACO(int numThreads) {
-  // Temporarily holds large hipMalloc arrays as they are divided
-  InstCount *temp;
-  unsigned *u_temp;
+  // The arrays are kept by the ACO context and reused by the next region
+  ACOContext &Ctx = ACOContext::getInstance();
   size_t memSize = sizeof(InstCount) * numThreads;
-  hipMalloc(&dev_crntCycleNum_, memSize);
-  hipMalloc(&dev_crntSlotNum_, memSize);
-  hipMalloc(&dev_crntSpillCost_, memSize);
-  hipMalloc(&dev_crntStepNum_, memSize);
-  hipMalloc(&dev_peakSpillCost_, memSize);
-  hipMalloc(&dev_totSpillCost_, memSize);
+  dev_crntCycleNum_ = (InstCount *)Ctx.AllocDevArray(memSize);
+  dev_crntSlotNum_ = (InstCount *)Ctx.AllocDevArray(memSize);
+  dev_crntSpillCost_ = (InstCount *)Ctx.AllocDevArray(memSize);
+  dev_crntStepNum_ = (InstCount *)Ctx.AllocDevArray(memSize);
+  dev_peakSpillCost_ = (InstCount *)Ctx.AllocDevArray(memSize);
+  dev_totSpillCost_ = (InstCount *)Ctx.AllocDevArray(memSize);
   if (needsSLIL()) {
-    hipMalloc(&dev_slilSpillCost_, memSize);
-    hipMalloc(&dev_dynamicSlilLowerBound_, memSize);
+    dev_slilSpillCost_ = (InstCount *)Ctx.AllocDevArray(memSize);
+    dev_dynamicSlilLowerBound_ = (InstCount *)Ctx.AllocDevArray(memSize);
   }
   memSize = sizeof(int) * numThreads;
-  hipMalloc(&dev_schduldInstCnt_, memSize);
+  dev_schduldInstCnt_ = (int *)Ctx.AllocDevArray(memSize);
   memSize = sizeof(WeightedBitVector *) * regTypeCnt_;
-  hipMallocManaged(&dev_liveRegs_, memSize);
+  dev_liveRegs_ = (WeightedBitVector **)Ctx.AllocDevArray(memSize, true);
   memSize = sizeof(InstCount) * regTypeCnt_ * numThreads;
-  hipMalloc(&dev_peakRegPressures_, memSize);
+  dev_peakRegPressures_ = (InstCount *)Ctx.AllocDevArray(memSize);
   memSize = sizeof(unsigned) * regTypeCnt_ * numThreads;
-  hipMalloc(&dev_regPressures_, memSize);
+  dev_regPressures_ = (unsigned *)Ctx.AllocDevArray(memSize);
   memSize = sizeof(InstCount) * dataDepGraph_->GetInstCnt() * numThreads;
-  hipMalloc(&dev_spillCosts_, memSize);
+  dev_spillCosts_ = (InstCount *)Ctx.AllocDevArray(memSize);
   if (needsSLIL()) {
     memSize = sizeof(int) * regTypeCnt_ * numThreads;
-    hipMalloc(&dev_sumOfLiveIntervalLengths_, memSize);
+    dev_sumOfLiveIntervalLengths_ = (int *)Ctx.AllocDevArray(memSize);
   }
 }
 
@@ -1644,20 +1863,21 @@ void BBWithSpill::CopyPointersToDevice(SchedRegion* dev_rgn, int numThreads) {
   WeightedBitVector *temp_bv;
   unsigned int *dev_vctr = NULL;
   int unitCnt, indx = 0;
-  // Find totUnitCnt to determine size of vctr for all liveRegs_
+  // Find totUnitCnt to determine size of vctr for all liveRegs
   int totUnitCnt = 0;
   for (int i = 0; i < regTypeCnt_; i++) {
-    totUnitCnt += liveRegs_[i].GetUnitCnt();
+    totUnitCnt += rgnState_->liveRegs[i].GetUnitCnt();
     // set one bit, so oneCnt_ is nonzero to force reset of vctrs on device
-    if (liveRegs_[i].GetUnitCnt() > 0)
-      liveRegs_[i].SetBit(0,true,1);
+    if (rgnState_->liveRegs[i].GetUnitCnt() > 0)
+      rgnState_->liveRegs[i].SetBit(0,true,1);
   }
   // Allocate vctr for all dev_liveRegs
+  ACOContext &Ctx = ACOContext::getInstance();
   memSize = totUnitCnt * sizeof(unsigned int) * numThreads;
-  gpuErrchk(hipMalloc((void**)&dev_vctr, memSize));
+  dev_vctr = (unsigned int *)Ctx.AllocDevArray(memSize);
   // prepare temp host array to copy all dev_liveRegs in one call
   memSize = regTypeCnt_ * sizeof(WeightedBitVector) * numThreads;
-  gpuErrchk(hipMallocManaged((void**)&dev_temp_liveRegs, memSize));
+  dev_temp_liveRegs = (WeightedBitVector *)Ctx.AllocDevArray(memSize, true);
   temp_bv = (WeightedBitVector *)malloc(memSize);
   // temp array laid out in the format temp_bv[liveRegIndx][TID]
   // so that all of the threads have their copy of liveRegs
@@ -1665,7 +1885,7 @@ void BBWithSpill::CopyPointersToDevice(SchedRegion* dev_rgn, int numThreads) {
   memSize = sizeof(WeightedBitVector);
   for (int i = 0; i < regTypeCnt_; i++)
     for (int j = 0; j < numThreads; j++)
-      memcpy(&temp_bv[(i * numThreads) + j], &liveRegs_[i], memSize);
+      memcpy(&temp_bv[(i * numThreads) + j], &rgnState_->liveRegs[i], memSize);
   // copy formatted host array to device
   memSize = regTypeCnt_ * sizeof(WeightedBitVector) * numThreads;
   gpuErrchk(hipMemcpy(dev_temp_liveRegs, temp_bv, memSize,
@@ -1679,7 +1899,7 @@ void BBWithSpill::CopyPointersToDevice(SchedRegion* dev_rgn, int numThreads) {
   // dev_temp_liveRegs
   indx = 0;
   for (int i = 0; i < regTypeCnt_; i++) {
-    unitCnt = liveRegs_[i].GetUnitCnt();
+    unitCnt = rgnState_->liveRegs[i].GetUnitCnt();
     for (int j = 0; j < numThreads; j++) {
       if (unitCnt > 0) {
         dev_temp_liveRegs[(i * numThreads) + j].vctr_ = &dev_vctr[indx];
@@ -1698,24 +1918,3 @@ void BBWithSpill::CopyPointersToDevice(SchedRegion* dev_rgn, int numThreads) {
   memSize = sizeof(WeightedBitVector *) * regTypeCnt_;
   gpuErrchk(hipMemPrefetchAsync(dev_liveRegs_, memSize, 0));
 }
-
-void BBWithSpill::FreeDevicePointers(int numThreads) {
-  hipFree(dev_liveRegs_[0][0].vctr_);
-  hipFree(dev_liveRegs_[0]);
-  hipFree(dev_liveRegs_);
-  hipFree(dev_crntCycleNum_);
-  hipFree(dev_crntSlotNum_);
-  hipFree(dev_crntSpillCost_);
-  hipFree(dev_crntStepNum_);
-  hipFree(dev_peakSpillCost_);
-  hipFree(dev_totSpillCost_);
-  if (needsSLIL()) {
-    hipFree(dev_slilSpillCost_);
-    hipFree(dev_dynamicSlilLowerBound_);
-    hipFree(dev_sumOfLiveIntervalLengths_);
-  }
-  hipFree(dev_schduldInstCnt_);
-  hipFree(dev_peakRegPressures_);
-  hipFree(dev_regPressures_);
-  hipFree(dev_spillCosts_);
-}
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/aco_context.h"
 #include "opt-sched/Scheduler/graph_trans.h"
 #include "opt-sched/Scheduler/logger.h"
 #include "opt-sched/Scheduler/machine_model.h"
@@ -2699,23 +2700,58 @@ InstCount DataDepSubGraph::GetDistFrmLeaf(SchedInstruction *inst) {
 }
 */
 
+// The schedule hash is the polynomial sum of its slot values, with stalls
+// mapped to 1 and instruction i to i + 3. The multiplier is odd, so its
+// inverse modulo 2^64 removes the last slot again.
+constexpr uint64_t SCHED_HASH_MULT = 0x100000001b3ULL;
+constexpr uint64_t SCHED_HASH_MULT_INV = 0xce965057aff6957bULL;
+
+__host__ __device__
+static inline uint64_t SchedHashValue(InstCount instNum) {
+  return (uint64_t)(instNum - SCHD_STALL + 1);
+}
+
 InstSchedule::InstSchedule(MachineModel *machMdl, DataDepGraph *dataDepGraph,
                            bool vrfy) {
+  vrfy_ = vrfy;
+  instInSlot_ = NULL;
+  slotForInst_ = NULL;
+  spillCosts_ = NULL;
+  peakRegPressures_ = NULL;
+  instCap_ = 0;
+  slotCap_ = 0;
+  regTypeCap_ = 0;
+  dev_instInSlot_ = NULL;
+  dev_slotForInst_ = NULL;
+  dev_spillCosts_ = NULL;
+  dev_peakRegPressures_ = NULL;
+  Reinit(machMdl, dataDepGraph);
+}
+
+void InstSchedule::Reinit(MachineModel *machMdl, DataDepGraph *dataDepGraph) {
   machMdl_ = machMdl;
   issuRate_ = machMdl->GetIssueRate();
   totInstCnt_ = dataDepGraph->GetInstCnt();
   schedUprBound_ = dataDepGraph->GetAbslutSchedUprBound();
   totSlotCnt_ = schedUprBound_ * issuRate_;
-  vrfy_ = vrfy;
 
-  instInSlot_ = new InstCount[totSlotCnt_];
-  slotForInst_ = new InstCount[totInstCnt_];
-  spillCosts_ = new InstCount[totInstCnt_];
-  peakRegPressures_ = new InstCount[machMdl->GetRegTypeCnt()];
-  dev_instInSlot_ = NULL;
-  dev_slotForInst_ = NULL;
-  dev_spillCosts_ = NULL;
-  dev_peakRegPressures_ = NULL;
+  if (totSlotCnt_ > slotCap_) {
+    delete[] instInSlot_;
+    instInSlot_ = new InstCount[totSlotCnt_];
+    slotCap_ = totSlotCnt_;
+  }
+  if (totInstCnt_ > instCap_) {
+    delete[] slotForInst_;
+    delete[] spillCosts_;
+    slotForInst_ = new InstCount[totInstCnt_];
+    spillCosts_ = new InstCount[totInstCnt_];
+    instCap_ = totInstCnt_;
+  }
+  if (machMdl->GetRegTypeCnt() > regTypeCap_) {
+    delete[] peakRegPressures_;
+    peakRegPressures_ = new InstCount[machMdl->GetRegTypeCnt()];
+    regTypeCap_ = machMdl->GetRegTypeCnt();
+  }
 
   InstCount i;
 
@@ -2741,9 +2777,13 @@ InstSchedule::InstSchedule(MachineModel *machMdl, DataDepGraph *dataDepGraph,
   totalStalls_ = 0;
   unnecessaryStalls_ = 0;
   isZeroPerp_ = false;
+  hash_ = 0;
 }
 
 InstSchedule::InstSchedule() {
+  instCap_ = 0;
+  slotCap_ = 0;
+  regTypeCap_ = 0;
   schduldInstCnt_ = 0;
   crntSlotNum_ = 0;
   maxSchduldInstCnt_ = 0;
@@ -2757,6 +2797,7 @@ InstSchedule::InstSchedule() {
   totalStalls_ = 0;
   unnecessaryStalls_ = 0;
   isZeroPerp_ = false;
+  hash_ = 0;
 }
 
 InstSchedule::~InstSchedule() {
@@ -2771,6 +2812,8 @@ bool InstSchedule::operator==(InstSchedule &b) const {
     return false;
   if (b.crntSlotNum_ != crntSlotNum_)
     return false;
+  if (b.hash_ != hash_)
+    return false;
   for (InstCount i = 0; i < crntSlotNum_; i++) {
     if (b.instInSlot_[i] != instInSlot_[i])
       return false;
@@ -2812,6 +2855,7 @@ bool InstSchedule::AppendInst(InstCount instNum) {
 #ifdef IS_DEBUG_SCHED2
   printf("INFO: Instructions Scheduled: %d\n", schduldInstCnt_);
 #endif
+  hash_ = hash_ * SCHED_HASH_MULT + SchedHashValue(instNum);
   crntSlotNum_++;
   return true;
 
@@ -2842,6 +2886,7 @@ bool InstSchedule::AppendInst(InstCount instNum) {
 #ifdef IS_DEBUG_SCHED2
   Logger::Info("Instructions Scheduled: %d", schduldInstCnt_);
 #endif
+  hash_ = hash_ * SCHED_HASH_MULT + SchedHashValue(instNum);
   crntSlotNum_++;
   return true;
 #endif
@@ -2855,6 +2900,7 @@ bool InstSchedule::RemoveLastInst() {
   crntSlotNum_--;
   InstCount instNum = instInSlot_[crntSlotNum_];
   instInSlot_[crntSlotNum_] = INVALID_VALUE;
+  hash_ = (hash_ - SchedHashValue(instNum)) * SCHED_HASH_MULT_INV;
 
   if (instNum != SCHD_STALL) {
     slotForInst_[instNum] = INVALID_VALUE;
@@ -2924,7 +2970,7 @@ void InstSchedule::Reset() {
   }
 #else
   if (vrfy_) {
-    for (i = 0; i < maxInstNumSchduld_; i++) {
+    for (i = 0; i <= maxInstNumSchduld_; i++) {
       slotForInst_[i] = SCHD_UNSCHDULD;
     }
 
@@ -2939,6 +2985,7 @@ void InstSchedule::Reset() {
   maxSchduldInstCnt_ = 0;
   maxInstNumSchduld_ = -1;
   cost_ = INVALID_VALUE;
+  hash_ = 0;
 }
 
 __host__ __device__
@@ -3422,6 +3469,7 @@ void InstSchedule::Initialize() {
   totSpillCost_ = 0;
   cnflctCnt_ = 0;
   spillCnddtCnt_ = 0;
+  hash_ = 0;
 }
 
 /*******************************************************************************
@@ -3609,175 +3657,51 @@ bool DataDepGraph::DoesFeedUser(SchedInstruction *inst) {
 
 int DataDepGraph::GetFileCostUprBound() { return fileCostUprBound_; }
 
-void DataDepGraph::CopyPointersToDevice(DataDepGraph *dev_DDG, int numThreads) {
+void DataDepGraph::CopyToDevice(DataDepGraph *dev_DDG, const DDGBlob &ddgBlob,
+                                int numThreads) {
+  ACOContext &Ctx = ACOContext::getInstance();
   // use to hold size of array
   size_t memSize;
-  // Copy insts_ to device
-  SchedInstruction *dev_insts;
-  memSize = sizeof(SchedInstruction) * instCnt_;
-  gpuErrchk(hipMallocManaged(&dev_insts, memSize));
-  gpuErrchk(hipMemcpy(dev_insts, insts_, memSize,
-	               hipMemcpyHostToDevice));
-  gpuErrchk(hipMemcpy(&dev_DDG->insts_, &dev_insts, 
-		       sizeof(SchedInstruction *), 
-		       hipMemcpyHostToDevice));
-  // update values of root_ and leaf_ on device
-  SchedInstruction *dev_root = &dev_insts[root_->GetNum()];
+  // Give each instruction a slice of numThreads values in one array per
+  // value, and store what the device cannot compute before the copy
+  memSize = sizeof(int16_t) * instCnt_ * numThreads;
+  int16_t *dev_lastUseCnts = (int16_t *)Ctx.AllocDevArray(memSize);
+  memSize = sizeof(InstCount) * instCnt_ * numThreads;
+  InstCount *dev_minRdyCycles = (InstCount *)Ctx.AllocDevArray(memSize);
+  InstCount *dev_unschduldPrdcsrCnts = (InstCount *)Ctx.AllocDevArray(memSize);
+  for (InstCount i = 0; i < instCnt_; i++)
+    insts_[i].SetupForDevice(&dev_lastUseCnts[i * numThreads],
+                             &dev_minRdyCycles[i * numThreads],
+                             &dev_unschduldPrdcsrCnts[i * numThreads]);
   // set dev_IsRoot to be used on device to check if it is the root
-  dev_root->SetDevIsRoot();
-  memSize = sizeof(SchedInstruction *);
-  gpuErrchk(hipMemcpy(&dev_DDG->root_, &dev_root, memSize,
-	               hipMemcpyHostToDevice));
-  SchedInstruction *dev_leaf = &dev_insts[leaf_->GetNum()];
-  gpuErrchk(hipMemcpy(&dev_DDG->leaf_, &dev_leaf, memSize,
-	               hipMemcpyHostToDevice));
-  // Copy RegFiles
-  RegisterFile *dev_regFiles;
-  memSize = sizeof(RegisterFile) * machMdl_->GetRegTypeCnt();
-  gpuErrchk(hipMallocManaged(&dev_regFiles, memSize));
-  gpuErrchk(hipMemcpy(dev_regFiles, RegFiles, memSize,
-		       hipMemcpyHostToDevice));
-  gpuErrchk(hipMemcpy(&dev_DDG->RegFiles, &dev_regFiles, 
-		       sizeof(RegisterFile *), hipMemcpyHostToDevice));
-  // Also copy each RegFile's pointers
-  for (InstCount i = 0; i < machMdl_->GetRegTypeCnt(); i++)
-    RegFiles[i].CopyPointersToDevice(&dev_DDG->RegFiles[i]);
-  
+  root_->SetDevIsRoot();
 
+  // Copy insts_ to device. The edges are not copied, the device reads them
+  // from the image.
   Logger::Info("Copying SchedInstructions to device");
-  // count the number of elements in predecessor/successor lists
-  // used to malloc the large elements array
-  int lngthScsrElmnts = 0;
-  int lengthLatencies = 0;
-  int lengthUses = 0;
-  int lengthDefs = 0;
-  for (InstCount i = 0; i < instCnt_; i++) {
-    lngthScsrElmnts += insts_[i].GetScsrCnt();
-    lengthLatencies += insts_[i].GetPrdcsrCnt();
-    lengthUses += insts_[i].GetUseCnt();
-    lengthDefs += insts_[i].GetDefCnt();
-  }
-
-  scsrs_ = new int[lngthScsrElmnts];
-  latencies_ = new int[lngthScsrElmnts];
-  predOrder_ = new int[lngthScsrElmnts];
-  uses_ = new RegIndxTuple[lengthUses];
-  defs_ = new RegIndxTuple[lengthDefs];
-  ltncyPerPrdcsr_ = new int[lengthLatencies];
-
-  int indexOffset = 0;
-  int indexPredecessorOffset = 0;
-  int indexUseOffset = 0;
-  int indexDefOffset = 0;
-
-  for (InstCount i = 0; i < instCnt_; i++) {
-    DependenceType _dep;
-    insts_[i].ddgIndex = indexOffset;
-    insts_[i].ddgPredecessorIndex = indexPredecessorOffset;
-    insts_[i].ddgUseIndex = indexUseOffset;
-    insts_[i].ddgDefIndex = indexDefOffset;
-
-
-    int prdcsrNum, latency, toNodeNum;
-    // Partition scsrs_, latencies_, predOrder_ for each SchedInstruction.
-    for (SchedInstruction *crntScsr = insts_[i].GetFrstScsr(&prdcsrNum, 
-                                              &latency,
-                                              &_dep, 
-                                              &toNodeNum);
-      crntScsr != NULL; 
-      crntScsr = insts_[i].GetNxtScsr(&prdcsrNum, &latency, &_dep, &toNodeNum)) {
-        scsrs_[indexOffset] = toNodeNum;
-        latencies_[indexOffset] = latency;
-        predOrder_[indexOffset] = prdcsrNum;
-        indexOffset += 1;
-    }
-
-    // Partition uses_ for each SchedInstruction.
-    RegIndxTuple *myUses;
-    int numUses;
-    numUses = insts_[i].GetUses(myUses);
-    for (int j = 0; j < numUses; j++) {
-      uses_[indexUseOffset++] = myUses[j]; 
-    }
-
-    // Partition defs_ for each SchedInstruction.
-    RegIndxTuple *myDefs;
-    int numDefs;
-    numDefs = insts_[i].GetDefs(myDefs);
-    for (int j = 0; j < numDefs; j++) {
-      defs_[indexDefOffset++] = myDefs[j]; 
-    }
-
-    // Partition ltncyPerPrdcsr_ for each SchedInstruction.
-    int scsrNum;
-    for (SchedInstruction *crntPrdcsr = insts_[i].GetFrstPrdcsr(&scsrNum, 
-                                              &latency,
-                                              &_dep, 
-                                              &toNodeNum);
-      crntPrdcsr != NULL; 
-      crntPrdcsr = insts_[i].GetNxtPrdcsr(&scsrNum, &latency, &_dep, &toNodeNum)) {
-        ltncyPerPrdcsr_[indexPredecessorOffset] = latency;
-        indexPredecessorOffset += 1;
-    }
-
-    // Copy SchedInstruction/GraphNode pointers and link them to device inst
-    // and update RegFiles pointer to dev_regFiles
-    insts_[i].CopyPointersToDevice(&dev_DDG->insts_[i], dev_DDG->insts_,
-                                   dev_regFiles);
-  }
-  memSize = sizeof(int) * lngthScsrElmnts;
-  gpuErrchk(hipMalloc(&(dev_DDG->scsrs_), memSize));
-  gpuErrchk(hipMalloc(&(dev_DDG->latencies_), memSize));
-  gpuErrchk(hipMalloc(&(dev_DDG->predOrder_), memSize));
-
-  gpuErrchk(hipMemcpy(dev_DDG->scsrs_, scsrs_, memSize, hipMemcpyHostToDevice));
-  gpuErrchk(hipMemcpy(dev_DDG->latencies_, latencies_, memSize, hipMemcpyHostToDevice));
-  gpuErrchk(hipMemcpy(dev_DDG->predOrder_, predOrder_, memSize, hipMemcpyHostToDevice));
-
-  memSize = sizeof(RegIndxTuple) * lengthUses;
-  gpuErrchk(hipMalloc(&(dev_DDG->uses_), memSize));
-  gpuErrchk(hipMemcpy(dev_DDG->uses_, uses_, memSize, hipMemcpyHostToDevice));
-
-  memSize = sizeof(RegIndxTuple) * lengthDefs;
-  gpuErrchk(hipMalloc(&(dev_DDG->defs_), memSize));
-  gpuErrchk(hipMemcpy(dev_DDG->defs_, defs_, memSize, hipMemcpyHostToDevice));
-
-  memSize = sizeof(int) * lengthLatencies;
-  gpuErrchk(hipMalloc(&(dev_DDG->ltncyPerPrdcsr_), memSize));
-  gpuErrchk(hipMemcpy(dev_DDG->ltncyPerPrdcsr_, ltncyPerPrdcsr_, memSize, hipMemcpyHostToDevice));
-
   memSize = sizeof(SchedInstruction) * instCnt_;
-  gpuErrchk(hipMemPrefetchAsync(dev_insts, memSize, 0));
+  SchedInstruction *dev_insts = (SchedInstruction *)Ctx.AllocDevArray(memSize);
+  gpuErrchk(hipMemcpy(dev_insts, insts_, memSize, hipMemcpyHostToDevice));
+  dev_DDG->insts_ = dev_insts;
+  dev_DDG->root_ = &dev_insts[root_->GetNum()];
+  dev_DDG->leaf_ = &dev_insts[leaf_->GetNum()];
+
+  // Copy RegFiles. They are written by the host when their registers are
+  // copied, so they are kept in managed memory.
   memSize = sizeof(RegisterFile) * machMdl_->GetRegTypeCnt();
+  RegisterFile *dev_regFiles = (RegisterFile *)Ctx.AllocDevArray(memSize, true);
+  memcpy(dev_regFiles, RegFiles, memSize);
+  for (InstCount i = 0; i < machMdl_->GetRegTypeCnt(); i++)
+    RegFiles[i].CopyToDevice(&dev_regFiles[i], numThreads);
+  dev_DDG->RegFiles = dev_regFiles;
   gpuErrchk(hipMemPrefetchAsync(dev_regFiles, memSize, 0));
 
-  // Clean up temporary host arrays
-  delete[] scsrs_;
-  delete[] latencies_;
-  delete[] predOrder_;
-  delete[] ltncyPerPrdcsr_;
-  delete[] uses_;
-  delete[] defs_;
-}
-
-void DataDepGraph::FreeDevicePointers(int numThreads) {
-  for (InstCount i = 0; i < machMdl_->GetRegTypeCnt(); i++)
-    RegFiles[i].FreeDevicePointers();
-  hipFree(RegFiles);
-  for (InstCount i = 0; i < instCnt_; i++)
-    insts_[i].FreeDevicePointers(numThreads);
-  hipFree(insts_);
-  hipFree(scsrs_);
-  hipFree(latencies_);
-  hipFree(predOrder_);
-  hipFree(uses_);
-  hipFree(defs_);
-  hipFree(ltncyPerPrdcsr_);
-}
-
-void DataDepGraph::FreeDevEdges() {
-  if (dev_edges_)
-    hipFree(dev_edges_);
+  // Upload the image as one buffer
+  memSize = ddgBlob.GetSize();
+  int32_t *dev_words = (int32_t *)Ctx.AllocDevArray(memSize);
+  gpuErrchk(hipMemcpy(dev_words, ddgBlob.GetData(), memSize,
+                      hipMemcpyHostToDevice));
+  dev_DDG->dev_ddgBlob_ = DDGBlobView(dev_words);
 }
 
 /*
@@ -0,0 +1,260 @@
+#include "opt-sched/Scheduler/ddg_blob.h"
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/random.h"
+#include "opt-sched/Scheduler/register.h"
+#include <cstring>
+
+using namespace llvm::opt_sched;
+
+void DDGBlob::Build(DataDepGraph *dataDepGraph) {
+  InstCount instCnt = dataDepGraph->GetInstCnt();
+  int16_t regTypeCnt = dataDepGraph->GetRegTypeCnt();
+  RegisterFile *regFiles = dataDepGraph->getRegFiles();
+
+  storage_.assign(HDR_FIELD_CNT, 0);
+  storage_[HDR_MAGIC] = MAGIC;
+  storage_[HDR_VERSION] = VERSION;
+  storage_[HDR_INST_CNT] = instCnt;
+  storage_[HDR_REG_TYPE_CNT] = regTypeCnt;
+
+  storage_[HDR_INSTS] = storage_.size();
+  for (InstCount i = 0; i < instCnt; i++) {
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    storage_.push_back(inst->GetInstType());
+    storage_.push_back(inst->GetIssueType());
+    storage_.push_back(inst->GetMaxLtncy());
+    storage_.push_back((inst->IsPipelined() ? INST_PIPELINED : 0) |
+                     (inst->MustBeInBBEntry() ? INST_BB_ENTRY : 0));
+  }
+
+  // The offsets are filled in once the edges are appended after them
+  storage_[HDR_SCSR_OFFSETS] = storage_.size();
+  storage_.resize(storage_.size() + instCnt + 1);
+  storage_[HDR_SCSRS] = storage_.size();
+  int32_t edgeCnt = 0;
+  for (InstCount i = 0; i < instCnt; i++) {
+    storage_[storage_[HDR_SCSR_OFFSETS] + i] = edgeCnt;
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    UDT_GLABEL ltncy;
+    DependenceType depType;
+    InstCount scsrNum;
+    for (SchedInstruction *scsr =
+             inst->GetFrstScsr(NULL, &ltncy, &depType, &scsrNum);
+         scsr != NULL;
+         scsr = inst->GetNxtScsr(NULL, &ltncy, &depType, &scsrNum)) {
+      storage_.push_back(scsrNum);
+      storage_.push_back(ltncy);
+      storage_.push_back(depType);
+      storage_.push_back(0);
+      edgeCnt++;
+    }
+  }
+  storage_[storage_[HDR_SCSR_OFFSETS] + instCnt] = edgeCnt;
+  storage_[HDR_EDGE_CNT] = edgeCnt;
+
+  storage_[HDR_PRDCSR_OFFSETS] = storage_.size();
+  storage_.resize(storage_.size() + instCnt + 1);
+  storage_[HDR_PRDCSRS] = storage_.size();
+  int32_t prdcsrCnt = 0;
+  for (InstCount i = 0; i < instCnt; i++) {
+    storage_[storage_[HDR_PRDCSR_OFFSETS] + i] = prdcsrCnt;
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    UDT_GLABEL ltncy;
+    DependenceType depType;
+    InstCount prdcsrNum;
+    for (SchedInstruction *prdcsr =
+             inst->GetFrstPrdcsr(NULL, &ltncy, &depType, &prdcsrNum);
+         prdcsr != NULL;
+         prdcsr = inst->GetNxtPrdcsr(NULL, &ltncy, &depType, &prdcsrNum)) {
+      storage_.push_back(prdcsrNum);
+      storage_.push_back(ltncy);
+      storage_.push_back(depType);
+      storage_.push_back(0);
+      prdcsrCnt++;
+    }
+  }
+  storage_[storage_[HDR_PRDCSR_OFFSETS] + instCnt] = prdcsrCnt;
+
+  // The defs of an instruction are followed by its uses, so the uses of
+  // instruction i end where the defs of instruction i + 1 start
+  storage_[HDR_DEF_OFFSETS] = storage_.size();
+  storage_.resize(storage_.size() + instCnt + 1);
+  storage_[HDR_USE_OFFSETS] = storage_.size();
+  storage_.resize(storage_.size() + instCnt);
+  storage_[HDR_REG_TUPLES] = storage_.size();
+  int32_t tupleCnt = 0;
+  for (InstCount i = 0; i < instCnt; i++) {
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    RegIndxTuple *defs, *uses;
+    int16_t defCnt = inst->GetDefs(defs);
+    int16_t useCnt = inst->GetUses(uses);
+    storage_[storage_[HDR_DEF_OFFSETS] + i] = tupleCnt;
+    for (int16_t j = 0; j < defCnt; j++) {
+      storage_.push_back(defs[j].regType_);
+      storage_.push_back(defs[j].regNum_);
+    }
+    storage_[storage_[HDR_USE_OFFSETS] + i] = tupleCnt + defCnt;
+    for (int16_t j = 0; j < useCnt; j++) {
+      storage_.push_back(uses[j].regType_);
+      storage_.push_back(uses[j].regNum_);
+    }
+    tupleCnt += defCnt + useCnt;
+  }
+  storage_[storage_[HDR_DEF_OFFSETS] + instCnt] = tupleCnt;
+
+  storage_[HDR_REG_FILES] = storage_.size();
+  int32_t regCnt = 0;
+  for (int16_t i = 0; i < regTypeCnt; i++) {
+    storage_.push_back(regFiles[i].GetRegCnt());
+    storage_.push_back(regFiles[i].GetPhysRegCnt());
+    storage_.push_back(regCnt);
+    regCnt += regFiles[i].GetRegCnt();
+  }
+  storage_[HDR_REG_CNT] = regCnt;
+
+  storage_[HDR_REGS] = storage_.size();
+  for (int16_t i = 0; i < regTypeCnt; i++) {
+    for (int j = 0; j < regFiles[i].GetRegCnt(); j++) {
+      Register *reg = regFiles[i].GetReg(j);
+      storage_.push_back(reg->GetWght());
+      storage_.push_back(reg->GetUseCnt());
+      storage_.push_back(reg->GetPhysicalNumber());
+      storage_.push_back((reg->IsLiveIn() ? REG_LIVE_IN : 0) |
+                       (reg->IsLiveOut() ? REG_LIVE_OUT : 0));
+    }
+  }
+  storage_[HDR_SIZE] = storage_.size();
+  Attach_();
+  NumberEdges_();
+}
+
+void DDGBlob::NumberEdges_() {
+  // An edge is found in the predecessor list of its successor by a scan. The
+  // lists are short and the graph has no parallel edges.
+  int32_t *edges = storage_.data();
+  for (InstCount i = 0; i < GetInstCnt(); i++) {
+    for (size_t scsrEdge = GetScsrBgn(i); scsrEdge < GetScsrEnd(i);
+         scsrEdge++) {
+      InstCount scsr = GetScsr(scsrEdge);
+      for (size_t prdcsrEdge = GetPrdcsrBgn(scsr);
+           prdcsrEdge < GetPrdcsrEnd(scsr); prdcsrEdge++) {
+        if (GetPrdcsr(prdcsrEdge) != i)
+          continue;
+        edges[storage_[HDR_SCSRS] + scsrEdge * EDGE_FIELD_CNT +
+              EDGE_OTHER_NUM] = prdcsrEdge - GetPrdcsrBgn(scsr);
+        edges[storage_[HDR_PRDCSRS] + prdcsrEdge * EDGE_FIELD_CNT +
+              EDGE_OTHER_NUM] = scsrEdge - GetScsrBgn(i);
+        break;
+      }
+    }
+  }
+}
+
+bool DDGBlob::Assign(const void *data, size_t size) {
+  Clear();
+  if (size % sizeof(int32_t) != 0 || size < HDR_FIELD_CNT * sizeof(int32_t))
+    return false;
+  storage_.resize(size / sizeof(int32_t));
+  std::memcpy(storage_.data(), data, size);
+  Attach_();
+  if (!Validate_()) {
+    Clear();
+    return false;
+  }
+  return true;
+}
+
+bool DDGBlob::Validate_() const {
+  if (storage_[HDR_MAGIC] != MAGIC || storage_[HDR_VERSION] != VERSION ||
+      storage_[HDR_SIZE] != (int32_t)storage_.size())
+    return false;
+  int64_t instCnt = storage_[HDR_INST_CNT];
+  int64_t edgeCnt = storage_[HDR_EDGE_CNT];
+  int64_t regTypeCnt = storage_[HDR_REG_TYPE_CNT];
+  int64_t regCnt = storage_[HDR_REG_CNT];
+  if (instCnt < 0 || edgeCnt < 0 || regTypeCnt < 0 || regCnt < 0)
+    return false;
+  // Each section must start where the previous one ends
+  int64_t tupleCnt = 0;
+  int64_t ends[][2] = {
+      {HDR_INSTS, HDR_FIELD_CNT},
+      {HDR_SCSR_OFFSETS, storage_[HDR_INSTS] + instCnt * INST_FIELD_CNT},
+      {HDR_SCSRS, storage_[HDR_SCSR_OFFSETS] + instCnt + 1},
+      {HDR_PRDCSR_OFFSETS, storage_[HDR_SCSRS] + edgeCnt * EDGE_FIELD_CNT},
+      {HDR_PRDCSRS, storage_[HDR_PRDCSR_OFFSETS] + instCnt + 1},
+      {HDR_DEF_OFFSETS, storage_[HDR_PRDCSRS] + edgeCnt * EDGE_FIELD_CNT},
+      {HDR_USE_OFFSETS, storage_[HDR_DEF_OFFSETS] + instCnt + 1},
+      {HDR_REG_TUPLES, storage_[HDR_USE_OFFSETS] + instCnt}};
+  for (auto &end : ends)
+    if (storage_[end[0]] != end[1] || end[1] > (int64_t)storage_.size())
+      return false;
+  // The offset tables must be monotonic and end at the entry counts
+  auto CheckOffsets = [&](int section, int64_t cnt) {
+    int32_t prev = 0;
+    for (int64_t i = 0; i <= instCnt; i++) {
+      int32_t crnt = storage_[storage_[section] + i];
+      if (crnt < prev || crnt > cnt)
+        return false;
+      prev = crnt;
+    }
+    return prev == cnt;
+  };
+  if (!CheckOffsets(HDR_SCSR_OFFSETS, edgeCnt) ||
+      !CheckOffsets(HDR_PRDCSR_OFFSETS, edgeCnt))
+    return false;
+  tupleCnt = storage_[storage_[HDR_DEF_OFFSETS] + instCnt];
+  if (!CheckOffsets(HDR_DEF_OFFSETS, tupleCnt))
+    return false;
+  for (int64_t i = 0; i < instCnt; i++) {
+    int32_t useBgn = storage_[storage_[HDR_USE_OFFSETS] + i];
+    if (useBgn < storage_[storage_[HDR_DEF_OFFSETS] + i] ||
+        useBgn > storage_[storage_[HDR_DEF_OFFSETS] + i + 1])
+      return false;
+  }
+  if (storage_[HDR_REG_FILES] != storage_[HDR_REG_TUPLES] + tupleCnt * 2 ||
+      storage_[HDR_REGS] != storage_[HDR_REG_FILES] + regTypeCnt * RF_FIELD_CNT ||
+      storage_[HDR_SIZE] != storage_[HDR_REGS] + regCnt * REG_FIELD_CNT)
+    return false;
+  // Every reference must point into the graph, and every edge must be found
+  // at its position in the list of the other instruction
+  for (InstCount i = 0; i < instCnt; i++) {
+    for (size_t edge = GetScsrBgn(i); edge < GetScsrEnd(i); edge++) {
+      InstCount scsr = GetScsr(edge);
+      if (scsr < 0 || scsr >= instCnt)
+        return false;
+      size_t prdcsrEdge = GetPrdcsrBgn(scsr) + GetScsrPrdcsrNum(edge);
+      if (GetScsrPrdcsrNum(edge) < 0 || prdcsrEdge >= GetPrdcsrEnd(scsr) ||
+          GetPrdcsr(prdcsrEdge) != i ||
+          GetPrdcsrScsrNum(prdcsrEdge) != (InstCount)(edge - GetScsrBgn(i)))
+        return false;
+    }
+    for (size_t edge = GetPrdcsrBgn(i); edge < GetPrdcsrEnd(i); edge++) {
+      InstCount prdcsr = GetPrdcsr(edge);
+      if (prdcsr < 0 || prdcsr >= instCnt ||
+          GetPrdcsrScsrNum(edge) < 0 ||
+          GetScsrBgn(prdcsr) + GetPrdcsrScsrNum(edge) >= GetScsrEnd(prdcsr))
+        return false;
+    }
+  }
+  for (int64_t i = 0; i < tupleCnt; i++) {
+    RegIndxTuple tuple = RegTuple_(i);
+    if (tuple.regType_ < 0 || tuple.regType_ >= regTypeCnt ||
+        tuple.regNum_ < 0 || tuple.regNum_ >= GetRegCnt(tuple.regType_))
+      return false;
+  }
+  int64_t fileRegCnt = 0;
+  for (int16_t i = 0; i < regTypeCnt; i++) {
+    const int32_t *file = &storage_[storage_[HDR_REG_FILES] + i * RF_FIELD_CNT];
+    if (file[RF_REG_CNT] < 0 || file[RF_FRST_REG] != fileRegCnt)
+      return false;
+    fileRegCnt += file[RF_REG_CNT];
+  }
+  return fileRegCnt == regCnt;
+}
+
+uint64_t DDGBlob::GetHash() const {
+  uint64_t key = RandomGen::MixKey(0, storage_.size());
+  for (int32_t word : storage_)
+    key = RandomGen::MixKey(key, (uint32_t)word);
+  return key;
+}
@@ -3,6 +3,7 @@
 #include "opt-sched/Scheduler/hist_table.h"
 #include "opt-sched/Scheduler/logger.h"
 #include "opt-sched/Scheduler/random.h"
+#include "opt-sched/Scheduler/shared_hist_table.h"
 #include "opt-sched/Scheduler/stats.h"
 #include "opt-sched/Scheduler/utilities.h"
 #include <algorithm>
@@ -585,11 +586,25 @@ void Enumerator::FreeAllocators_() {
 __host__
 void Enumerator::Reset() {
   if (IsHistDom()) {
+    RecordHistStats_();
     exmndSubProbs_->Clear(false, hashTblEntryAlctr_);
+    histQueue_.clear();
+    histMemUsed_ = 0;
+    maxHistMemUsed_ = 0;
   }
 
   ResetAllocators_();
+  ResetSearch_();
+}
+/****************************************************************************/
 
+void Enumerator::ResetKeepingHistory() {
+  nodeAlctr_->Reset();
+  ResetSearch_();
+}
+/****************************************************************************/
+
+void Enumerator::ResetSearch_() {
   for (InstCount i = 0; i < schedUprBound_; i++) {
     if (frstRdyLstPerCycle_[i] != NULL) {
       frstRdyLstPerCycle_[i]->Reset();
@@ -887,6 +902,7 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
 #ifdef IS_DEBUG_NODES
   uint64_t prevNodeCnt = exmndNodeCnt_;
 #endif
+  uint64_t strtNodeCnt = exmndNodeCnt_;
 
   while (!(allNodesExplrd || WasObjctvMet_())) {
     if (deadline != INVALID_VALUE && Utilities::GetProcessorTime() > deadline) {
@@ -894,6 +910,11 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
       break;
     }
 
+    if (nodeBudget_ > 0 && exmndNodeCnt_ - strtNodeCnt >= nodeBudget_) {
+      isTimeout = true;
+      break;
+    }
+
     mostRecentMatchingHistNode_ = nullptr;
 
     if (isCrntNodeFsbl) {
@@ -910,6 +931,14 @@ FUNC_RESULT Enumerator::FindFeasibleSchedule_(InstSchedule *sched,
 
       StepFrwrd_(nxtNode);
 
+      if (splitPrefixes_ != NULL && crntNode_->GetTime() == splitDepth_ &&
+          !crntNode_->IsLeaf()) {
+        // The sub-tree below this node is searched separately.
+        AddSplitPrefix_();
+        isCrntNodeFsbl = BackTrack_();
+        continue;
+      }
+
       // Find matching history nodes with suffixes.
       auto matchingHistNodesWithSuffix = mostRecentMatchingHistNode_;
 
@@ -995,6 +1024,13 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
       // then we only have the option of scheduling a stall
       assert(isEmptyNode == false || brnchCnt == 1);
       inst = NULL;
+
+      if (IsOffPrefix_(SCHD_STALL)) {
+        crntNode_->NewBranchExmnd(inst, false, false, false, false, DIR_FRWRD,
+                                  true);
+        continue;
+      }
+
       enumStall = EnumStall_();
 
       if (isEmptyNode || crntNode_->GetLegalInstCnt() == 0 || enumStall) {
@@ -1009,6 +1045,14 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
     } else {
       inst = rdyLst_->GetNextPriorityInst();
       assert(inst != NULL);
+
+      // Within the prefix, only the branch that it takes is searched.
+      if (IsOffPrefix_(inst->GetNum())) {
+        crntNode_->NewBranchExmnd(inst, false, false, false, false, DIR_FRWRD,
+                                  true);
+        continue;
+      }
+
       bool isLegal = ChkInstLglty_(inst);
       isLngthFsbl = isLegal;
 
@@ -1048,6 +1092,18 @@ bool Enumerator::FindNxtFsblBrnch_(EnumTreeNode *&newNode) {
 }
 /*****************************************************************************/
 
+void Enumerator::AddSplitPrefix_() {
+  std::vector<InstCount> prefix(crntNode_->GetTime());
+
+  for (EnumTreeNode *node = crntNode_; node != rootNode_;
+       node = node->GetParent()) {
+    prefix[node->GetTime() - 1] = node->GetInstNum();
+  }
+
+  splitPrefixes_->push_back(std::move(prefix));
+}
+/*****************************************************************************/
+
 bool Enumerator::ProbeBranch_(SchedInstruction *inst, EnumTreeNode *&newNode,
                               bool &isNodeDmntd, bool &isRlxInfsbl,
                               bool &isLngthFsbl) {
@@ -1450,11 +1506,20 @@ bool Enumerator::BackTrack_() {
   if (IsHistDom()) {
     assert(!crntNode_->IsArchived());
     HistEnumTreeNode *crntHstry = crntNode_->GetHistory();
-    exmndSubProbs_->InsertElement(crntNode_->GetSig(), crntHstry,
-                                  hashTblEntryAlctr_);
+    HashTblEntry<HistEnumTreeNode> *tblEntry = exmndSubProbs_->InsertElement(
+        crntNode_->GetSig(), crntHstry, hashTblEntryAlctr_);
     SetTotalCostsAndSuffixes(crntNode_, trgtNode, trgtSchedLngth_,
                              prune_.useSuffixConcatenation);
     crntNode_->Archive();
+
+    // The nodes of a prefix were only searched along the prefix.
+    if (sharedHist_ != NULL &&
+        (prefix_ == NULL || crntNode_->GetTime() >= (InstCount)prefix_->size()))
+      sharedHist_->Insert(crntNode_, this);
+
+    // A node that could not be added is kept until the next reset.
+    if (tblEntry != NULL)
+      AddToHistory_(crntHstry, tblEntry);
   } else {
     assert(crntNode_->IsArchived() == false);
   }
@@ -1545,6 +1610,8 @@ bool Enumerator::WasDmnntSubProbExmnd_(SchedInstruction *,
         exNode->PrntPartialSched(Logger::GetLogStream());
 #endif
 
+        exNode->SetDmntnHit();
+        histHitCnt_++;
         nodeAlctr_->Free(newNode);
         newNode = NULL;
 #ifdef IS_DEBUG_SPD
@@ -1564,10 +1631,86 @@ bool Enumerator::WasDmnntSubProbExmnd_(SchedInstruction *,
   }
 
   stats::traversedHistoryListSize.Record(trvrsdListSize);
+  histMissCnt_++;
+
+  if (sharedHist_ != NULL && sharedHist_->IsDominated(newNode, this)) {
+    nodeAlctr_->Free(newNode);
+    newNode = NULL;
+    return true;
+  }
+
   return false;
 }
 /****************************************************************************/
 
+void Enumerator::AddToHistory_(HistEnumTreeNode *histNode,
+                               HashTblEntry<HistEnumTreeNode> *tblEntry) {
+  histNode->SetTblEntry(tblEntry);
+  histMemUsed_ += histNode->GetMemSize(issuRate_) +
+                  sizeof(BinHashTblEntry<HistEnumTreeNode>);
+
+  if (histMemLimit_ > 0) {
+    histQueue_.push_back(histNode);
+    EvictHistory_();
+  }
+
+  maxHistMemUsed_ = std::max(maxHistMemUsed_, histMemUsed_);
+}
+/****************************************************************************/
+
+void Enumerator::EvictHistory_() {
+  while (histMemUsed_ > histMemLimit_ && !histQueue_.empty()) {
+    HistEnumTreeNode *histNode = histQueue_.front();
+    histQueue_.pop_front();
+
+    // Give a node that recently dominated another node a second chance.
+    if (histNode->TakeDmntnHit()) {
+      histQueue_.push_back(histNode);
+      continue;
+    }
+
+    auto tblEntry =
+        static_cast<BinHashTblEntry<HistEnumTreeNode> *>(histNode->GetTblEntry());
+    exmndSubProbs_->RemoveEntry(tblEntry);
+    tblEntry->Clean();
+    hashTblEntryAlctr_->FreeObject(tblEntry);
+    histNode->SetTblEntry(NULL);
+    histMemUsed_ -= sizeof(BinHashTblEntry<HistEnumTreeNode>);
+    histEvictionCnt_++;
+
+    // The node stays in memory as long as the history of its descendants in
+    // the table or in the tree refers to it.
+    ReleaseHistNode_(histNode);
+  }
+}
+/****************************************************************************/
+
+void Enumerator::ReleaseHistNode_(HistEnumTreeNode *histNode) {
+  while (histNode != NULL && histNode->Release()) {
+    HistEnumTreeNode *prevNode = histNode->GetParent();
+    histMemUsed_ -= histNode->GetMemSize(issuRate_);
+    FreeHistNode_(histNode);
+    histNode = prevNode;
+  }
+}
+/****************************************************************************/
+
+void Enumerator::RecordHistStats_() {
+  if (histHitCnt_ == 0 && histMissCnt_ == 0 &&
+      exmndSubProbs_->GetEntryCnt() == 0)
+    return;
+
+  stats::historyTableEntries.Record(exmndSubProbs_->GetEntryCnt());
+  stats::historyTableMemory.Record(maxHistMemUsed_);
+  stats::historyTableHits += histHitCnt_;
+  stats::historyTableMisses += histMissCnt_;
+  stats::historyTableEvictions += histEvictionCnt_;
+  histHitCnt_ = 0;
+  histMissCnt_ = 0;
+  histEvictionCnt_ = 0;
+}
+/****************************************************************************/
+
 bool Enumerator::TightnLwrBounds_(SchedInstruction *newInst) {
   SchedInstruction *inst;
   InstCount newLwrBound = 0;
@@ -1846,6 +1989,12 @@ void Enumerator::PrintLog_() {
   Logger::Info("Total nodes examined: %lld\n", GetNodeCnt());
   Logger::Info("History table includes %d entries.\n",
                exmndSubProbs_->GetEntryCnt());
+  Logger::Info("History table uses %llu bytes, %llu hits, %llu misses, %llu "
+               "evictions.\n",
+               (unsigned long long)histMemUsed_,
+               (unsigned long long)histHitCnt_,
+               (unsigned long long)histMissCnt_,
+               (unsigned long long)histEvictionCnt_);
   Logger::GetLogStream() << stats::historyEntriesPerIteration;
   Logger::Info("--------------------------------------------------\n");
 }
@@ -2041,6 +2190,27 @@ FUNC_RESULT LengthCostEnumerator::FindFeasibleSchedule(InstSchedule *sched,
 }
 /*****************************************************************************/
 
+FUNC_RESULT LengthCostEnumerator::FindSubProblems(
+    InstSchedule *sched, InstCount trgtLngth, SchedRegion *rgn,
+    int costLwrBound, InstCount splitDepth,
+    std::vector<std::vector<InstCount>> &prefixes, Milliseconds deadline) {
+  // The search backtracks from the sub-problems without exploring them, so
+  // they must not be recorded as examined.
+  bool histDom = prune_.histDom;
+  prune_.histDom = false;
+  splitDepth_ = splitDepth;
+  splitPrefixes_ = &prefixes;
+
+  FUNC_RESULT rslt =
+      FindFeasibleSchedule(sched, trgtLngth, rgn, costLwrBound, deadline);
+
+  splitPrefixes_ = NULL;
+  splitDepth_ = INVALID_VALUE;
+  prune_.histDom = histDom;
+  return rslt;
+}
+/*****************************************************************************/
+
 bool LengthCostEnumerator::WasObjctvMet_() {
   assert(GetBestCost_() >= 0);
 
@@ -1,4 +1,5 @@
 #include "opt-sched/Scheduler/gen_sched.h"
+#include "opt-sched/Scheduler/ant_state.h"
 #include "opt-sched/Scheduler/data_dep.h"
 #include "opt-sched/Scheduler/logger.h"
 #include "opt-sched/Scheduler/machine_model.h"
@@ -178,13 +179,16 @@ __host__ __device__
 void ConstrainedScheduler::SchdulInst_(SchedInstruction *inst, InstCount) {
 #ifdef __HIP_DEVICE_COMPILE__  // Device version
   InstCount prdcsrNum, scsrRdyCycle;//, scsrRdyListNum;
+  UDT_GLABEL ltncy;
 
   // Notify each successor of this instruction that it has been scheduled.
   if(!IsACO) {
     int i = 0;
-    for (SchedInstruction *crntScsr = GetScsr(inst, i++, &prdcsrNum);
-          crntScsr != NULL; crntScsr = GetScsr(inst, i++, &prdcsrNum)) {
-      crntScsr->PrdcsrSchduld(prdcsrNum, dev_crntCycleNum_[GLOBALTID], scsrRdyCycle);
+    for (SchedInstruction *crntScsr = GetScsr(inst, i++, &prdcsrNum, &ltncy);
+          crntScsr != NULL;
+          crntScsr = GetScsr(inst, i++, &prdcsrNum, &ltncy)) {
+      crntScsr->PrdcsrSchduld(prdcsrNum, dev_crntCycleNum_[GLOBALTID],
+                              scsrRdyCycle, ltncy);
     }
   }
   if (inst->BlocksCycle()) {
@@ -193,13 +197,14 @@ void ConstrainedScheduler::SchdulInst_(SchedInstruction *inst, InstCount) {
   dev_schduldInstCnt_[GLOBALTID]++;
 #else  // Host version
   InstCount prdcsrNum, scsrRdyCycle;
+  UDT_GLABEL ltncy;
 
   // Notify each successor of this instruction that it has been scheduled.
   if(!IsACO) {
-    for (SchedInstruction *crntScsr = inst->GetFrstScsr(&prdcsrNum);
-        crntScsr != NULL; crntScsr = inst->GetNxtScsr(&prdcsrNum)) {
-      bool wasLastPrdcsr =
-          crntScsr->PrdcsrSchduld(prdcsrNum, crntCycleNum_, scsrRdyCycle);
+    for (SchedInstruction *crntScsr = inst->GetFrstScsr(&prdcsrNum, &ltncy);
+        crntScsr != NULL; crntScsr = inst->GetNxtScsr(&prdcsrNum, &ltncy)) {
+      bool wasLastPrdcsr = crntScsr->PrdcsrSchduld(prdcsrNum, crntCycleNum_,
+                                                   scsrRdyCycle, ltncy);
 
       if (wasLastPrdcsr) {
         // If all other predecessors of this successor have been scheduled then
@@ -489,29 +494,141 @@ void ConstrainedScheduler::UpdtSlotAvlblty_(SchedInstruction *inst) {
 #endif
 }
 
+bool ConstrainedScheduler::Initialize_(AntState &State) {
+  for (InstCount i = 0; i < totInstCnt_; i++) {
+    SchedInstruction *inst = dataDepGraph_->GetInstByIndx(i);
+    State.unschduldPrdcsrCnt[i] = inst->GetPrdcsrCnt();
+    State.minRdyCycle[i] = INVALID_VALUE;
+    State.lastUseCnt[i] = 0;
+  }
+
+  for (int i = 0; i < issuRate_; i++) {
+    State.rsrvSlots[i].strtCycle = INVALID_VALUE;
+    State.rsrvSlots[i].endCycle = INVALID_VALUE;
+  }
+
+  State.rsrvSlotCnt = 0;
+  State.schduldInstCnt = 0;
+  State.crntSlotNum = 0;
+  State.crntRealSlotNum = 0;
+  State.crntCycleNum = 0;
+  State.isCrntCycleBlkd = false;
+
+  InitNewCycle_(State);
+
+  ((BBWithSpill *)rgn_)->InitForSchdulng(State);
+
+  return true;
+}
+
+void ConstrainedScheduler::InitNewCycle_(AntState &State) {
+  assert(State.crntSlotNum == 0 && State.crntRealSlotNum == 0);
+  for (int i = 0; i < issuTypeCnt_; i++) {
+    State.avlblSlotsInCrntCycle[i] = slotsPerTypePerCycle_[i];
+  }
+  State.isCrntCycleBlkd = false;
+}
+
+void ConstrainedScheduler::SchdulInst_(AntState &State,
+                                       SchedInstruction *inst) {
+  // Successors are notified by the caller, which owns the ready list.
+  if (inst->BlocksCycle()) {
+    State.isCrntCycleBlkd = true;
+  }
+
+  State.schduldInstCnt++;
+}
+
+void ConstrainedScheduler::DoRsrvSlots_(AntState &State,
+                                        SchedInstruction *inst) {
+  if (inst == NULL)
+    return;
+
+  if (!inst->IsPipelined()) {
+    State.rsrvSlots[State.crntSlotNum].strtCycle = State.crntCycleNum;
+    State.rsrvSlots[State.crntSlotNum].endCycle =
+        State.crntCycleNum + inst->GetMaxLtncy() - 1;
+    State.rsrvSlotCnt++;
+  }
+}
+
+bool ConstrainedScheduler::MovToNxtSlot_(AntState &State,
+                                         SchedInstruction *inst) {
+  // If we are currently in the last slot of the current cycle.
+  if (State.crntSlotNum == (issuRate_ - 1)) {
+    State.crntCycleNum++;
+    State.crntSlotNum = 0;
+    State.crntRealSlotNum = 0;
+    return true;
+  } else {
+    State.crntSlotNum++;
+    if (inst && machMdl_->IsRealInst(inst->GetInstType()))
+      State.crntRealSlotNum++;
+    return false;
+  }
+}
+
+bool ConstrainedScheduler::ChkInstLglty_(const AntState &State,
+                                         SchedInstruction *inst) const {
+  if (IsTriviallyLegal_(inst))
+    return true;
+
+  // Account for instructions that block the whole cycle.
+  if (State.isCrntCycleBlkd)
+    return false;
+  if (inst->BlocksCycle() && State.crntSlotNum != 0)
+    return false;
+  if (includesUnpipelined_ &&
+      State.rsrvSlots[State.crntSlotNum].strtCycle != INVALID_VALUE &&
+      State.crntCycleNum <= State.rsrvSlots[State.crntSlotNum].endCycle) {
+    return false;
+  }
+
+  IssueType issuType = inst->GetIssueType();
+  assert(issuType < issuTypeCnt_);
+  assert(State.avlblSlotsInCrntCycle[issuType] >= 0);
+  return (State.avlblSlotsInCrntCycle[issuType] > 0);
+}
+
+void ConstrainedScheduler::UpdtSlotAvlblty_(AntState &State,
+                                            SchedInstruction *inst) {
+  if (inst == NULL)
+    return;
+  IssueType issuType = inst->GetIssueType();
+  assert(issuType < issuTypeCnt_);
+  assert(State.avlblSlotsInCrntCycle[issuType] > 0);
+  State.avlblSlotsInCrntCycle[issuType]--;
+}
+
+bool InstScheduler::IsSchedComplete_(const AntState &State) const {
+  return State.schduldInstCnt == totInstCnt_;
+}
+
 __device__
 SchedInstruction *ConstrainedScheduler::GetScsr(SchedInstruction *inst,
                                        int scsrNum, 
                                        InstCount *prdcsrNum, 
                                        UDT_GLABEL *ltncy, 
                                        InstCount *scsrNodeNum) {
-  int ddgInstIndex = inst->ddgIndex;
-
   if (scsrNum >= inst->GetScsrCnt_()) {
     return NULL;
   }
 
+  // The edges are read from the image of the DDG
+  const DDGBlobView &ddgBlob = dataDepGraph_->GetDevDDGBlob();
+  size_t edge = ddgBlob.GetScsrBgn(inst->GetNum()) + scsrNum;
+
   if (prdcsrNum) {
-    *prdcsrNum = dataDepGraph_->predOrder_[ddgInstIndex + scsrNum];
+    *prdcsrNum = ddgBlob.GetScsrPrdcsrNum(edge);
   }
 
   if (ltncy) {
-    *ltncy = dataDepGraph_->latencies_[ddgInstIndex + scsrNum];
+    *ltncy = ddgBlob.GetScsrLtncy(edge);
   }
 
   if (scsrNodeNum) {
-    *scsrNodeNum = dataDepGraph_->scsrs_[ddgInstIndex + scsrNum];
+    *scsrNodeNum = ddgBlob.GetScsr(edge);
   }
 
-  return dataDepGraph_->GetInstByIndx(dataDepGraph_->scsrs_[ddgInstIndex + scsrNum]);
+  return dataDepGraph_->GetInstByIndx(ddgBlob.GetScsr(edge));
 }
@@ -7,6 +7,18 @@
 
 using namespace llvm::opt_sched;
 
+// Returns the value that is added to the hash of a set of scheduled
+// instructions when an instruction is added to it. The signature of the
+// instruction is mixed into the upper 48 bits, and the lower 16 bits count
+// the instruction in the size of the set. The sum is unrelated to the XOR of
+// the signatures that the history table is keyed by.
+static inline uint64_t getInstSetKey(SchedInstruction *inst) {
+  uint64_t key = inst->GetSig();
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+  return ((key ^ (key >> 31)) << 16) | 1;
+}
+
 HistEnumTreeNode::HistEnumTreeNode() { rsrvSlots_ = NULL; }
 
 HistEnumTreeNode::~HistEnumTreeNode() {
@@ -14,12 +26,24 @@ HistEnumTreeNode::~HistEnumTreeNode() {
     delete[] rsrvSlots_;
 }
 
-void HistEnumTreeNode::Construct(EnumTreeNode *node, bool) {
+void HistEnumTreeNode::Construct(EnumTreeNode *node, bool isTemp) {
   prevNode_ = node->prevNode_ == NULL ? NULL : node->prevNode_->hstry_;
   assert(prevNode_ != this);
 
+  // The parent must be kept as long as this node is, but a temporary node is
+  // overwritten without being freed.
+  refCnt_ = 1;
+  dmntnHit_ = false;
+  tblEntry_ = NULL;
+  if (!isTemp && prevNode_ != NULL)
+    prevNode_->AddRef();
+
   time_ = node->time_;
-  inst_ = node->inst_;
+  instNum_ = node->inst_ == NULL ? SCHD_STALL : node->inst_->GetNum();
+
+  schduldSetHash_ = prevNode_ == NULL ? 0 : prevNode_->schduldSetHash_;
+  if (node->inst_ != NULL)
+    schduldSetHash_ += getInstSetKey(node->inst_);
 
 #ifdef IS_DEBUG
   isCnstrctd_ = true;
@@ -51,7 +75,8 @@ void HistEnumTreeNode::SetRsrvSlots_(EnumTreeNode *node) {
 
 void HistEnumTreeNode::Init_() {
   time_ = 0;
-  inst_ = NULL;
+  instNum_ = SCHD_STALL;
+  schduldSetHash_ = 0;
   prevNode_ = NULL;
 #ifdef IS_DEBUG
   isCnstrctd_ = false;
@@ -65,11 +90,26 @@ void HistEnumTreeNode::Clean() {
     delete[] rsrvSlots_;
     rsrvSlots_ = NULL;
   }
+  suffix_ = nullptr;
+}
+
+size_t HistEnumTreeNode::GetMemSize(int issuRate) const {
+  size_t size = GetObjSize_();
+
+  if (rsrvSlots_ != NULL)
+    size += issuRate * sizeof(ReserveSlot);
+
+  if (suffix_ != nullptr)
+    size += sizeof(*suffix_) +
+            suffix_->capacity() * sizeof(SchedInstruction *);
+
+  return size;
 }
 
 InstCount HistEnumTreeNode::SetLastInsts_(SchedInstruction *lastInsts[],
                                           InstCount thisTime,
-                                          InstCount minTimeToExmn) {
+                                          InstCount minTimeToExmn,
+                                          Enumerator *enumrtr) {
   assert(minTimeToExmn >= 1);
   assert(lastInsts != NULL);
 
@@ -82,7 +122,7 @@ InstCount HistEnumTreeNode::SetLastInsts_(SchedInstruction *lastInsts[],
     // instructions in its partial schedule
     assert(crntNode->prevNode_ != NULL);
     assert(crntNode->GetTime() == thisTime - indx);
-    SchedInstruction *inst = crntNode->inst_;
+    SchedInstruction *inst = crntNode->GetInst_(enumrtr);
     assert(indx < (thisTime - minTimeToExmn + 1));
     lastInsts[indx] = inst;
   }
@@ -95,11 +135,11 @@ void HistEnumTreeNode::SetInstsSchduld_(BitVector *instsSchduld) {
   HistEnumTreeNode *crntNode;
 
   for (crntNode = this; crntNode != NULL; crntNode = crntNode->prevNode_) {
-    SchedInstruction *inst = crntNode->inst_;
+    InstCount instNum = crntNode->instNum_;
 
-    if (inst != NULL) {
-      assert(!instsSchduld->GetBit(inst->GetNum()));
-      instsSchduld->SetBit(inst->GetNum());
+    if (instNum != SCHD_STALL) {
+      assert(!instsSchduld->GetBit(instNum));
+      instsSchduld->SetBit(instNum);
     }
   }
 }
@@ -115,7 +155,8 @@ void HistEnumTreeNode::SetLwrBounds_(InstCount lwrBounds[],
     lwrBounds[i] = 0;
   }
 
-  InstCount entryCnt = SetLastInsts_(lastInsts, thisTime, minTimeToExmn);
+  InstCount entryCnt =
+      SetLastInsts_(lastInsts, thisTime, minTimeToExmn, enumrtr);
 
   for (InstCount indx = 0; indx < entryCnt; indx++) {
     InstCount time = thisTime - indx;
@@ -143,6 +184,12 @@ void HistEnumTreeNode::SetLwrBounds_(InstCount lwrBounds[],
   }
 }
 
+SchedInstruction *HistEnumTreeNode::GetInst_(Enumerator *enumrtr) const {
+  return instNum_ == SCHD_STALL
+             ? NULL
+             : enumrtr->dataDepGraph_->GetInstByIndx(instNum_);
+}
+
 InstCount HistEnumTreeNode::GetMinTimeToExmn_(InstCount nodeTime,
                                               Enumerator *enumrtr) {
   int issuRate = enumrtr->issuRate_;
@@ -215,7 +262,7 @@ bool HistEnumTreeNode::DoesDominate_(EnumTreeNode *node,
   InstCount entryCnt;
   InstCount minTimeToExmn = GetMinTimeToExmn_(thisTime, enumrtr);
 
-  entryCnt = SetLastInsts_(lastInsts, thisTime, minTimeToExmn);
+  entryCnt = SetLastInsts_(lastInsts, thisTime, minTimeToExmn, enumrtr);
   assert(entryCnt == thisTime - minTimeToExmn + 1);
 
   assert(lastInsts != NULL);
@@ -293,15 +340,9 @@ void HistEnumTreeNode::CmputNxtAvlblCycles_(Enumerator *enumrtr,
     nxtAvlblCycles[i] = crntCycle;
   }
 
-  for (crntNode = this, time = thisTime;
-       crntNode != NULL && cycleNum == crntCycle;
-       crntNode = crntNode->prevNode_, time--) {
-    assert(crntNode->prevNode_ != NULL);
-    SchedInstruction *inst = crntNode->inst_;
-    cycleNum = enumrtr->GetCycleNumFrmTime_(time);
-
+  auto countInst = [&](SchedInstruction *inst) {
     if (inst == NULL)
-      continue;
+      return;
 
     IssueType issuType = inst->GetIssueType();
     assert(issuType < issuTypeCnt);
@@ -310,6 +351,14 @@ void HistEnumTreeNode::CmputNxtAvlblCycles_(Enumerator *enumrtr,
     if (instsPerType[issuType] == machMdl->GetSlotsPerCycle(issuType)) {
       nxtAvlblCycles[issuType] = crntCycle + 1;
     }
+  };
+
+  for (crntNode = this, time = thisTime;
+       crntNode != NULL && cycleNum == crntCycle;
+       crntNode = crntNode->prevNode_, time--) {
+    assert(crntNode->prevNode_ != NULL);
+    cycleNum = enumrtr->GetCycleNumFrmTime_(time);
+    countInst(crntNode->GetInst_(enumrtr));
   }
 }
 
@@ -326,9 +375,7 @@ void HistEnumTreeNode::PrntPartialSched(std::ostream &out) {
       << "): ";
 
   for (HistEnumTreeNode *node = this; node != NULL; node = node->GetParent()) {
-    InstCount instNum =
-        (node->inst_ == NULL) ? SCHD_STALL : node->inst_->GetNum();
-    out << instNum << ' ';
+    out << node->GetInstNum() << ' ';
   }
 }
 
@@ -341,12 +388,7 @@ bool HistEnumTreeNode::CompPartialScheds(HistEnumTreeNode *othrHist) {
 
   for (HistEnumTreeNode *node = this, *othrNode = othrHist; node != NULL;
        node = node->GetParent(), othrNode = othrNode->GetParent()) {
-    InstCount thisInstNum =
-        node->inst_ == NULL ? SCHD_STALL : node->inst_->GetNum();
-    InstCount othrInstNum =
-        othrNode->inst_ == NULL ? SCHD_STALL : othrNode->inst_->GetNum();
-
-    if (thisInstNum != othrInstNum)
+    if (node->GetInstNum() != othrNode->GetInstNum())
       return false;
   }
 
@@ -400,6 +442,7 @@ void CostHistEnumTreeNode::Init_() {
   costInfoSet_ = false;
 #endif
   cost_ = 0;
+  costBound_ = 0;
 }
 
 bool CostHistEnumTreeNode::DoesDominate(EnumTreeNode *node,
@@ -425,6 +468,11 @@ bool CostHistEnumTreeNode::DoesDominate(EnumTreeNode *node,
       return true;
   }
 
+  // The history of an earlier search at the same length under a lower bound
+  // can not rule out the schedules between the two bounds.
+  if (static_cast<LengthCostEnumerator *>(enumrtr)->GetBestCost() > costBound_)
+    return false;
+
   // if the hist node dominates the current node, and the hist node
   // had at least one feasible sched below it, domination will be
   // determined by the cost domination condition
@@ -470,14 +518,22 @@ static bool doesHistoryPeakCostDominate(InstCount OtherPrefixCost,
 // Should we prune the other node based on RP cost.
 bool CostHistEnumTreeNode::ChkCostDmntnForBBSpill_(EnumTreeNode *Node,
                                                    Enumerator *E) {
-  if (time_ > Node->GetTime())
+  //assert(costInfoSet_);
+  return llvm::opt_sched::doesHistoryCostDominate(
+      Node, E, time_, cost_, partialCost_, totalCost_, spillCostSum_);
+}
+
+bool llvm::opt_sched::doesHistoryCostDominate(
+    EnumTreeNode *Node, Enumerator *E, InstCount HistTime, InstCount HistCost,
+    InstCount HistPartialCost, InstCount HistTotalCost,
+    InstCount HistSpillCostSum) {
+  if (HistTime > Node->GetTime())
     return false;
 
   // If the other node's prefix cost is higher than or equal to the history
   // prefix cost the other node is pruned.
-  //assert(costInfoSet_);
   bool ShouldPrune;
-  if (Node->GetCostLwrBound() >= partialCost_)
+  if (Node->GetCostLwrBound() >= HistPartialCost)
     ShouldPrune = true;
   else {
     ShouldPrune = false;
@@ -488,26 +544,28 @@ bool CostHistEnumTreeNode::ChkCostDmntnForBBSpill_(EnumTreeNode *Node,
     // pruning conditions that are specific to the current cost function.
     if (SpillCostFunc == SCF_TARGET || SpillCostFunc == SCF_PRP ||
         SpillCostFunc == SCF_PERP)
-      ShouldPrune = doesHistoryPeakCostDominate(Node->GetCostLwrBound(),
-                                                partialCost_, totalCost_, LCE);
+      ShouldPrune = doesHistoryPeakCostDominate(
+          Node->GetCostLwrBound(), HistPartialCost, HistTotalCost, LCE);
 
     else if (SpillCostFunc == SCF_SLIL)
-      ShouldPrune = doesHistorySLILCostDominate(Node->GetCostLwrBound(),
-                                                partialCost_, totalCost_, LCE);
+      ShouldPrune = doesHistorySLILCostDominate(
+          Node->GetCostLwrBound(), HistPartialCost, HistTotalCost, LCE);
 
     // If the cost function is peak plus avg, make sure that the fraction lost
     // by integer divsion does not lead to false domination.
-    else if (SpillCostFunc == SCF_PEAK_PLUS_AVG && cost_ == Node->GetCost()) {
+    else if (SpillCostFunc == SCF_PEAK_PLUS_AVG && HistCost == Node->GetCost()) {
       InstCount instCnt = E->GetTotInstCnt();
       ShouldPrune =
-          spillCostSum_ % instCnt >= Node->GetSpillCostSum() % instCnt;
+          HistSpillCostSum % instCnt >= Node->GetSpillCostSum() % instCnt;
     }
   }
   return ShouldPrune;
 }
 
-void CostHistEnumTreeNode::SetCostInfo(EnumTreeNode *node, bool, Enumerator *) {
+void CostHistEnumTreeNode::SetCostInfo(EnumTreeNode *node, bool,
+                                       Enumerator *enumrtr) {
   cost_ = node->GetCost();
+  costBound_ = static_cast<LengthCostEnumerator *>(enumrtr)->GetBestCost();
   peakSpillCost_ = node->GetPeakSpillCost();
   spillCostSum_ = node->GetSpillCostSum();
   isLngthFsbl_ = node->IsLngthFsbl();
@@ -535,18 +593,27 @@ void CostHistEnumTreeNode::SetCostInfo(EnumTreeNode *node, bool, Enumerator *) {
 InstCount HistEnumTreeNode::GetTime() { return time_; }
 
 InstCount HistEnumTreeNode::GetInstNum() {
-  return inst_ == NULL ? SCHD_STALL : inst_->GetNum();
+  return instNum_;
 }
 
 bool HistEnumTreeNode::DoesMatch(EnumTreeNode *node, Enumerator *enumrtr) {
+  // The node is only compared with the nodes in its table entry, which share
+  // its 64-bit signature. Sets of the same size with the same signature and
+  // the same 48-bit hash are taken to be equal without tracing back the
+  // parents.
+  bool isMatch = schduldSetHash_ == node->hstry_->schduldSetHash_;
+
+#ifdef IS_DEBUG
   BitVector *instsSchduld = enumrtr->bitVctr1_;
   BitVector *othrInstsSchduld = enumrtr->bitVctr2_;
 
   assert(instsSchduld != NULL && othrInstsSchduld != NULL);
   SetInstsSchduld_(instsSchduld);
   node->hstry_->SetInstsSchduld_(othrInstsSchduld);
+  assert(isMatch == (*othrInstsSchduld == *instsSchduld));
+#endif
 
-  return *othrInstsSchduld == *instsSchduld;
+  return isMatch;
 }
 
 bool HistEnumTreeNode::IsDominated(EnumTreeNode *node, Enumerator *enumrtr) {
@@ -5,6 +5,8 @@
 #include <cstdio>
 // For exit().
 #include <cstdlib>
+#include <mutex>
+#include <sstream>
 // For GetProcessorTime().
 #include "opt-sched/Scheduler/utilities.h"
 
@@ -22,14 +24,17 @@ static const int MAX_MSGSIZE = 8000;
 
 // The current output stream.
 static std::ostream *logStream = &std::cerr;
+// Keeps the messages of threads scheduling different regions from being
+// interleaved.
+static std::mutex logMutex;
 
-// The periodic logging callback.
-static void (*periodLogCallback)() = NULL;
+// The periodic logging callback. Each thread has its own.
+static thread_local void (*periodLogCallback)() = NULL;
 // The minimum length of (CPU) time between two calls to the periodic logging
 // callback.
-static Milliseconds periodLogPeriod = 0;
+static thread_local Milliseconds periodLogPeriod = 0;
 // The CPU time when the period log was last called.
-static Milliseconds periodLogLastTime = 0;
+static thread_local Milliseconds periodLogLastTime = 0;
 
 // The main output function. Calculates the time since process start and formats
 // the specified message with a title and timestamp. Exits the program with exit
@@ -52,17 +57,25 @@ static void Output(Logger::LOG_LEVEL level, bool timed, const char *message) {
     break;
   }
 
-  (*logStream) << title << ": " << message;
+  std::ostringstream line;
+  line << title << ": " << message;
   if (timed) {
-    (*logStream) << " (Time = " << Utilities::GetProcessorTime() << " ms)";
+    line << " (Time = " << Utilities::GetProcessorTime() << " ms)";
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(logMutex);
+    (*logStream) << line.str() << std::endl;
   }
-  (*logStream) << std::endl;
 
   if (level == Logger::FATAL)
     exit(1);
 }
 
-void Logger::SetLogStream(std::ostream &out) { logStream = &out; }
+void Logger::SetLogStream(std::ostream &out) {
+  std::lock_guard<std::mutex> lock(logMutex);
+  logStream = &out;
+}
 
 std::ostream &Logger::GetLogStream() { return *logStream; }
 
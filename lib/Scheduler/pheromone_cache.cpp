@@ -0,0 +1,48 @@
+#include "opt-sched/Scheduler/pheromone_cache.h"
+#include <algorithm>
+
+using namespace llvm::opt_sched;
+
+PheromoneCache &PheromoneCache::getInstance() {
+  static PheromoneCache instance;
+  return instance;
+}
+
+void PheromoneCache::SetCapacity(size_t capacity) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = capacity;
+  Evict_();
+}
+
+bool PheromoneCache::Lookup(uint64_t key, const DDGBlob &graph, bool sparse,
+                            std::vector<pheromone_t> &table) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.sparse != sparse ||
+      it->second.table.size() != table.size() || !(it->second.graph == graph))
+    return false;
+  table = it->second.table;
+  return true;
+}
+
+void PheromoneCache::Insert(uint64_t key, const DDGBlob &graph, bool sparse,
+                            std::vector<pheromone_t> table) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (capacity_ == 0)
+    return;
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    order_.push_back(key);
+    entries_[key] = Entry{graph, sparse, std::move(table)};
+    Evict_();
+  } else {
+    it->second = Entry{graph, sparse, std::move(table)};
+  }
+}
+
+void PheromoneCache::Evict_() {
+  while (order_.size() > capacity_) {
+    entries_.erase(order_.front());
+    order_.pop_front();
+  }
+}
@@ -0,0 +1,103 @@
+#include "opt-sched/Scheduler/pheromone_table.h"
+#include "opt-sched/Scheduler/bit_vector.h"
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/sched_basic_data.h"
+#include <algorithm>
+#include <cassert>
+
+using namespace llvm::opt_sched;
+
+SparsePheromoneTable::SparsePheromoneTable() : instCnt_(0) {}
+
+bool SparsePheromoneTable::Construct(DataDepGraph *dataDepGraph,
+                                     size_t maxEntryCnt) {
+  Clear();
+  instCnt_ = dataDepGraph->GetInstCnt();
+
+  // Collect the direct predecessors and recursive predecessor sets once
+  // instead of walking the predecessor lists for every pair.
+  std::vector<std::vector<InstCount>> prdcsrs(instCnt_);
+  std::vector<BitVector *> rcrsvPrdcsrs(instCnt_);
+  for (InstCount i = 0; i < instCnt_; i++) {
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(i);
+    rcrsvPrdcsrs[i] = inst->GetRcrsvNghbrBitVector(DIR_BKWRD);
+    if (rcrsvPrdcsrs[i] == NULL) {
+      Clear();
+      return false;
+    }
+    for (SchedInstruction *prdcsr = inst->GetFrstPrdcsr(); prdcsr != NULL;
+         prdcsr = inst->GetNxtPrdcsr())
+      prdcsrs[i].push_back(prdcsr->GetNum());
+  }
+
+  rowOffsets_.reserve(instCnt_ + 2);
+  rowOffsets_.push_back(0);
+
+  // The empty schedule can only be followed by an instruction that has no
+  // predecessors.
+  for (InstCount to = 0; to < instCnt_; to++)
+    if (prdcsrs[to].empty())
+      cols_.push_back(to);
+  rowOffsets_.push_back(cols_.size());
+
+  // Instruction to can directly follow instruction from iff to does not have
+  // to be scheduled before from and no third instruction has to be scheduled
+  // between them. The latter is the case when from is a recursive
+  // predecessor of one of to's other direct predecessors.
+  for (InstCount from = 0; from < instCnt_; from++) {
+    for (InstCount to = 0; to < instCnt_; to++) {
+      if (to == from || rcrsvPrdcsrs[from]->GetBit(to))
+        continue;
+      bool mustSeparate = false;
+      for (InstCount prdcsr : prdcsrs[to]) {
+        if (prdcsr != from && rcrsvPrdcsrs[prdcsr]->GetBit(from)) {
+          mustSeparate = true;
+          break;
+        }
+      }
+      if (mustSeparate)
+        continue;
+      if (cols_.size() >= maxEntryCnt) {
+        Clear();
+        return false;
+      }
+      cols_.push_back(to);
+    }
+    rowOffsets_.push_back(cols_.size());
+  }
+
+  vals_.resize(cols_.size());
+  return true;
+}
+
+void SparsePheromoneTable::Clear() {
+  rowOffsets_.clear();
+  cols_.clear();
+  vals_.clear();
+  rowOffsets_.shrink_to_fit();
+  cols_.shrink_to_fit();
+  vals_.shrink_to_fit();
+}
+
+size_t SparsePheromoneTable::FindIndx_(InstCount from, InstCount to) const {
+  auto bgn = cols_.begin() + GetRowBgn(from);
+  auto end = cols_.begin() + GetRowEnd(from);
+  auto it = std::lower_bound(bgn, end, to);
+  if (it == end || *it != to)
+    return vals_.size();
+  return it - cols_.begin();
+}
+
+pheromone_t *SparsePheromoneTable::Find(InstCount from, InstCount to) {
+  size_t indx = FindIndx_(from, to);
+  return indx == vals_.size() ? NULL : &vals_[indx];
+}
+
+pheromone_t SparsePheromoneTable::Get(InstCount from, InstCount to) const {
+  size_t indx = FindIndx_(from, to);
+  return indx == vals_.size() ? 0 : vals_[indx];
+}
+
+void SparsePheromoneTable::Fill(pheromone_t value) {
+  std::fill(vals_.begin(), vals_.end(), value);
+}
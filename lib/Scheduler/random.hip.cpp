@@ -23,10 +23,11 @@ static uint32_t Z[] = {
     0xe14aae61,
 };
 
-// The current generator state. Magical starting values.
-static long j = 23;
-static long k = 54;
-static uint32_t y[] = {
+// The current generator state. Magical starting values. Each thread has its
+// own generator so that regions scheduled concurrently do not share a stream.
+static thread_local long j = 23;
+static thread_local long k = 54;
+static thread_local uint32_t y[] = {
     0x8ca0df45, 0x37334f23, 0x4a5901d2, 0xaeede075, 0xd84bd3cf, 0xa1ce3350,
     0x35074a8f, 0xfd4e6da0, 0xe2c22e6f, 0x045de97e, 0x0e6d45b9, 0x201624a2,
     0x01e10dca, 0x2810aef2, 0xea0be721, 0x3a3781e4, 0xa3602009, 0xd2ffcf69,
@@ -40,7 +41,20 @@ static uint32_t y[] = {
 };
 
 // The last random number.
-static uint32_t randNum;
+static thread_local uint32_t randNum;
+
+// The seed passed to the last SetSeed() call.
+static thread_local int32_t crntSeed = 0;
+
+// The SplitMix64 finalizer.
+static uint64_t Mix64(uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+// The SplitMix64 increment.
+static const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
 
 void GenerateNextNumber() {
   randNum = y[j] + y[k];
@@ -53,6 +67,7 @@ void GenerateNextNumber() {
 }
 
 void RandomGen::SetSeed(int32_t iseed) {
+  crntSeed = iseed;
   j = 23;
   k = 54;
 
@@ -103,3 +118,13 @@ void RandomGen::GetRandBits(uint16_t bitCnt, unsigned char *dest) {
     bytesNeeded -= bytesConsumed;
   }
 }
+
+int32_t RandomGen::GetSeed() { return crntSeed; }
+
+uint64_t RandomGen::MixKey(uint64_t key, uint64_t value) {
+  return Mix64(key ^ Mix64(value + GOLDEN_GAMMA));
+}
+
+uint64_t RandomGen::GetCounterRand64(uint64_t key, uint64_t counter) {
+  return Mix64(key + (counter + 1) * GOLDEN_GAMMA);
+}
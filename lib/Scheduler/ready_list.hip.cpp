@@ -264,7 +264,7 @@ void KeysHelper2::initForRegion(DataDepGraph *DDG) {
 
 // compute key
 __host__ __device__
-HeurType KeysHelper2::computeKey(SchedInstruction *Inst, bool IncludeDynamic, RegisterFile *RegFiles, DataDepGraph *ddg) const {
+HeurType KeysHelper2::computeKey(SchedInstruction *Inst, bool IncludeDynamic, RegisterFile *RegFiles, DataDepGraph *ddg, int whichPrirts) const {
   assert(WasInitialized);
 
   HeurType Key= 0;
@@ -277,7 +277,9 @@ HeurType KeysHelper2::computeKey(SchedInstruction *Inst, bool IncludeDynamic, Re
   bool useEntries1;
   #ifdef __HIP_DEVICE_COMPILE__
     // even blocks use priorities 1, odd blocks use priority 2
-    if (hipBlockIdx_x % 2 == 0) {
+    whichPrirts = hipBlockIdx_x % 2 == 0 ? 1 : 2;
+  #endif
+    if (whichPrirts == 1) {
       priorities = priorities1;
       KeysSz = KeysSz1;
       MaxValue = MaxValue1;
@@ -293,14 +295,6 @@ HeurType KeysHelper2::computeKey(SchedInstruction *Inst, bool IncludeDynamic, Re
       MaxISO = MaxISO2;
       useEntries1 = false;
     }
-  #else
-    priorities = priorities1;
-    KeysSz = KeysSz1;
-    MaxValue = MaxValue1;
-    MaxNID = MaxNID1;
-    MaxISO = MaxISO1;
-    useEntries1 = true;
-  #endif
 
   #ifdef __HIP_DEVICE_COMPILE__
   #ifdef DEBUG_KEYSHELPER_CRASH_LOCATIONS
@@ -1,4 +1,5 @@
 #include "opt-sched/Scheduler/register.h"
+#include "opt-sched/Scheduler/aco_context.h"
 #include "opt-sched/Scheduler/dev_defines.h"
 #include "llvm/ADT/STLExtras.h"
 
@@ -174,14 +175,8 @@ void Register::ResetLiveIntervals() {
   possibleLiveIntervalSet_.Reset();
 }
 
-void Register::AllocDevArrayForParallelACO(int numThreads) {
-  // Allocate dev array for crntUseCnt_
-  size_t memSize = sizeof(int) * numThreads;
-  gpuErrchk(hipMalloc(&dev_crntUseCnt_, memSize));
-}
-
-void Register::FreeDevicePointers() {
-  hipFree(dev_crntUseCnt_);
+void Register::SetDevArrayForParallelACO(int *dev_crntUseCnt) {
+  dev_crntUseCnt_ = dev_crntUseCnt;
 }
 
 __host__
@@ -356,27 +351,17 @@ void RegisterFile::Reset() {
   }
 }
 
-void RegisterFile::CopyPointersToDevice(RegisterFile *dev_regFile) {
-  //remove reference to host pointer
-  dev_regFile->Regs = NULL;
-  //declare and allocate array of pointers
-  Register *dev_regs = NULL;
+void RegisterFile::CopyToDevice(RegisterFile *dev_regFile, int numThreads) {
+  ACOContext &Ctx = ACOContext::getInstance();
   size_t memSize;
-  //allocate device memory
+  // One slice of numThreads values for each register
+  memSize = sizeof(int) * numThreads * getCount();
+  int *dev_crntUseCnts = (int *)Ctx.AllocDevArray(memSize);
+  for (int i = 0; i < getCount(); i++)
+    (Regs + i)->SetDevArrayForParallelACO(&dev_crntUseCnts[i * numThreads]);
+  // Copy the registers and link them to the device register file
   memSize = getCount() * sizeof(Register);
-  gpuErrchk(hipMallocManaged(&dev_regs, memSize));
-  //copy array of host pointers to device
+  Register *dev_regs = (Register *)Ctx.AllocDevArray(memSize);
   gpuErrchk(hipMemcpy(dev_regs, Regs, memSize, hipMemcpyHostToDevice));
-  //copy each register to device and update its pointer in dev_regs
-  //update dev_regFile->Regs pointer
   dev_regFile->Regs = dev_regs;
-  memSize = getCount() * sizeof(Register);
-  //gpuErrchk(hipMemPrefetchAsync(dev_regs, memSize, 0));
-}
-
-void RegisterFile::FreeDevicePointers() {
-  for (int i = 0; i < getCount(); i++) {
-    (Regs + i)->FreeDevicePointers();
-  }
-  hipFree(Regs);
 }
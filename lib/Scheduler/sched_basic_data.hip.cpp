@@ -677,10 +677,10 @@ void SchedInstruction::SetBounds(InstCount flb, InstCount blb) {
 
 __host__ __device__
 bool SchedInstruction::PrdcsrSchduld(InstCount prdcsrNum, InstCount cycle,
-                                     InstCount &rdyCycle, InstCount *ltncyPerPrdcsr) {
+                                     InstCount &rdyCycle, UDT_GLABEL ltncy) {
   assert(prdcsrNum < prdcsrCnt_);
 #ifdef __HIP_DEVICE_COMPILE__
-  auto readyCycleBasedOnPredecessor = cycle + ltncyPerPrdcsr[ddgPredecessorIndex + prdcsrNum];
+  auto readyCycleBasedOnPredecessor = cycle + ltncy;
 
   if (readyCycleBasedOnPredecessor > dev_minRdyCycle_[GLOBALTID]) {
     dev_minRdyCycle_[GLOBALTID] = readyCycleBasedOnPredecessor;
@@ -690,7 +690,8 @@ bool SchedInstruction::PrdcsrSchduld(InstCount prdcsrNum, InstCount cycle,
   dev_unschduldPrdcsrCnt_[GLOBALTID]--;
   return (dev_unschduldPrdcsrCnt_[GLOBALTID] == 0);
 #else
-  rdyCyclePerPrdcsr_[prdcsrNum] = cycle + ltncyPerPrdcsr_[prdcsrNum];
+  assert(ltncy == ltncyPerPrdcsr_[prdcsrNum]);
+  rdyCyclePerPrdcsr_[prdcsrNum] = cycle + ltncy;
   prevMinRdyCyclePerPrdcsr_[prdcsrNum] = minRdyCycle_;
 
   if (rdyCyclePerPrdcsr_[prdcsrNum] > minRdyCycle_) {
@@ -964,11 +965,12 @@ else
   registerFiles = RegFiles_;
 
 #ifdef __HIP_DEVICE_COMPILE__
-  RegIndxTuple* use;
+  const DDGBlobView &ddgBlob = ddg->GetDevDDGBlob();
   for (int i = 0; i < useCnt_; i++) {
-    // batched uses array is stored in DDG, access this instruction's uses through the DDG
-    use = ddg->getUseByIndex(ddgUseIndex + i);
-    Register *reg = registerFiles[use->regType_].GetReg(use->regNum_);
+    // The uses are not copied with the instruction, read them from the image
+    // of the DDG
+    RegIndxTuple use = ddgBlob.GetUse(GetNum(), i);
+    Register *reg = registerFiles[use.regType_].GetReg(use.regNum_);
     assert(reg->GetCrntUseCnt() < reg->GetUseCnt());
     if (reg->GetCrntUseCnt() + 1 == reg->GetUseCnt())
       dev_lastUseCnt_[GLOBALTID]++;
@@ -1067,48 +1069,20 @@ void SchedInstruction::InitializeNode_(InstCount instNum,
   GraphNode::SetNum(instNum);
 }
 
-void SchedInstruction::CopyPointersToDevice(SchedInstruction *dev_inst,
-                                            SchedInstruction *dev_nodes,
-					                                  RegisterFile *dev_regFiles) {
+void SchedInstruction::SetupForDevice(int16_t *dev_lastUseCnt,
+                                      InstCount *dev_minRdyCycle,
+                                      InstCount *dev_unschduldPrdcsrCnt) {
+  dev_lastUseCnt_ = dev_lastUseCnt;
+  dev_minRdyCycle_ = dev_minRdyCycle;
+  dev_unschduldPrdcsrCnt_ = dev_unschduldPrdcsrCnt;
 
-  // Store these on the device instruction--we won't be able to compute them without
-  // GraphEdges.
-  dev_inst->dev_maxLatency_ = GetMaxEdgeLabel();
-  dev_inst->dev_latencySum_ = GetScsrLblSum();
-
-  // Index of this instruction's partition in DDG's scsrs_, latencies_, predOrder_.
-  dev_inst->ddgIndex = ddgIndex;
-
-  // Index of this instruction's partition in DDG's ltncyPerPrdcsr_.
-  dev_inst->ddgPredecessorIndex = ddgPredecessorIndex;
-
-  dev_inst->ddgUseIndex = ddgUseIndex;
-  dev_inst->ddgDefIndex = ddgDefIndex;
+  // Store these for the device instruction--we won't be able to compute them
+  // without GraphEdges.
+  dev_maxLatency_ = GetMaxEdgeLabel();
+  dev_latencySum_ = GetScsrLblSum();
 
   // Make sure instruction knows whether it's a leaf on device for legality checking.
-  dev_inst->SetDevIsLeaf(scsrCnt_ == 0);
-}
-
-void SchedInstruction::FreeDevicePointers(int numThreads) {
-  hipFree(dev_lastUseCnt_);
-  hipFree(dev_minRdyCycle_);
-  hipFree(dev_unschduldPrdcsrCnt_);
-  if (rcrsvScsrLst_)
-    hipFree(rcrsvScsrLst_->dev_crnt_);
-  if (rcrsvPrdcsrLst_)
-    hipFree(rcrsvPrdcsrLst_->dev_crnt_);
-}
-
-void SchedInstruction::AllocDevArraysForParallelACO(int numThreads) {
-  // allocate an array of lastUseCnt_ of size numThreads
-  size_t memSize = sizeof(int16_t) * numThreads;
-  gpuErrchk(hipMalloc(&dev_lastUseCnt_, memSize));
-  // Allocate an array of minRdyCycle_ of size numThreads
-  memSize = sizeof(InstCount) * numThreads;
-  gpuErrchk(hipMalloc(&dev_minRdyCycle_, memSize));
-  // Allocate an array of unschduldPrdcsrCnt_ of size numThreads
-  memSize = sizeof(InstCount) * numThreads;
-  gpuErrchk(hipMalloc(&dev_unschduldPrdcsrCnt_, memSize));
+  SetDevIsLeaf(scsrCnt_ == 0);
 }
 
 /******************************************************************************
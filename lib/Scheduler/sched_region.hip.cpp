@@ -1,11 +1,15 @@
 #include "hip/hip_runtime.h"
 #include <algorithm>
 #include <cstdio>
+#include <limits>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "Wrapper/OptSchedDDGWrapperBasic.h"
 #include "opt-sched/Scheduler/aco.h"
+#include "opt-sched/Scheduler/aco_context.h"
+#include "opt-sched/Scheduler/aco_islands.h"
 #include "opt-sched/Scheduler/bb_spill.h"
 #include "opt-sched/Scheduler/config.h"
 #include "opt-sched/Scheduler/graph_trans.h"
@@ -18,6 +22,7 @@
 #include "opt-sched/Scheduler/stats.h"
 #include "opt-sched/Scheduler/utilities.h"
 #include "opt-sched/Scheduler/dev_defines.h"
+#include "llvm/Support/ThreadPool.h"
 #include <hip/hip_profile.h>
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Support/ErrorHandling.h"
@@ -233,6 +238,9 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
                 schedIni.GetInt("ACO_MANY_ANTS_PER_ITERATION_BLOCKS") : schedIni.GetInt("ACO_DEVICE_ANT_PER_ITERATION_BLOCKS");
   else
     numBlocks = schedIni.GetInt("HOST_ANTS");
+  // The grid above is kept, but its ants are emulated by the host scheduler
+  if (devACOEnabled && schedIni.GetBool("DEV_ACO_ON_HOST", false))
+    devACOEnabled = false;
 
   if (AcoSchedulerEnabled) {
     AcoBeforeEnum = schedIni.GetBool("ACO_BEFORE_ENUM");
@@ -532,7 +540,8 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
     AcoSchedule = new InstSchedule(machMdl_, dataDepGraph_, vrfySched_);
 
     rslt = runACO(AcoSchedule, lstSched, false, randSeed, numBlocks, devACOEnabled);
-    if (rslt != RES_SUCCESS) {
+    // A timed out ACO run still returns the best schedule it found
+    if (rslt != RES_SUCCESS && rslt != RES_TIMEOUT) {
       Logger::Fatal("ACO scheduling failed");
       if (lstSchdulr)
         delete lstSchdulr;
@@ -713,7 +722,7 @@ FUNC_RESULT SchedRegion::FindOptimalSchedule(
         new InstSchedule(machMdl_, dataDepGraph_, vrfySched_);
 
     FUNC_RESULT acoRslt = runACO(AcoAfterEnumSchedule, bestSched, true, randSeed, numBlocks, devACOEnabled);
-    if (acoRslt != RES_SUCCESS) {
+    if (acoRslt != RES_SUCCESS && acoRslt != RES_TIMEOUT) {
       Logger::Info("Running final ACO failed");
       delete AcoAfterEnumSchedule;
     } else {
@@ -921,6 +930,62 @@ FUNC_RESULT SchedRegion::Optimize_(Milliseconds startTime,
   return rslt;
 }
 
+FUNC_RESULT SchedRegion::SetupForEnumWorker_(SchedRegion *mainRgn,
+                                             Milliseconds lngthTimeout) {
+  isSecondPass_ = mainRgn->isSecondPass_;
+
+  // The enumerator needs the transitive closure.
+  FUNC_RESULT rslt = dataDepGraph_->SetupForSchdulng(true);
+  if (rslt != RES_SUCCESS)
+    return rslt;
+
+  for (auto &GT : *dataDepGraph_->GetGraphTrans()) {
+    rslt = GT->ApplyTrans();
+    if (rslt != RES_SUCCESS)
+      return rslt;
+
+    rslt = dataDepGraph_->UpdateSetupForSchdulng(true);
+    if (rslt != RES_SUCCESS)
+      return rslt;
+  }
+
+  if (IsSecondPass()) {
+    static_cast<OptSchedDDGWrapperBasic *>(dataDepGraph_)->addArtificialEdges();
+    rslt = dataDepGraph_->UpdateSetupForSchdulng(true);
+    if (rslt != RES_SUCCESS)
+      return rslt;
+  }
+
+  SetupForSchdulng_();
+  CmputAbslutUprBound_();
+  schedLwrBound_ = dataDepGraph_->GetSchedLwrBound();
+  // Sets the lower bounds of the instructions.
+  CmputLwrBounds_(false);
+  dataDepGraph_->SetHard(true);
+
+  schedLwrBound_ = mainRgn->schedLwrBound_;
+  schedUprBound_ = mainRgn->schedUprBound_;
+  costLwrBound_ = mainRgn->costLwrBound_;
+  ExecCostLwrBound_ = mainRgn->ExecCostLwrBound_;
+  RpCostLwrBound_ = mainRgn->RpCostLwrBound_;
+  hurstcCost_ = mainRgn->hurstcCost_;
+  bestCost_ = mainRgn->bestCost_;
+  bestSchedLngth_ = mainRgn->bestSchedLngth_;
+
+  enumCrntSched_ = AllocNewSched_();
+  enumBestSched_ = AllocNewSched_();
+  AllocEnumrtr_(lngthTimeout);
+
+  // The enumerator draws new instruction signatures, but the partial
+  // schedules must have the same signatures on all threads to share their
+  // history.
+  for (InstCount i = 0; i < dataDepGraph_->GetInstCnt(); i++)
+    dataDepGraph_->GetInstByIndx(i)->SetSig(
+        mainRgn->dataDepGraph_->GetInstByIndx(i)->GetSig());
+
+  return RES_SUCCESS;
+}
+
 void SchedRegion::CmputLwrBounds_(bool useFileBounds) {
   RelaxedScheduler *rlxdSchdulr = NULL;
   RelaxedScheduler *rvrsRlxdSchdulr = NULL;
@@ -1097,37 +1162,42 @@ FUNC_RESULT SchedRegion::runACO(InstSchedule *ReturnSched,
   InitForSchdulng();
   FUNC_RESULT Rslt;
   int numThreads = numBlocks * NUMTHREADSPERBLOCK;
+  Milliseconds AcoStart = Utilities::GetProcessorTime();
+  // Both ACO runs of a region share its limit. Once it is used up only the
+  // heuristic ant is run.
+  Milliseconds Timeout = 0;
+  if (acoTimeout_ > 0)
+    Timeout = std::max<Milliseconds>(acoTimeout_ - acoTime_, 1);
+  Config &schedIni = SchedulerOptions::getInstance();
+  int IslandCnt = std::max<int>(1, schedIni.GetInt("ACO_ISLANDS", 1));
   // Num of edges are used to filter out the few regions that are too large
   // to fit in device memory
   Logger::Info("This DDG has %d edges", dataDepGraph_->GetEdgeCnt());
   Logger::Info("CP Distance: %d", dataDepGraph_->GetRootInst()->GetCrntLwrBound(DIR_BKWRD) + 1);
   if (devACOEnabled && dataDepGraph_->GetInstCnt() >= REGION_MIN_SIZE) {
-    // Allocate and Copy data to device for parallel ACO
+    // Allocate and Copy data to device for parallel ACO. All device memory
+    // is kept by the ACO context. The arrays of the previous region are
+    // released here, once it is done with them.
+    ACOContext &Ctx = ACOContext::getInstance();
+    Ctx.ResetDevArrays();
     size_t memSize;
     // Allocate arrays for parallel ACO execution
-    for (int i = 0; i < dataDepGraph_->GetInstCnt(); i++) {
-      dataDepGraph_->GetInstByIndx(i)->AllocDevArraysForParallelACO(numThreads);
-    }
-    RegisterFile *regFiles = dataDepGraph_->getRegFiles();
-    for (int i = 0; i < dataDepGraph_->GetRegTypeCnt(); i++) {
-      for (int j = 0; j < regFiles[i].GetRegCnt(); j++)
-        regFiles[i].GetReg(j)->AllocDevArrayForParallelACO(numThreads);
-    }
     ((BBWithSpill*)this)->AllocDevArraysForParallelACO(numThreads);
     // Copy DDG and its objects to device
     Logger::Info("Copying DDG and its Instruction to device");
     DataDepGraph *dev_DDG;
     memSize = sizeof(DataDepGraph);
-    gpuErrchk(hipMallocManaged(&dev_DDG, memSize));
+    dev_DDG = (DataDepGraph *)Ctx.GetDevBuffer(DB_DDG, memSize);
     gpuErrchk(hipMemcpy(dev_DDG, dataDepGraph_, memSize,
                          hipMemcpyHostToDevice));
-    dataDepGraph_->CopyPointersToDevice(dev_DDG, numThreads);
+    DDGBlob DdgBlob;
+    DdgBlob.Build(dataDepGraph_);
+    dataDepGraph_->CopyToDevice(dev_DDG, DdgBlob, numThreads);
     Logger::Info("Done Copying DDG and its Instruction to device");
     // Copy this(BBWithSpill) to device
     BBWithSpill *dev_rgn;
     memSize = sizeof(BBWithSpill);
-    // Allocate device mem
-    gpuErrchk(hipMallocManaged((void**)&dev_rgn, memSize));
+    dev_rgn = (BBWithSpill *)Ctx.GetDevBuffer(DB_RGN, memSize);
     // Copy this to device
     gpuErrchk(hipMemcpy(dev_rgn, this, memSize, hipMemcpyHostToDevice));
     dev_rgn->machMdl_ = dev_machMdl_;
@@ -1135,7 +1205,7 @@ FUNC_RESULT SchedRegion::runACO(InstSchedule *ReturnSched,
     // Allocate dev_states for hiprand RNG and run hiprand_init() to initialize
     hiprandState_t *dev_states;
     memSize = sizeof(hiprandState_t) * numThreads;
-    gpuErrchk(hipMalloc(&dev_states, memSize));
+    dev_states = (hiprandState_t *)Ctx.GetDevBuffer(DB_RAND_STATES, memSize);
     hipLaunchKernelGGL(InitCurand, numBlocks, NUMTHREADSPERBLOCK, 0, 0, dev_states,
                                                   randSeed == 0 ? unsigned(time(NULL)) : randSeed,
                                                   dataDepGraph_->GetInstCnt());
@@ -1144,12 +1214,13 @@ FUNC_RESULT SchedRegion::runACO(InstSchedule *ReturnSched,
         vrfySched_, IsPostBB, numBlocks, (SchedRegion *)dev_rgn, dev_DDG,
         dev_machMdl_, dev_states);
     AcoSchdulr->setInitialSched(InitSched);
+    AcoSchdulr->SetTimeout(Timeout);
     // Alloc dev arrays for parallel ACO
     AcoSchdulr->AllocDevArraysForParallelACO();
     // Copy ACOScheduler to device
     ACOScheduler *dev_AcoSchdulr;
     memSize = sizeof(ACOScheduler);
-    gpuErrchk(hipMallocManaged(&dev_AcoSchdulr, memSize));
+    dev_AcoSchdulr = (ACOScheduler *)Ctx.GetDevBuffer(DB_ACO, memSize);
     gpuErrchk(hipMemcpy(dev_AcoSchdulr, AcoSchdulr, memSize,
                          hipMemcpyHostToDevice));
     AcoSchdulr->CopyPointersToDevice(dev_AcoSchdulr, IsSecondPass());
@@ -1163,28 +1234,90 @@ FUNC_RESULT SchedRegion::runACO(InstSchedule *ReturnSched,
     Rslt = AcoSchdulr->FindSchedule(ReturnSched, this, dev_AcoSchdulr);
 
     dev_AcoSchdulr->FreeDevicePointers(IsSecondPass());
-    hipFree(dev_AcoSchdulr);
     delete AcoSchdulr;
-    dev_rgn->FreeDevicePointers(numThreads);
-    hipFree(dev_rgn);
-    dev_DDG->FreeDevicePointers(numThreads);
-    hipFree(dev_DDG);
-    hipFree(dev_states);
-    // For some reason crashed OptSched to have this in the destructor
-    // so call to delete it here
-    dataDepGraph_->FreeDevEdges();
     // Ocasionally BBWithSpill deletes an empty pointer, which causes the next
     // kernel to report an invalid argument error after execution even
     // though the non issue error happens here. This call is to clear errors
     // from BBWithSpill deletion.
     hipGetLastError();
+  } else if (IslandCnt > 1 && dataDepGraph_->GetInstCnt() >= REGION_MIN_SIZE) {
+    Rslt = runACOIslands_(ReturnSched, InitSched, IsPostBB, numBlocks, Timeout,
+                          IslandCnt);
   } else {
     ACOScheduler *AcoSchdulr = 
         new ACOScheduler(dataDepGraph_, machMdl_, abslutSchedUprBound_,
                          acoPrirts1_, acoPrirts2_, vrfySched_, IsPostBB, numBlocks);
     AcoSchdulr->setInitialSched(InitSched);
+    AcoSchdulr->SetTimeout(Timeout);
     Rslt = AcoSchdulr->FindSchedule(ReturnSched, this);
     delete AcoSchdulr;
   }
+  acoTime_ += Utilities::GetProcessorTime() - AcoStart;
+  if (Rslt == RES_TIMEOUT)
+    stats::acoTimeouts++;
+  return Rslt;
+}
+
+FUNC_RESULT SchedRegion::runACOIslands_(InstSchedule *ReturnSched,
+                                        InstSchedule *InitSched, bool IsPostBB,
+                                        int numBlocks, Milliseconds Timeout,
+                                        int islandCnt) {
+  Config &schedIni = SchedulerOptions::getInstance();
+  int MigrationInterval =
+      std::max<int>(1, schedIni.GetInt("ACO_MIGRATION_INTERVAL", 10));
+  Logger::Info("Running ACO as %d colonies migrating every %d iterations",
+               islandCnt, MigrationInterval);
+  ACOIslands Islands(islandCnt, MigrationInterval, machMdl_, dataDepGraph_);
+  std::vector<std::unique_ptr<ACOScheduler>> Colonies;
+  // Every colony gets its own copy of the initial schedule, since ACO
+  // iterates over the schedule it deposits
+  std::vector<std::unique_ptr<InstSchedule>> InitScheds;
+  std::vector<std::unique_ptr<InstSchedule>> Scheds;
+  std::vector<FUNC_RESULT> Rslts(islandCnt, RES_SUCCESS);
+  for (int i = 0; i < islandCnt; i++) {
+    // In the second pass every other colony uses the second ACO heuristic
+    bool UseSecond = IsSecondPass() && i % 2 == 1;
+    Colonies.push_back(std::make_unique<ACOScheduler>(
+        dataDepGraph_, machMdl_, abslutSchedUprBound_,
+        UseSecond ? acoPrirts2_ : acoPrirts1_,
+        UseSecond ? acoPrirts1_ : acoPrirts2_, vrfySched_, IsPostBB,
+        numBlocks));
+    InitScheds.push_back(
+        std::make_unique<InstSchedule>(machMdl_, dataDepGraph_, vrfySched_));
+    InitScheds[i]->Copy(InitSched);
+    Scheds.push_back(
+        std::make_unique<InstSchedule>(machMdl_, dataDepGraph_, vrfySched_));
+    Colonies[i]->setInitialSched(InitScheds[i].get());
+    Colonies[i]->SetTimeout(Timeout);
+    Colonies[i]->SetIsland(&Islands, i);
+  }
+
+  // The colonies wait for each other, so each needs its own thread
+  ThreadPool *Pool =
+      ACOContext::getInstance().GetIslandThreadPool(islandCnt);
+  int32_t Seed = RandomGen::GetSeed();
+  auto StartTime = Utilities::startTime;
+  for (int i = 0; i < islandCnt; i++)
+    Pool->async([&, i]() {
+      RandomGen::SetSeed(Seed);
+      Utilities::startTime = StartTime;
+      Rslts[i] = Colonies[i]->FindSchedule(Scheds[i].get(), this);
+    });
+  Pool->wait();
+
+  int Best = 0;
+  FUNC_RESULT Rslt = Rslts[0];
+  for (int i = 1; i < islandCnt; i++) {
+    InstCount RPTarget = ((BBWithSpill *)this)->needsSLIL()
+                             ? std::numeric_limits<InstCount>::max()
+                             : Scheds[Best]->GetSpillCost();
+    if (Colonies[0]->shouldReplaceSchedule(Scheds[Best].get(), Scheds[i].get(),
+                                           true, RPTarget))
+      Best = i;
+    if (Rslts[i] == RES_TIMEOUT)
+      Rslt = RES_TIMEOUT;
+  }
+  Logger::Info("ACO colony %d found the best schedule", Best);
+  ReturnSched->Copy(Scheds[Best].get());
   return Rslt;
 }
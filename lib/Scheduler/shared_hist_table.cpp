@@ -0,0 +1,256 @@
+#include "opt-sched/Scheduler/shared_hist_table.h"
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/enumerator.h"
+#include "opt-sched/Scheduler/hist_table.h"
+#include "opt-sched/Scheduler/machine_model.h"
+#include <algorithm>
+
+using namespace llvm::opt_sched;
+
+// The bit set of the node being checked or added on this thread.
+static thread_local std::vector<uint64_t> nodeInstsSchduld;
+
+SharedHistTable::SharedHistTable(DataDepGraph *dataDepGraph, int issuRate,
+                                 size_t entryCnt)
+    : locks_(MAX_LOCK_CNT), clock_(0), entryCnt_(0), hitCnt_(0),
+      evictionCnt_(0) {
+  instCnt_ = dataDepGraph->GetInstCnt();
+  issuRate_ = issuRate;
+  maxLtncy_ = dataDepGraph->GetMaxLtncy();
+  wordCnt_ = (instCnt_ + 63) / 64;
+  lastInstCnt_ = std::max<UDT_GLABEL>(maxLtncy_, 1) * issuRate_ + 1;
+
+  // Use a power of two sets so that a set can be selected with a shift.
+  setCnt_ = 1;
+  while (setCnt_ * 2 * WAY_CNT <= entryCnt)
+    setCnt_ *= 2;
+
+  entries_.resize(setCnt_ * WAY_CNT);
+  schduldInsts_.resize(entries_.size() * wordCnt_);
+  lastInsts_.resize(entries_.size() * lastInstCnt_);
+  Clear();
+}
+
+void SharedHistTable::Clear() {
+  for (Entry &entry : entries_)
+    entry.lastUse = 0;
+  trgtLngth_ = INVALID_VALUE;
+  clock_ = 0;
+  entryCnt_ = 0;
+  hitCnt_ = 0;
+  evictionCnt_ = 0;
+}
+
+void SharedHistTable::StartLength(InstCount trgtLngth) {
+  if (trgtLngth != trgtLngth_)
+    Clear();
+  trgtLngth_ = trgtLngth;
+}
+
+size_t SharedHistTable::GetSet_(InstSignature sig) const {
+  // The low bits of the instruction signatures hold the instruction numbers,
+  // so mix all the bits before selecting a set.
+  uint64_t hash = (uint64_t)sig * 0x9E3779B97F4A7C15ULL;
+  return (size_t)(hash >> 32) & (setCnt_ - 1);
+}
+
+void SharedHistTable::SetInstsSchduld_(EnumTreeNode *node,
+                                       uint64_t *words) const {
+  std::fill(words, words + wordCnt_, 0);
+
+  for (EnumTreeNode *crntNode = node; crntNode != NULL;
+       crntNode = crntNode->GetParent()) {
+    SchedInstruction *inst = crntNode->GetInst();
+
+    if (inst != NULL)
+      words[inst->GetNum() / 64] |= (uint64_t)1 << (inst->GetNum() % 64);
+  }
+}
+
+void SharedHistTable::Insert(EnumTreeNode *node, Enumerator *enumrtr) {
+  // The reserved slots of unpipelined instructions are not kept.
+  if (node->rsrvSlots_ != NULL)
+    return;
+
+  nodeInstsSchduld.resize(wordCnt_);
+  SetInstsSchduld_(node, nodeInstsSchduld.data());
+
+  InstSignature sig = node->GetSig();
+  size_t set = GetSet_(sig);
+  std::lock_guard<std::mutex> lock(locks_[set % locks_.size()]);
+
+  // Take a free way, or else the least recently used one.
+  size_t indx = set * WAY_CNT;
+  for (size_t way = set * WAY_CNT; way < (set + 1) * WAY_CNT; way++) {
+    if (entries_[way].lastUse < entries_[indx].lastUse)
+      indx = way;
+  }
+
+  Entry &entry = entries_[indx];
+  if (entry.lastUse == 0)
+    entryCnt_++;
+  else
+    evictionCnt_++;
+
+  entry.sig = sig;
+  entry.lastUse = ++clock_;
+  entry.time = node->GetTime();
+  entry.crntCycleBlkd = node->crntCycleBlkd_;
+  entry.isLngthFsbl = node->IsLngthFsbl();
+  entry.cost = node->GetCost();
+  entry.partialCost = node->GetCostLwrBound();
+  entry.totalCost = node->GetTotalCost();
+  entry.spillCostSum = node->GetSpillCostSum();
+  entry.costBound =
+      enumrtr->IsCostEnum()
+          ? static_cast<LengthCostEnumerator *>(enumrtr)->GetBestCost()
+          : 0;
+
+  std::copy(nodeInstsSchduld.begin(), nodeInstsSchduld.end(),
+            schduldInsts_.begin() + indx * wordCnt_);
+
+  InstCount *lastInsts = &lastInsts_[indx * lastInstCnt_];
+  EnumTreeNode *crntNode = node;
+  for (size_t i = 0; i < lastInstCnt_; i++) {
+    // The root node (time 0) has no instruction.
+    if (crntNode == NULL || crntNode->GetTime() == 0) {
+      lastInsts[i] = SCHD_STALL;
+      continue;
+    }
+
+    SchedInstruction *inst = crntNode->GetInst();
+    lastInsts[i] = inst == NULL ? SCHD_STALL : inst->GetNum();
+    crntNode = crntNode->GetParent();
+  }
+}
+
+bool SharedHistTable::IsDominated(EnumTreeNode *node, Enumerator *enumrtr) {
+  InstSignature sig = node->GetSig();
+  size_t set = GetSet_(sig);
+  std::lock_guard<std::mutex> lock(locks_[set % locks_.size()]);
+
+  // The set of scheduled instructions is only traced back when an entry has
+  // the same signature, since most nodes have none.
+  bool isSetBuilt = false;
+  for (size_t indx = set * WAY_CNT; indx < (set + 1) * WAY_CNT; indx++) {
+    Entry &entry = entries_[indx];
+
+    if (entry.lastUse == 0 || entry.sig != sig)
+      continue;
+
+    if (!isSetBuilt) {
+      nodeInstsSchduld.resize(wordCnt_);
+      SetInstsSchduld_(node, nodeInstsSchduld.data());
+      isSetBuilt = true;
+    }
+
+    if (!std::equal(nodeInstsSchduld.begin(), nodeInstsSchduld.end(),
+                    schduldInsts_.begin() + indx * wordCnt_))
+      continue;
+
+    // Check the entry like CostHistEnumTreeNode::DoesDominate() or
+    // HistEnumTreeNode::DoesDominate() would check a local history node.
+    bool isDmnnt;
+    if (enumrtr->IsCostEnum()) {
+      if (!enumrtr->IsSchedForRPOnly() && !DoesDominate_(indx, node, enumrtr))
+        continue;
+
+      isDmnnt = (!enumrtr->IsSchedForRPOnly() && !entry.isLngthFsbl) ||
+                (static_cast<LengthCostEnumerator *>(enumrtr)->GetBestCost() <=
+                     entry.costBound &&
+                 doesHistoryCostDominate(node, enumrtr, entry.time, entry.cost,
+                                        entry.partialCost, entry.totalCost,
+                                        entry.spillCostSum));
+    } else {
+      isDmnnt = DoesDominate_(indx, node, enumrtr);
+    }
+
+    if (isDmnnt) {
+      entry.lastUse = ++clock_;
+      hitCnt_++;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool SharedHistTable::DoesDominate_(size_t indx, EnumTreeNode *node,
+                                    Enumerator *enumrtr) {
+  const Entry &entry = entries_[indx];
+  const InstCount *lastInsts = &lastInsts_[indx * lastInstCnt_];
+  DataDepGraph *dataDepGraph = enumrtr->dataDepGraph_;
+  MachineModel *machMdl = enumrtr->machMdl_;
+  InstCount *instsPerType = enumrtr->histInstsPerType_;
+  InstCount *nxtAvlblCycles = enumrtr->histNxtAvlblCycles_;
+  InstCount thisTime = entry.time;
+
+  if (thisTime > node->GetTime())
+    return false;
+
+  if (node->crntCycleBlkd_ != entry.crntCycleBlkd)
+    return false;
+
+  // Find the cycles in which each issue type is available next, as
+  // HistEnumTreeNode::CmputNxtAvlblCycles_() does.
+  InstCount crntCycle = enumrtr->GetCycleNumFrmTime_(thisTime);
+  int issuTypeCnt = machMdl->GetIssueTypeCnt();
+
+  for (int i = 0; i < issuTypeCnt; i++) {
+    instsPerType[i] = 0;
+    nxtAvlblCycles[i] = crntCycle;
+  }
+
+  InstCount cycleNum = crntCycle;
+  for (InstCount time = thisTime, i = 0; time >= 0 && cycleNum == crntCycle;
+       time--, i++) {
+    cycleNum = enumrtr->GetCycleNumFrmTime_(time);
+
+    if (lastInsts[i] == SCHD_STALL)
+      continue;
+
+    IssueType issuType =
+        dataDepGraph->GetInstByIndx(lastInsts[i])->GetIssueType();
+    instsPerType[issuType]++;
+
+    if (instsPerType[issuType] == machMdl->GetSlotsPerCycle(issuType))
+      nxtAvlblCycles[issuType] = crntCycle + 1;
+  }
+
+  // Check that no successor of the last instructions is pushed down further
+  // than in the given node, as HistEnumTreeNode::DoesDominate_() does.
+  InstCount minCycleNumToExmn = std::max(crntCycle + 1 - maxLtncy_, 0);
+  InstCount minTimeToExmn = minCycleNumToExmn * issuRate_ + 1;
+  InstCount *othrLwrBounds = node->frwrdLwrBounds_;
+
+  for (InstCount time = thisTime, i = 0; time >= minTimeToExmn; time--, i++) {
+    if (lastInsts[i] == SCHD_STALL)
+      continue;
+
+    SchedInstruction *inst = dataDepGraph->GetInstByIndx(lastInsts[i]);
+    cycleNum = enumrtr->GetCycleNumFrmTime_(time);
+
+    if (cycleNum <= inst->GetLwrBound(DIR_FRWRD))
+      continue;
+
+    UDT_GLABEL ltncy;
+    DependenceType depType;
+
+    for (SchedInstruction *scsr = inst->GetFrstScsr(NULL, &ltncy, &depType);
+         scsr != NULL; scsr = inst->GetNxtScsr(NULL, &ltncy, &depType)) {
+      if (scsr->IsSchduld())
+        continue;
+
+      InstCount nxtAvlblCycle = nxtAvlblCycles[scsr->GetIssueType()];
+      InstCount thisBound = std::max<InstCount>(cycleNum + ltncy,
+                                                nxtAvlblCycle);
+      InstCount normBound =
+          std::max(scsr->GetLwrBound(DIR_FRWRD), nxtAvlblCycle);
+
+      if (thisBound > normBound && thisBound > othrLwrBounds[scsr->GetNum()])
+        return false;
+    }
+  }
+
+  return true;
+}
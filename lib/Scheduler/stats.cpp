@@ -13,6 +13,7 @@ DistributionStat<T>::DistributionStat(const string name) : Stat(name) {
 }
 
 template <class T> void DistributionStat<T>::Record(T value) {
+  std::lock_guard<std::mutex> lock(mutex_);
   count_++;
   sum_ += value;
   if (value < min_)
@@ -79,6 +80,7 @@ template <class T> void IndexedSetStat<T>::Print(std::ostream &out) const {
 
 void TimeoutStat::Record(int regionNumber, InstCount instCount, int lowerBound,
                          int upperBound) {
+  std::lock_guard<std::mutex> lock(mutex_);
   entries_.push_back(Entry(regionNumber, instCount, lowerBound, upperBound));
 }
 
@@ -118,6 +120,7 @@ namespace opt_sched {
 namespace stats {
 
 ostream &operator<<(ostream &out, const Stat &stat) {
+  std::lock_guard<std::mutex> lock(stat.mutex_);
   stat.Print(out);
   return out;
 }
@@ -165,6 +168,7 @@ IntDistributionStat traceOptimalScheduleLength("Trace optimal schedule length");
 IntDistributionStat regionBuildTime("Region build time");
 IntDistributionStat heuristicTime("Heuristic time");
 IntDistributionStat AcoTime("ACO time");
+IntDistributionStat acoScheduleAllocations("ACO schedule allocations");
 IntDistributionStat boundComputationTime("Bound computation time");
 IntDistributionStat enumerationTime("Enumeration time");
 IntDistributionStat
@@ -180,11 +184,25 @@ IntDistributionStat historyDominationPositionToListSize(
     "History domination position to list size");
 IntDistributionStat
     historyTableInitializationTime("History table initialization time");
+IntDistributionStat historyTableEntries("History table entries");
+IntDistributionStat historyTableMemory("History table peak bytes");
 
 IntDistributionStat scheduledLatency("Scheduled latency");
 
 TimeoutStat timeouts("Timeouts");
 
+IntStat acoPheromoneCacheHits("ACO pheromone cache hits");
+IntStat acoTimeouts("ACO timeouts");
+IntStat acoTimedOutAnts("ACO ants not run after a timeout");
+IntStat acoImmigrants("ACO immigrant schedules taken");
+IntStat acoLocalSearchImprovements("ACO schedules improved by local search");
+IntStat acoDuplicateAnts("ACO duplicate ants");
+IntStat sharedHistoryDominationHits("Shared history domination hits");
+IntStat sharedHistoryEvictions("Shared history evictions");
+IntStat historyTableHits("History table hits");
+IntStat historyTableMisses("History table misses");
+IntStat historyTableEvictions("History table evictions");
+
 IntStat perfectMatchCount("Perfect match count");
 IntStat positiveMismatchCount("Positive mismatch count");
 IntStat negativeMismatchCount("Negative mismatch count");
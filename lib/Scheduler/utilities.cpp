@@ -3,5 +3,5 @@
 
 using namespace llvm::opt_sched;
 
-std::chrono::high_resolution_clock::time_point Utilities::startTime =
-    std::chrono::high_resolution_clock::now();
+thread_local std::chrono::high_resolution_clock::time_point
+    Utilities::startTime = std::chrono::high_resolution_clock::now();
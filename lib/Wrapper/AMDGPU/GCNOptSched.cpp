@@ -80,10 +80,14 @@ void ScheduleDAGOptSchedGCN::finalizeSchedule() {
 
     LLVM_DEBUG(dbgs() << "Starting two pass scheduling approach\n");
     TwoPassSchedulingStarted = true;
+    RegionPotentials.assign(Regions.size(), 0.0);
     for (const SchedPassStrategy &S : SchedPasses) {
       MachineBasicBlock *MBB = nullptr;
       // Reset
       RegionNumber = ~0u;
+      if (S == OptSchedBalanced)
+        planSecondPassBudget();
+      DeferRegionSearch = canDeferRegionSearch();
 
       for (auto &Region : Regions) {
         RegionBegin = Region.first;
@@ -111,6 +115,8 @@ void ScheduleDAGOptSchedGCN::finalizeSchedule() {
         exitRegion();
       }
       finishBlock();
+      if (DeferRegionSearch)
+        scheduleDeferredRegions();
     }
   }
 
@@ -13,6 +13,7 @@
 #include "GCNSubtarget.h"
 #include "OptSchedMachineWrapper.h"
 #include "opt-sched/Scheduler/OptSchedTarget.h"
+#include "opt-sched/Scheduler/bb_spill.h"
 #include "opt-sched/Scheduler/config.h"
 #include "opt-sched/Scheduler/data_dep.h"
 #include "opt-sched/Scheduler/graph_trans.h"
@@ -23,6 +24,7 @@
 #include "GCNRegPressure.h"
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 using namespace llvm;
@@ -158,6 +160,9 @@ protected:
   // The OptSched target machine.
   std::unique_ptr<OptSchedTarget> OST;
 
+  // Creates the OptSched target machine.
+  OptSchedTargetRegistry::OptSchedTargetFactory TargetFactory;
+
   // into the OptSched machine model
   std::unique_ptr<OptSchedMachineModel> MM;
 
@@ -206,6 +211,72 @@ protected:
   int SecondPassRegionTimeout;
   int SecondPassLengthTimeout;
 
+  // A time limit for ACO in each region and for ACO in all regions of the
+  // compilation, in milliseconds. 0 means no limit.
+  int AcoRegionTimeout;
+  int AcoTotalTimeout;
+
+  // A time limit in milliseconds for the second pass over all regions of the
+  // function. When set, it replaces the fixed second pass limits and is split
+  // across the regions in proportion to their improvement potential measured
+  // in the first pass. 0 means no function limit.
+  int FunctionTimeout;
+
+  // The improvement potential of each region, indexed by region number. It is
+  // the gap between the first pass heuristic cost and the cost lower bound,
+  // weighted by the loop depth of the region.
+  std::vector<double> RegionPotentials;
+
+  // The function budget and the potential of the regions that the second pass
+  // has not scheduled yet. Guarded by BudgetMutex while regions are searched
+  // concurrently.
+  int64_t BudgetLeft;
+  double PotentialLeft;
+  std::mutex BudgetMutex;
+
+  // The seed that the generator of each region is derived from.
+  int32_t RandomSeed;
+
+  // The number of threads that search the regions of a pass concurrently in
+  // two pass scheduling. 1 means regions are scheduled one at a time.
+  int RegionThreads;
+
+  // A region that has been converted to OptSched and is searched apart from
+  // the LLVM DAG, possibly on another thread.
+  struct RegionJob {
+    unsigned Number;
+    // Set only for regions searched concurrently. Otherwise OST is used.
+    std::unique_ptr<OptSchedTarget> Target;
+    std::unique_ptr<OptSchedDDGWrapperBase> DDG;
+    // The copies of the graph searched by the enumerator threads of Region.
+    std::vector<std::unique_ptr<OptSchedDDGWrapperBase>> WorkerDDGs;
+    std::unique_ptr<BBWithSpill> Region;
+    // Inputs of the search. The time limits are cut to the function budget
+    // when the search starts.
+    Milliseconds RegionTimeout;
+    Milliseconds LengthTimeout;
+    Milliseconds AcoTimeout;
+    bool FilterByPerp;
+    BLOCKS_TO_KEEP BlocksToKeep;
+    unsigned LoopDepth;
+    // Results of the search.
+    FUNC_RESULT Rslt = RES_ERROR;
+    bool IsEasy = false;
+    InstCount NormBestCost = 0;
+    InstCount BestSchedLngth = 0;
+    InstCount NormHurstcCost = 0;
+    InstCount HurstcSchedLngth = 0;
+    InstSchedule *Sched = nullptr;
+    // The occupancy of the function when the region was converted. The
+    // target occupancy of the region was computed from it.
+    unsigned Occupancy;
+  };
+
+  // While set, schedule() only converts the region and queues it in
+  // DeferredRegions instead of searching it.
+  bool DeferRegionSearch;
+  std::vector<std::unique_ptr<RegionJob>> DeferredRegions;
+
   int OccupancyLimit;
 
   bool ShouldLimitOccupancy;
@@ -307,6 +378,39 @@ protected:
   // Load config files for the OptScheduler and set flags
   void loadOptSchedConfig();
 
+  // Record the improvement potential of a region after the first pass has
+  // scheduled it.
+  void recordRegionPotential(unsigned Number, unsigned LoopDepth,
+                             InstCount NormHurstcCost);
+
+  // Split the function time limit across the regions for the second pass.
+  void planSecondPassBudget();
+
+  // Take the share of the function budget that the second pass may spend on
+  // a region, in milliseconds, out of the budget.
+  int64_t reserveRegionBudget(unsigned Number);
+
+  // Give the part of a reserved share that the region did not use back to
+  // the function budget.
+  void refundRegionBudget(int64_t Reserved, int64_t TimeUsed);
+
+  // Create a target machine set up like OST.
+  std::unique_ptr<OptSchedTarget> createTarget() const;
+
+  // Search a converted region for a schedule. May run on any thread.
+  void searchRegion(RegionJob &Job);
+
+  // Apply the schedule found for a region to the current LLVM DAG.
+  void applyRegion(RegionJob &Job);
+
+  // Return true if the regions of a pass can be searched concurrently.
+  bool canDeferRegionSearch() const;
+
+  // Search the regions queued by the pass concurrently, then apply their
+  // schedules in region order. A region whose occupancy was lowered by an
+  // earlier one is searched again.
+  void scheduleDeferredRegions();
+
   // Get lower bound algorithm
   LB_ALG parseLowerBoundAlgorithm() const;
 
@@ -8,6 +8,7 @@
 #include "OptSchedMachineWrapper.h"
 #include "opt-sched/Scheduler/OptSchedDDGWrapperBase.h"
 #include "opt-sched/Scheduler/OptSchedTarget.h"
+#include "opt-sched/Scheduler/aco_context.h"
 #include "opt-sched/Scheduler/bb_spill.h"
 #include "opt-sched/Scheduler/config.h"
 #include "opt-sched/Scheduler/data_dep.h"
@@ -34,6 +35,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "opt-sched/Scheduler/dev_defines.h"
 #include "opt-sched/Scheduler/aco.h"
@@ -41,7 +43,9 @@
 #include "GCNRegPressure.h"
 #include "SIMachineFunctionInfo.h"
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <string>
 
 #define DEBUG_TYPE "optsched"
@@ -78,6 +82,10 @@ static constexpr const char *DEFAULT_CFGMM_FNAME = "/machine_model.cfg";
 // Default path to the machine model specification file for opt-sched.
 static constexpr const char *DEFAULT_CFGOCL_FNAME = "/occupancy_limits.ini";
 
+// The time spent in ACO by all regions of the compilation so far, in
+// milliseconds. Counted against ACO_TOTAL_TIMEOUT.
+static std::atomic<int64_t> AcoTimeUsed(0);
+
 // Command line options for opt-sched.
 static cl::opt<std::string> OptSchedCfg(
     "optsched-cfg", cl::Hidden,
@@ -217,7 +225,7 @@ ScheduleDAGOptSched::ScheduleDAGOptSched(
   loadOptSchedConfig();
 
   StringRef ArchName = TM.getTargetTriple().getArchName();
-  auto TargetFactory =
+  TargetFactory =
       OptSchedTargetRegistry::Registry.getFactoryWithName(ArchName);
 
   if (!TargetFactory)
@@ -227,14 +235,7 @@ ScheduleDAGOptSched::ScheduleDAGOptSched(
   maxRegionSize = 0;
   maxEdgeCnt = 0;
 
-  OST = TargetFactory();
-
-  if ((strncmp("amdgcn", ArchName.data(), 6) == 0) ||
-      (strncmp("amdgcn-amd-amdhsa", ArchName.data(), 17) == 0)) {
-        OST->SetOccupancyLimit(OccupancyLimit);
-        OST->SetShouldLimitOcc(ShouldLimitOccupancy);
-        OST->SetOccLimitSource(OccupancyLimitSource);
-  }
+  OST = createTarget();
 
   MM = OST->createMachineModel(PathCfgMM.c_str());
   MM->convertMachineModel(static_cast<ScheduleDAGInstrs &>(*this),
@@ -242,11 +243,26 @@ ScheduleDAGOptSched::ScheduleDAGOptSched(
   dev_MM = NULL;
 }
 
+std::unique_ptr<OptSchedTarget> ScheduleDAGOptSched::createTarget() const {
+  std::unique_ptr<OptSchedTarget> Target = TargetFactory();
+
+  StringRef ArchName = TM.getTargetTriple().getArchName();
+  if ((strncmp("amdgcn", ArchName.data(), 6) == 0) ||
+      (strncmp("amdgcn-amd-amdhsa", ArchName.data(), 17) == 0)) {
+        Target->SetOccupancyLimit(OccupancyLimit);
+        Target->SetShouldLimitOcc(ShouldLimitOccupancy);
+        Target->SetOccLimitSource(OccupancyLimitSource);
+  }
+  return Target;
+}
+
 ScheduleDAGOptSched::~ScheduleDAGOptSched() {
   if (DeviceACOEnabled && dev_MM) {
     dev_MM->FreeDevicePointers();
     hipFree(dev_MM);
   }
+  if (DeviceACOEnabled)
+    ACOContext::getInstance().FreeDevBuffers();
 }
 
 void ScheduleDAGOptSched::SetupLLVMDag() {
@@ -631,11 +647,20 @@ void ScheduleDAGOptSched::schedule() {
     SchedEval.calcualteILPBefore();
   }
 
+  auto Job = std::make_unique<RegionJob>();
+  Job->Number = RegionNumber;
+  // Regions searched concurrently each need a target for their own occupancy.
+  if (DeferRegionSearch)
+    Job->Target = createTarget();
+  OptSchedTarget *Target = Job->Target ? Job->Target.get() : OST.get();
+
   // Build LLVM DAG
-  OST->initRegion(this, MM.get(), OccupancyLimits);
+  Job->Occupancy = MF.getInfo<SIMachineFunctionInfo>()->getOccupancy();
+  Target->initRegion(this, MM.get(), OccupancyLimits);
   // Convert graph
-  auto DDG =
-      OST->createDDGWrapper(C, this, MM.get(), LatencyPrecision, RegionName);
+  Job->DDG =
+      Target->createDDGWrapper(C, this, MM.get(), LatencyPrecision, RegionName);
+  auto &DDG = Job->DDG;
   
   // In the second pass, ignore artificial edges before running the sequential
   // heuristic list scheduler.
@@ -650,7 +675,8 @@ void ScheduleDAGOptSched::schedule() {
   addGraphTransformations(BDDG);
 
   // Prepare for device scheduling by increasing heap size and copying machMdl
-  bool dev_ACOEnabled = schedIni.GetBool("DEV_ACO");
+  bool dev_ACOEnabled = schedIni.GetBool("DEV_ACO") &&
+                        !schedIni.GetBool("DEV_ACO_ON_HOST", false);
   if (dev_ACOEnabled && dev_MM == NULL && NumRegionInstrs + 2 >= REGION_MIN_SIZE) {
     // Copy MachineModel to device for use during DevListSched.
     // Allocate device memory
@@ -665,20 +691,32 @@ void ScheduleDAGOptSched::schedule() {
   }
   
   // create region
-  auto region = std::make_unique<BBWithSpill>(
-      OST.get(), static_cast<DataDepGraph *>(DDG.get()), RegionNumber, HistTableHashBits,
+  Job->Region = std::make_unique<BBWithSpill>(
+      Target, static_cast<DataDepGraph *>(DDG.get()), RegionNumber, HistTableHashBits,
       LowerBoundAlgorithm, HeuristicPriorities, EnumPriorities, VerifySchedule,
       PruningStrategy, SchedForRPOnly, EnumStalls, SCW, SCF, HeurSchedType,
       dev_MM, AcoPriorities1, AcoPriorities2);
+  auto &region = Job->Region;
+
+  // A region searched on this thread may enumerate on several threads, each
+  // of which needs its own copy of the graph. The copies are built the same
+  // way as the graph above, while the LLVM DAG is still current.
+  if (!DeferRegionSearch) {
+    RegionJob *JobPtr = Job.get();
+    region->SetEnumWorkerGraphFactory([this, JobPtr, Target, RegionName]() {
+      auto WorkerDDG = Target->createDDGWrapper(C, this, MM.get(),
+                                                LatencyPrecision, RegionName);
+      WorkerDDG->convertSUnits(false, SecondPass);
+      WorkerDDG->convertRegFiles();
+      addGraphTransformations(
+          static_cast<OptSchedDDGWrapperBasic *>(WorkerDDG.get()));
+      JobPtr->WorkerDDGs.push_back(std::move(WorkerDDG));
+      return static_cast<DataDepGraph *>(JobPtr->WorkerDDGs.back().get());
+    });
+  }
 
-  bool IsEasy = false;
-  InstCount NormBestCost = 0;
-  InstCount BestSchedLngth = 0;
-  InstCount NormHurstcCost = 0;
-  InstCount HurstcSchedLngth = 0;
-  InstSchedule *Sched = NULL;
-  FUNC_RESULT Rslt;
-  bool FilterByPerp = schedIni.GetBool("FILTER_BY_PERP");
+  Job->FilterByPerp = schedIni.GetBool("FILTER_BY_PERP");
+  Job->BlocksToKeep = blocksToKeep(schedIni);
 
   int CurrentRegionTimeout = RegionTimeout;
   int CurrentLengthTimeout = LengthTimeout;
@@ -688,14 +726,24 @@ void ScheduleDAGOptSched::schedule() {
     CurrentRegionTimeout = RegionTimeout * SUnits.size();
     CurrentLengthTimeout = LengthTimeout * SUnits.size();
   }
+  Milliseconds AcoTimeout =
+      IsTimeoutPerInst ? AcoRegionTimeout * SUnits.size() : AcoRegionTimeout;
+  if (AcoTotalTimeout > 0) {
+    // Once the budget of the compilation is used up, regions only get the
+    // heuristic ant.
+    Milliseconds AcoTimeLeft =
+        std::max<Milliseconds>(AcoTotalTimeout - AcoTimeUsed, 1);
+    AcoTimeout =
+        AcoTimeout > 0 ? std::min(AcoTimeout, AcoTimeLeft) : AcoTimeLeft;
+  }
+  Job->RegionTimeout = CurrentRegionTimeout;
+  Job->LengthTimeout = CurrentLengthTimeout;
+  Job->AcoTimeout = AcoTimeout;
 
   // Used for two-pass-optsched to alter upper bound value.
   if (SecondPass)
     region->InitSecondPass();
 
-  // Setup time before scheduling
-  Utilities::startTime = std::chrono::high_resolution_clock::now();
-
   //Calculate Loop Depth
   unsigned depth;
   if (C->MLI != nullptr) {
@@ -704,12 +752,67 @@ void ScheduleDAGOptSched::schedule() {
   else {
 	depth = -1;
   }
+  Job->LoopDepth = depth;
+
+  if (DeferRegionSearch) {
+    DeferredRegions.push_back(std::move(Job));
+    return;
+  }
+
+  searchRegion(*Job);
+  applyRegion(*Job);
+}
+
+void ScheduleDAGOptSched::searchRegion(RegionJob &Job) {
+  auto &region = Job.Region;
+
+  // Each region draws from its own stream, so that it gets the same numbers
+  // whichever thread searches it and whether or not regions are searched
+  // concurrently.
+  RandomGen::SetSeed(static_cast<int32_t>(RandomGen::MixKey(
+      RandomGen::MixKey(static_cast<uint32_t>(RandomSeed), Job.Number),
+      SecondPass)));
+
+  bool IsBudgeted = SecondPass && FunctionTimeout > 0;
+  int64_t Budget = 0;
+  if (IsBudgeted) {
+    // The share is taken when the search starts, so that it includes the
+    // time left unused by the regions searched before. Regions without
+    // potential get no enumeration and only the heuristic ant.
+    Budget = reserveRegionBudget(Job.Number);
+    Job.RegionTimeout = Budget;
+    Job.LengthTimeout =
+        Job.LengthTimeout > 0 ? std::min<Milliseconds>(Job.LengthTimeout,
+                                                       Budget)
+                              : Budget;
+    Milliseconds AcoBudget = std::max<Milliseconds>(Budget, 1);
+    Job.AcoTimeout =
+        Job.AcoTimeout > 0 ? std::min(Job.AcoTimeout, AcoBudget) : AcoBudget;
+  }
+  region->SetAcoTimeout(Job.AcoTimeout);
+
+  // Setup time before scheduling
+  Utilities::startTime = std::chrono::high_resolution_clock::now();
 
   // Schedule region.
-  Rslt = region->FindOptimalSchedule(CurrentRegionTimeout, CurrentLengthTimeout,
-                                     IsEasy, NormBestCost, BestSchedLngth,
-                                     NormHurstcCost, HurstcSchedLngth, Sched,
-                                     FilterByPerp, blocksToKeep(schedIni), depth);
+  Job.Rslt = region->FindOptimalSchedule(
+      Job.RegionTimeout, Job.LengthTimeout, Job.IsEasy, Job.NormBestCost,
+      Job.BestSchedLngth, Job.NormHurstcCost, Job.HurstcSchedLngth, Job.Sched,
+      Job.FilterByPerp, Job.BlocksToKeep, Job.LoopDepth);
+  AcoTimeUsed += region->GetAcoTime();
+  if (IsBudgeted)
+    refundRegionBudget(Budget, Utilities::GetProcessorTime());
+  else if (TwoPassSchedulingStarted && !SecondPass &&
+             (Job.Rslt == RES_SUCCESS || Job.Rslt == RES_TIMEOUT))
+    recordRegionPotential(Job.Number, Job.LoopDepth, Job.NormHurstcCost);
+}
+
+void ScheduleDAGOptSched::applyRegion(RegionJob &Job) {
+  auto &SchedEval = SchedEvals[Job.Number];
+  OptSchedTarget *Target = Job.Target ? Job.Target.get() : OST.get();
+  auto &region = Job.Region;
+  InstSchedule *Sched = Job.Sched;
+  FUNC_RESULT Rslt = Job.Rslt;
 
   if ((!(Rslt == RES_SUCCESS || Rslt == RES_TIMEOUT) || Sched == NULL)) {
     LLVM_DEBUG(
@@ -722,8 +825,8 @@ void ScheduleDAGOptSched::schedule() {
 
   LLVM_DEBUG(Logger::Info("OptSched succeeded."));
   if (!SecondPass) {
-    OST->finalizeRegion(Sched);
-    if (!OST->shouldKeepSchedule()) {
+    Target->finalizeRegion(Sched);
+    if (!Target->shouldKeepSchedule()) {
       for (size_t i = 0; i < SUnits.size(); i++) {
         SUnit SU = SUnits[i];
         ResetFlags(SU);
@@ -774,7 +877,7 @@ void ScheduleDAGOptSched::schedule() {
           MF.getInfo<SIMachineFunctionInfo>());
       MFI->limitOccupancy(SchedEval.getOccupancyBefore());
     } else {
-      OST->finalizeRegion(Sched);
+      Target->finalizeRegion(Sched);
     }
   }
 
@@ -904,9 +1007,15 @@ void ScheduleDAGOptSched::loadOptSchedConfig() {
     IsTimeoutPerInst = true;
   else
     IsTimeoutPerInst = false;
+  AcoRegionTimeout = schedIni.GetInt("ACO_REGION_TIMEOUT", 0);
+  AcoTotalTimeout = schedIni.GetInt("ACO_TOTAL_TIMEOUT", 0);
+  FunctionTimeout = schedIni.GetInt("FUNCTION_TIMEOUT", 0);
+  RegionThreads = std::max<int>(1, schedIni.GetInt("REGION_THREADS", 1));
+  DeferRegionSearch = false;
   int randomSeed = schedIni.GetInt("RANDOM_SEED", 0);
   if (randomSeed == 0)
     randomSeed = time(NULL);
+  RandomSeed = randomSeed;
   RandomGen::SetSeed(randomSeed);
   HeurSchedType = parseListSchedType();
 
@@ -917,7 +1026,8 @@ void ScheduleDAGOptSched::loadOptSchedConfig() {
   if (ShouldLimitOccupancy)
     OccupancyLimitSource = parseOccLimit(schedIni.GetString("OCCUPANCY_LIMIT_SOURCE"));
 
-  DeviceACOEnabled = schedIni.GetInt("DEV_ACO");
+  DeviceACOEnabled = schedIni.GetInt("DEV_ACO") &&
+                     !schedIni.GetBool("DEV_ACO_ON_HOST", false);
 }
 
 bool ScheduleDAGOptSched::isOptSchedEnabled() const {
@@ -1106,10 +1216,14 @@ void ScheduleDAGOptSched::finalizeSchedule() {
 
     LLVM_DEBUG(dbgs() << "Starting two pass scheduling approach\n");
     TwoPassSchedulingStarted = true;
+    RegionPotentials.assign(Regions.size(), 0.0);
     for (const SchedPassStrategy &S : SchedPasses) {
       MachineBasicBlock *MBB = nullptr;
       // Reset
       RegionNumber = ~0u;
+      if (S == OptSchedBalanced)
+        planSecondPassBudget();
+      DeferRegionSearch = canDeferRegionSearch();
 
       for (auto &Region : Regions) {
         RegionBegin = Region.first;
@@ -1134,6 +1248,8 @@ void ScheduleDAGOptSched::finalizeSchedule() {
         exitRegion();
       }
       finishBlock();
+      if (DeferRegionSearch)
+        scheduleDeferredRegions();
     }
   }
 
@@ -1147,6 +1263,128 @@ void ScheduleDAGOptSched::finalizeSchedule() {
   });
 }
 
+void ScheduleDAGOptSched::recordRegionPotential(unsigned Number,
+                                                unsigned LoopDepth,
+                                                InstCount NormHurstcCost) {
+  if (Number >= RegionPotentials.size())
+    return;
+  // Each loop level is assumed to multiply the execution count of the
+  // region. Deep nests are capped so that they cannot take the whole budget
+  // from every other region.
+  const double LoopDepthWeight = 4.0;
+  const unsigned MaxLoopDepth = 8;
+  unsigned Depth = LoopDepth == ~0u ? 0 : std::min(LoopDepth, MaxLoopDepth);
+  RegionPotentials[Number] =
+      std::max<InstCount>(NormHurstcCost, 0) * std::pow(LoopDepthWeight, Depth);
+}
+
+void ScheduleDAGOptSched::planSecondPassBudget() {
+  BudgetLeft = FunctionTimeout;
+  PotentialLeft = 0;
+  for (double Potential : RegionPotentials)
+    PotentialLeft += Potential;
+  LLVM_DEBUG(dbgs() << "Splitting a budget of " << FunctionTimeout
+                    << " ms across regions with a total potential of "
+                    << PotentialLeft << "\n");
+}
+
+int64_t ScheduleDAGOptSched::reserveRegionBudget(unsigned Number) {
+  std::lock_guard<std::mutex> Lock(BudgetMutex);
+  if (Number >= RegionPotentials.size())
+    return 0;
+
+  // Time left unused by earlier regions goes to the regions after them.
+  int64_t Budget = 0;
+  if (BudgetLeft > 0 && PotentialLeft > 0)
+    Budget = static_cast<int64_t>(BudgetLeft * RegionPotentials[Number] /
+                                  PotentialLeft);
+  BudgetLeft -= Budget;
+  PotentialLeft = std::max(PotentialLeft - RegionPotentials[Number], 0.0);
+  return Budget;
+}
+
+void ScheduleDAGOptSched::refundRegionBudget(int64_t Reserved,
+                                             int64_t TimeUsed) {
+  std::lock_guard<std::mutex> Lock(BudgetMutex);
+  BudgetLeft += Reserved - TimeUsed;
+}
+
+bool ScheduleDAGOptSched::canDeferRegionSearch() const {
+  // The device and the LLVM schedule used as input are tied to a single
+  // region at a time.
+  return RegionThreads > 1 && !DeviceACOEnabled && !UseLLVMScheduler;
+}
+
+void ScheduleDAGOptSched::scheduleDeferredRegions() {
+  // Start with the largest regions so that a long search does not run last.
+  std::vector<RegionJob *> Order;
+  for (auto &Job : DeferredRegions)
+    Order.push_back(Job.get());
+  std::stable_sort(Order.begin(), Order.end(),
+                   [](const RegionJob *A, const RegionJob *B) {
+                     auto *DDGA = static_cast<DataDepGraph *>(A->DDG.get());
+                     auto *DDGB = static_cast<DataDepGraph *>(B->DDG.get());
+                     return DDGA->GetInstCnt() > DDGB->GetInstCnt();
+                   });
+
+  {
+    ThreadPool Pool(llvm::hardware_concurrency(RegionThreads));
+    for (RegionJob *Job : Order)
+      Pool.async([this, Job]() { searchRegion(*Job); });
+    Pool.wait();
+  }
+  DeferRegionSearch = false;
+
+  MachineBasicBlock *MBB = nullptr;
+  unsigned Number = ~0u;
+  auto NextJob = DeferredRegions.begin();
+  for (auto &Region : Regions) {
+    if (NextJob == DeferredRegions.end())
+      break;
+    RegionBegin = Region.first;
+    RegionEnd = Region.second;
+
+    if (RegionBegin->getParent() != MBB) {
+      if (MBB)
+        finishBlock();
+      MBB = RegionBegin->getParent();
+      startBlock(MBB);
+    }
+    unsigned NumRegionInstrs = std::distance(begin(), end());
+    enterRegion(MBB, begin(), end(), NumRegionInstrs);
+
+    // Skip empty scheduling regions like the pass did.
+    if (begin() == end() || begin() == std::prev(end())) {
+      exitRegion();
+      continue;
+    }
+    if ((*NextJob)->Number == ++Number) {
+      if (MF.getInfo<SIMachineFunctionInfo>()->getOccupancy() !=
+          (*NextJob)->Occupancy) {
+        // An earlier region lowered the occupancy of the function after this
+        // one was converted, so it was searched for a target occupancy that
+        // it would not have had one region at a time. Search it again on
+        // this thread the way the pass does. schedule() advances the region
+        // number.
+        RegionNumber = Number - 1;
+        schedule();
+      } else {
+        RegionNumber = Number;
+        // Rebuild the LLVM DAG the region was converted from. Its SUnits are
+        // numbered the same way, so the schedule maps back onto them.
+        SetupLLVMDag();
+        applyRegion(**NextJob);
+      }
+      Region = std::make_pair(RegionBegin, RegionEnd);
+      ++NextJob;
+    }
+    exitRegion();
+  }
+  if (MBB)
+    finishBlock();
+  DeferredRegions.clear();
+}
+
 void ScheduleDAGOptSched::runSchedPass(SchedPassStrategy S) {
   switch (S) {
   case OptSchedMinRP:
@@ -0,0 +1,248 @@
+#include "opt-sched/Scheduler/ddg_blob.h"
+#include "opt-sched/Scheduler/data_dep.h"
+#include "opt-sched/Scheduler/register.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using llvm::opt_sched::DataDepGraph;
+using llvm::opt_sched::DDGBlob;
+using llvm::opt_sched::DEP_ANTI;
+using llvm::opt_sched::DEP_DATA;
+using llvm::opt_sched::DEP_OTHER;
+using llvm::opt_sched::DependenceType;
+using llvm::opt_sched::InstCount;
+using llvm::opt_sched::InstTypeInfo;
+using llvm::opt_sched::LTP_PRECISE;
+using llvm::opt_sched::MachineModel;
+using llvm::opt_sched::RegIndxTuple;
+using llvm::opt_sched::Register;
+using llvm::opt_sched::SchedInstruction;
+
+namespace {
+
+// A machine with one instruction type, one issue type and one register type
+class SimpleMachineModel : public MachineModel {
+public:
+  SimpleMachineModel() {
+    mdlName_ = "simple";
+    issueRate_ = 1;
+    for (int16_t &Latency : dependenceLatencies_)
+      Latency = 1;
+
+    std::strcpy(InstType.name, "Default");
+    InstType.isCntxtDep = false;
+    InstType.issuType = 0;
+    InstType.ltncy = 1;
+    InstType.pipelined = true;
+    InstType.sprtd = true;
+    InstType.blksCycle = false;
+    instTypes_ = &InstType;
+    instTypes_size_ = instTypes_alloc_ = 1;
+
+    std::strcpy(RegType.name, "VGPR");
+    RegType.count = 4;
+    registerTypes_ = &RegType;
+    registerTypes_size_ = 1;
+
+    std::strcpy(IssueType.name, "Default");
+    IssueType.slotsCount = 1;
+    issueTypes_ = &IssueType;
+    issueTypes_size_ = 1;
+  }
+
+private:
+  InstTypeInfo InstType;
+  RegTypeInfo RegType;
+  IssueTypeInfo IssueType;
+};
+
+// A diamond 0 -> {1, 2} -> 3. Register 0 is defined by 0 and used by 1 and
+// 2, register 1 is defined by 1 and used by 3.
+class DiamondGraph : public DataDepGraph {
+public:
+  DiamondGraph(MachineModel *MM) : DataDepGraph(MM, LTP_PRECISE) {
+    AllocArrays_(4);
+    for (InstCount I = 0; I < 4; I++) {
+      CreateNode_(I, "inst", 0, "inst", I, I, 0, 0, 0, 0);
+      insts_[I].SetIssueType(0);
+    }
+    CreateEdge_(0, 1, 1, DEP_DATA);
+    CreateEdge_(0, 2, 2, DEP_DATA);
+    CreateEdge_(1, 3, 1, DEP_ANTI);
+    CreateEdge_(2, 3, 0, DEP_OTHER);
+    for (InstCount I = 0; I < 4; I++)
+      FinishNode_(I);
+
+    RegFiles[0].SetRegType(0);
+    RegFiles[0].SetRegCnt(2);
+    Register *Reg0 = RegFiles[0].GetReg(0);
+    Register *Reg1 = RegFiles[0].GetReg(1);
+    Reg0->SetWght(2);
+    Reg1->SetIsLiveOut(true);
+    addDef(0, Reg0);
+    addUse(1, Reg0);
+    addUse(2, Reg0);
+    addDef(1, Reg1);
+    addUse(3, Reg1);
+  }
+
+private:
+  void addDef(InstCount Num, Register *Reg) {
+    insts_[Num].AddDef(Reg);
+    Reg->AddDef(&insts_[Num]);
+  }
+  void addUse(InstCount Num, Register *Reg) {
+    insts_[Num].AddUse(Reg);
+    Reg->AddUse(&insts_[Num]);
+  }
+};
+
+// Exposes the layout of the image so that tests can corrupt it
+struct BlobLayout : DDGBlob {
+  static const int InstCnt = HDR_INST_CNT;
+  static const int Magic = HDR_MAGIC;
+  static const int ScsrOffsets = HDR_SCSR_OFFSETS;
+  static const int Scsrs = HDR_SCSRS;
+  static const int RegTuples = HDR_REG_TUPLES;
+  static const int EdgeFieldCnt = EDGE_FIELD_CNT;
+  static const int EdgeOther = EDGE_OTHER;
+  static const int EdgeOtherNum = EDGE_OTHER_NUM;
+};
+
+std::vector<int32_t> getWords(const DDGBlob &Blob) {
+  std::vector<int32_t> Words(Blob.GetSize() / sizeof(int32_t));
+  std::memcpy(Words.data(), Blob.GetData(), Blob.GetSize());
+  return Words;
+}
+
+bool assignWords(DDGBlob &Blob, const std::vector<int32_t> &Words) {
+  return Blob.Assign(Words.data(), Words.size() * sizeof(int32_t));
+}
+
+TEST(DDGBlob, BuildCopiesGraph) {
+  SimpleMachineModel MM;
+  DiamondGraph DDG(&MM);
+  DDGBlob Blob;
+  Blob.Build(&DDG);
+
+  ASSERT_EQ(4, Blob.GetInstCnt());
+  EXPECT_EQ(2, Blob.GetMaxLtncy(0));
+  EXPECT_TRUE(Blob.IsPipelined(0));
+  EXPECT_EQ(0, Blob.GetIssueType(3));
+
+  // The edges are listed in the order of the graph
+  for (InstCount I = 0; I < 4; I++) {
+    SchedInstruction *Inst = DDG.GetInstByIndx(I);
+    size_t Edge = Blob.GetScsrBgn(I);
+    int Ltncy;
+    DependenceType DepType;
+    InstCount ScsrNum;
+    for (SchedInstruction *Scsr =
+             Inst->GetFrstScsr(NULL, &Ltncy, &DepType, &ScsrNum);
+         Scsr != NULL;
+         Scsr = Inst->GetNxtScsr(NULL, &Ltncy, &DepType, &ScsrNum), Edge++) {
+      ASSERT_LT(Edge, Blob.GetScsrEnd(I));
+      EXPECT_EQ(ScsrNum, Blob.GetScsr(Edge));
+      EXPECT_EQ(Ltncy, Blob.GetScsrLtncy(Edge));
+      EXPECT_EQ(DepType, Blob.GetScsrDepType(Edge));
+    }
+    EXPECT_EQ(Blob.GetScsrEnd(I), Edge);
+  }
+  EXPECT_EQ(0u, Blob.GetPrdcsrEnd(0) - Blob.GetPrdcsrBgn(0));
+  EXPECT_EQ(2u, Blob.GetPrdcsrEnd(3) - Blob.GetPrdcsrBgn(3));
+
+  // Every edge knows its position in the list of the other instruction
+  for (InstCount I = 0; I < 4; I++)
+    for (size_t Edge = Blob.GetScsrBgn(I); Edge < Blob.GetScsrEnd(I);
+         Edge++) {
+      InstCount Scsr = Blob.GetScsr(Edge);
+      size_t PrdcsrEdge =
+          Blob.GetPrdcsrBgn(Scsr) + Blob.GetScsrPrdcsrNum(Edge);
+      EXPECT_EQ(I, Blob.GetPrdcsr(PrdcsrEdge));
+      EXPECT_EQ(Blob.GetScsrLtncy(Edge), Blob.GetPrdcsrLtncy(PrdcsrEdge));
+      EXPECT_EQ((InstCount)(Edge - Blob.GetScsrBgn(I)),
+                Blob.GetPrdcsrScsrNum(PrdcsrEdge));
+    }
+
+  ASSERT_EQ(1, Blob.GetDefCnt(1));
+  EXPECT_EQ(1, Blob.GetDef(1, 0).regNum_);
+  ASSERT_EQ(1, Blob.GetUseCnt(1));
+  EXPECT_EQ(0, Blob.GetUse(1, 0).regNum_);
+  EXPECT_EQ(0, Blob.GetDefCnt(3));
+
+  ASSERT_EQ(1, Blob.GetRegTypeCnt());
+  EXPECT_EQ(2, Blob.GetRegCnt(0));
+  EXPECT_EQ(2, Blob.GetRegWght(0, 0));
+  EXPECT_EQ(2, Blob.GetRegUseCnt(0, 0));
+  EXPECT_FALSE(Blob.IsRegLiveOut(0, 0));
+  EXPECT_TRUE(Blob.IsRegLiveOut(0, 1));
+}
+
+TEST(DDGBlob, AssignRoundTrip) {
+  SimpleMachineModel MM;
+  DiamondGraph DDG(&MM);
+  DDGBlob Blob;
+  Blob.Build(&DDG);
+
+  DDGBlob Copy;
+  ASSERT_TRUE(Copy.Assign(Blob.GetData(), Blob.GetSize()));
+  EXPECT_TRUE(Copy == Blob);
+  EXPECT_EQ(Blob.GetHash(), Copy.GetHash());
+  EXPECT_EQ(Blob.GetScsrEnd(0), Copy.GetScsrEnd(0));
+  EXPECT_EQ(Blob.GetUse(2, 0).regNum_, Copy.GetUse(2, 0).regNum_);
+
+  // Copies read their own words
+  DDGBlob Other = Copy;
+  Copy.Clear();
+  EXPECT_EQ(0u, Copy.GetSize());
+  EXPECT_TRUE(Other == Blob);
+  EXPECT_EQ(Blob.GetScsr(0), Other.GetScsr(0));
+}
+
+TEST(DDGBlob, AssignRejectsCorruptedImage) {
+  SimpleMachineModel MM;
+  DiamondGraph DDG(&MM);
+  DDGBlob Blob;
+  Blob.Build(&DDG);
+  const std::vector<int32_t> Words = getWords(Blob);
+  DDGBlob Copy;
+
+  std::vector<int32_t> Bad = Words;
+  Bad[BlobLayout::Magic] ^= 1;
+  EXPECT_FALSE(assignWords(Copy, Bad));
+
+  EXPECT_FALSE(Copy.Assign(Words.data(), Blob.GetSize() - sizeof(int32_t)));
+  EXPECT_FALSE(Copy.Assign(Words.data(), Blob.GetSize() - 1));
+  EXPECT_FALSE(Copy.Assign(Words.data(), 0));
+
+  // A successor outside of the graph
+  Bad = Words;
+  Bad[Bad[BlobLayout::Scsrs] + BlobLayout::EdgeOther] =
+      Bad[BlobLayout::InstCnt];
+  EXPECT_FALSE(assignWords(Copy, Bad));
+
+  // An edge that is not at its position in the predecessor list of its
+  // successor
+  Bad = Words;
+  Bad[Bad[BlobLayout::Scsrs] + BlobLayout::EdgeOtherNum] += 1;
+  EXPECT_FALSE(assignWords(Copy, Bad));
+
+  // Offsets that are not monotonic
+  Bad = Words;
+  std::swap(Bad[Bad[BlobLayout::ScsrOffsets] + 1],
+            Bad[Bad[BlobLayout::ScsrOffsets] + 3]);
+  EXPECT_FALSE(assignWords(Copy, Bad));
+
+  // A register outside of its register file
+  Bad = Words;
+  Bad[Bad[BlobLayout::RegTuples] + 1] = 2;
+  EXPECT_FALSE(assignWords(Copy, Bad));
+
+  EXPECT_EQ(0u, Copy.GetSize());
+  EXPECT_TRUE(assignWords(Copy, Words));
+}
+
+} // namespace
@@ -0,0 +1,89 @@
+#include "opt-sched/Scheduler/ready_heur_tree.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using llvm::opt_sched::InstCount;
+using llvm::opt_sched::pheromone_t;
+using llvm::opt_sched::ReadyHeurTree;
+
+namespace {
+
+TEST(ReadyHeurTree, FindDrawsByRunningSum) {
+  ReadyHeurTree Tree;
+  EXPECT_EQ(0, Tree.GetSum());
+  Tree.Set(0, 1);
+  Tree.Set(1, 2);
+  Tree.Set(2, 3);
+  EXPECT_EQ(6, Tree.GetSum());
+  EXPECT_EQ(2, Tree.Get(1));
+  EXPECT_EQ(0, Tree.Get(7));
+
+  EXPECT_EQ(0, Tree.Find(0));
+  EXPECT_EQ(0, Tree.Find(0.5));
+  EXPECT_EQ(1, Tree.Find(1));
+  EXPECT_EQ(1, Tree.Find(2.5));
+  EXPECT_EQ(2, Tree.Find(3));
+  EXPECT_EQ(2, Tree.Find(5.9));
+}
+
+TEST(ReadyHeurTree, GrowKeepsFactors) {
+  ReadyHeurTree Tree;
+  for (InstCount I = 0; I < 100; I++)
+    Tree.Set(I, I + 1);
+  EXPECT_EQ(5050, Tree.GetSum());
+  for (InstCount I = 0; I < 100; I++)
+    EXPECT_EQ(I + 1, Tree.Get(I));
+  EXPECT_EQ(99, Tree.Find(5049));
+
+  Tree.Clear();
+  EXPECT_EQ(0, Tree.GetSum());
+  EXPECT_EQ(0, Tree.Get(50));
+}
+
+TEST(ReadyHeurTree, SwapRemoval) {
+  // Removing entry 1 of 4 moves the last entry into its place
+  ReadyHeurTree Tree;
+  Tree.Set(0, 1);
+  Tree.Set(1, 2);
+  Tree.Set(2, 3);
+  Tree.Set(3, 4);
+  Tree.Set(1, Tree.Get(3));
+  Tree.Set(3, 0);
+  EXPECT_EQ(8, Tree.GetSum());
+  EXPECT_EQ(4, Tree.Get(1));
+  EXPECT_EQ(2, Tree.Find(5));
+}
+
+TEST(ReadyHeurTree, FindMaxReturnsLowestBestIndex) {
+  ReadyHeurTree Tree;
+  std::vector<pheromone_t> Scores = {1, 3, 2, 3, 0.5};
+  for (InstCount I = 0; I < (InstCount)Scores.size(); I++)
+    Tree.Set(I, Scores[I]);
+  int ScoreCnt = 0;
+  auto Score = [&](InstCount I) {
+    ScoreCnt++;
+    return Scores[I];
+  };
+  EXPECT_EQ(1, Tree.FindMax(1, 0, Score));
+  // Entries whose bounds are below the best score are not scored
+  EXPECT_LT(ScoreCnt, (int)Scores.size());
+}
+
+TEST(ReadyHeurTree, FindMaxUsesScoresBelowBounds) {
+  // The factors only bound the scores, so the entry with the highest factor
+  // need not win
+  ReadyHeurTree Tree;
+  std::vector<pheromone_t> Factors = {4, 2, 1};
+  std::vector<pheromone_t> Scores = {1, 1.5, 0.5};
+  for (InstCount I = 0; I < (InstCount)Factors.size(); I++)
+    Tree.Set(I, Factors[I]);
+  EXPECT_EQ(1, Tree.FindMax(1, 0, [&](InstCount I) { return Scores[I]; }));
+
+  // Negative scores are never selected
+  EXPECT_EQ(-1, Tree.FindMax(1, 0, [](InstCount) { return -1.0; }));
+  EXPECT_EQ(-1, ReadyHeurTree().FindMax(1, 0, [](InstCount) { return 1.0; }));
+}
+
+} // namespace
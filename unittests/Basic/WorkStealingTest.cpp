@@ -0,0 +1,39 @@
+#include "opt-sched/Scheduler/work_stealing.h"
+
+#include "gtest/gtest.h"
+
+using llvm::opt_sched::WorkStealingQueues;
+
+namespace {
+
+TEST(WorkStealingQueues, OwnQueueIsLastInFirstOut) {
+  WorkStealingQueues<int> Queues(2);
+  Queues.Push(0, 1);
+  Queues.Push(0, 2);
+  Queues.Push(0, 3);
+
+  int Item;
+  ASSERT_TRUE(Queues.Pop(0, Item));
+  EXPECT_EQ(3, Item);
+  ASSERT_TRUE(Queues.Pop(0, Item));
+  EXPECT_EQ(2, Item);
+}
+
+TEST(WorkStealingQueues, StealsFromFront) {
+  WorkStealingQueues<int> Queues(3);
+  Queues.Push(1, 1);
+  Queues.Push(1, 2);
+  Queues.Push(2, 3);
+
+  int Item;
+  ASSERT_TRUE(Queues.Pop(0, Item));
+  EXPECT_EQ(1, Item);
+  ASSERT_TRUE(Queues.Pop(0, Item));
+  EXPECT_EQ(2, Item);
+  ASSERT_TRUE(Queues.Pop(0, Item));
+  EXPECT_EQ(3, Item);
+  EXPECT_FALSE(Queues.Pop(0, Item));
+  EXPECT_FALSE(Queues.Pop(2, Item));
+}
+
+} // namespace